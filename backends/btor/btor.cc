@@ -45,6 +45,8 @@ struct BtorWorker
 	bool single_bad;
 	bool cover_mode;
 	bool print_internal_names;
+	bool share_mode;
+	bool fold_mode;
 
 	int next_nid = 1;
 	int initstate_nid = -1;
@@ -102,6 +104,48 @@ struct BtorWorker
 
 	PrettyJson ywmap_json;
 
+	// Nodes as written to the output when sharing nodes. Every node passes
+	// through btor_node(), which numbers the written nodes densely and drops
+	// a node that is identical to an earlier one (same operator, arguments,
+	// literals and constant value) in favour of that one. Nodes carrying a
+	// symbol or comment are always written and never stand in for others,
+	// so that sharing doesn't lose or move any names.
+	struct OutNode {
+		string op;
+		// node arguments, starting with the sort for nodes that have one
+		vector<int> args;
+		vector<int> literals;
+		// the value of a const node
+		Const value;
+		int width = 0;
+
+		bool is_const() const { return op == "const"; }
+
+		bool operator==(const OutNode &other) const {
+			return op == other.op && args == other.args && literals == other.literals && value == other.value;
+		}
+
+		[[nodiscard]] Hasher hash_into(Hasher h) const {
+			h.eat(op);
+			h.eat(args);
+			h.eat(literals);
+			h.eat(value);
+			return h;
+		}
+	};
+
+	int next_out_nid = 1;
+	int shared_count = 0, folded_count = 0;
+
+	// <nid> => <output nid>
+	dict<int, int> out_nids;
+
+	// <output nid> => node
+	dict<int, OutNode> out_nodes;
+
+	// node => <output nid>
+	dict<OutNode, int> out_cache;
+
 	void btorf(const char *fmt, ...) YS_ATTRIBUTE(format(printf, 2, 3))
 	{
 		va_list ap;
@@ -110,6 +154,230 @@ struct BtorWorker
 		va_end(ap);
 	}
 
+	void write_node(int nid, const OutNode &node, const string &suffix)
+	{
+		f << indent << nid << " " << node.op;
+		for (int arg : node.args)
+			f << " " << arg;
+		for (int literal : node.literals)
+			f << " " << literal;
+		if (node.is_const())
+			f << " " << node.value.as_string();
+		f << suffix << "\n";
+	}
+
+	// Writes node <nid>. The suffix is a symbol or comment, including the
+	// leading space.
+	void btor_node(int nid, const string &op, vector<int> args, vector<int> literals = {}, const string &suffix = "")
+	{
+		OutNode node;
+		node.op = op;
+		node.args = std::move(args);
+		node.literals = std::move(literals);
+		if (share_mode)
+			share_node(nid, std::move(node), suffix);
+		else
+			write_node(nid, node, suffix);
+	}
+
+	void btor_const(int nid, int sid, const Const &value)
+	{
+		OutNode node;
+		node.op = "const";
+		node.args.push_back(sid);
+		node.value = value;
+		if (share_mode)
+			share_node(nid, std::move(node), "");
+		else
+			write_node(nid, node, "");
+	}
+
+	static bool op_in(const string &op, std::initializer_list<const char*> ops)
+	{
+		for (auto it : ops)
+			if (op == it)
+				return true;
+		return false;
+	}
+
+	static bool op_has_sort(const string &op)
+	{
+		return !op_in(op, {"bad", "constraint", "fair", "justice", "output"});
+	}
+
+	static bool op_is_shareable(const string &op)
+	{
+		return op_has_sort(op) && !op_in(op, {"input", "state", "init", "next"});
+	}
+
+	int map_nid(int nid)
+	{
+		return nid < 0 ? -out_nids.at(-nid) : out_nids.at(nid);
+	}
+
+	int add_out_node(OutNode node, const string &suffix)
+	{
+		int out_nid = next_out_nid++;
+		write_node(out_nid, node, suffix);
+
+		if (node.op == "sort bitvec")
+			node.width = node.literals[0];
+		else if (node.op != "sort array" && op_has_sort(node.op))
+			node.width = out_nodes.at(node.args[0]).width;
+		if (op_is_shareable(node.op) && suffix.empty())
+			out_cache[node] = out_nid;
+		out_nodes[out_nid] = std::move(node);
+		return out_nid;
+	}
+
+	int out_const(int sid, const Const &value)
+	{
+		OutNode node;
+		node.op = "const";
+		node.args.push_back(sid);
+		node.value = value;
+		auto it = out_cache.find(node);
+		if (it != out_cache.end())
+			return it->second;
+		return add_out_node(node, "");
+	}
+
+	// Folds constant arguments and simple identities. Returns the output nid
+	// of an equivalent node, or 0 after possibly rewriting the node.
+	int fold_node(OutNode &node)
+	{
+		for (int arg : node.args)
+			if (arg <= 0)
+				return 0;
+
+		const string &op = node.op;
+		auto arg = [&](int i) -> const OutNode& { return out_nodes.at(node.args[i]); };
+		int nargs = GetSize(node.args);
+
+		if ((op == "uext" || op == "sext") && node.literals[0] == 0)
+			return node.args[1];
+		if (op == "slice") {
+			int upper = node.literals[0], lower = node.literals[1];
+			if (lower == 0 && upper+1 == arg(1).width)
+				return node.args[1];
+			if (arg(1).op == "slice") {
+				int offset = arg(1).literals[1];
+				node.args[1] = arg(1).args[1];
+				node.literals = {upper + offset, lower + offset};
+			}
+		}
+		if (op == "not" && arg(1).op == "not")
+			return arg(1).args[1];
+		if ((op == "and" || op == "or") && node.args[1] == node.args[2])
+			return node.args[1];
+		if (op == "ite" && node.args[2] == node.args[3])
+			return node.args[2];
+		if (op == "ite" && arg(1).is_const() && arg(1).value.is_fully_def())
+			return node.args[arg(1).value.as_bool() ? 2 : 3];
+
+		auto is_const = [&](int i, State bit) {
+			return arg(i).is_const() && arg(i).value == Const(bit, arg(i).width);
+		};
+
+		if (nargs == 3) {
+			for (int i = 1; i <= 2; i++) {
+				int other = node.args[3 - i];
+				if (op_in(op, {"and", "or"}) && is_const(i, op == "and" ? State::S0 : State::S1))
+					return node.args[i];
+				if (op_in(op, {"and", "or"}) && is_const(i, op == "and" ? State::S1 : State::S0))
+					return other;
+				if (op_in(op, {"xor", "add"}) && is_const(i, State::S0))
+					return other;
+			}
+			if (op == "sub" && is_const(2, State::S0))
+				return node.args[1];
+			if (node.args[1] == node.args[2]) {
+				if (op_in(op, {"eq", "ulte", "ugte", "slte", "sgte"}))
+					return out_const(node.args[0], Const(State::S1, 1));
+				if (op_in(op, {"neq", "ult", "ugt", "slt", "sgt"}))
+					return out_const(node.args[0], Const(State::S0, 1));
+				if (op_in(op, {"xor", "sub"}))
+					return out_const(node.args[0], Const(State::S0, arg(0).width));
+			}
+		}
+
+		if (nargs < 2)
+			return 0;
+		for (int i = 1; i < nargs; i++)
+			if (!arg(i).is_const() || !arg(i).value.is_fully_def())
+				return 0;
+
+		int width = arg(0).width;
+		Const a = arg(1).value, b = nargs > 2 ? arg(2).value : Const();
+		Const y;
+		if (op == "not") y = const_not(a, Const(), false, false, width);
+		else if (op == "neg") y = const_neg(a, Const(), false, false, width);
+		else if (op == "redand") y = const_reduce_and(a, Const(), false, false, 1);
+		else if (op == "redor") y = const_reduce_or(a, Const(), false, false, 1);
+		else if (op == "redxor") y = const_reduce_xor(a, Const(), false, false, 1);
+		else if (op == "and") y = const_and(a, b, false, false, width);
+		else if (op == "or") y = const_or(a, b, false, false, width);
+		else if (op == "xor") y = const_xor(a, b, false, false, width);
+		else if (op == "add") y = const_add(a, b, false, false, width);
+		else if (op == "sub") y = const_sub(a, b, false, false, width);
+		else if (op == "mul") y = const_mul(a, b, false, false, width);
+		else if (op == "eq") y = const_eq(a, b, false, false, 1);
+		else if (op == "neq") y = const_ne(a, b, false, false, 1);
+		else if (op == "ult") y = const_lt(a, b, false, false, 1);
+		else if (op == "ulte") y = const_le(a, b, false, false, 1);
+		else if (op == "ugt") y = const_gt(a, b, false, false, 1);
+		else if (op == "ugte") y = const_ge(a, b, false, false, 1);
+		else if (op == "concat") { y = b; y.append(a); }
+		else if (op == "slice") y = a.extract(node.literals[1], width);
+		else if (op == "uext") { y = a; y.extu(width); }
+		else if (op == "sext") { y = a; y.exts(width); }
+		else return 0;
+
+		log_assert(GetSize(y) == width);
+		return out_const(node.args[0], y);
+	}
+
+	void share_node(int nid, OutNode node, const string &suffix)
+	{
+		for (auto &arg : node.args)
+			arg = map_nid(arg);
+
+		if (op_is_shareable(node.op) && suffix.empty())
+		{
+			if (fold_mode) {
+				int folded = fold_node(node);
+				if (folded > 0) {
+					out_nids[nid] = folded;
+					folded_count++;
+					return;
+				}
+			}
+
+			auto it = out_cache.find(node);
+			if (it != out_cache.end()) {
+				out_nids[nid] = it->second;
+				shared_count++;
+				return;
+			}
+		}
+
+		out_nids[nid] = add_out_node(std::move(node), suffix);
+	}
+
+	string map_info_line(const string &line)
+	{
+		for (auto kind : {"bad ", "posedge ", "negedge ", "event "}) {
+			size_t len = strlen(kind);
+			if (line.compare(0, len, kind) != 0)
+				continue;
+			size_t end = line.find_first_of(" \n", len);
+			int nid = atoi(line.substr(len, end - len).c_str());
+			if (out_nids.count(nid))
+				return stringf("%s%d", kind, out_nids.at(nid)) + line.substr(end);
+		}
+		return line;
+	}
+
 	void infof(const char *fmt, ...) YS_ATTRIBUTE(format(printf, 2, 3))
 	{
 		va_list ap;
@@ -209,7 +477,7 @@ struct BtorWorker
 	{
 		if (sorts_bv.count(width) == 0) {
 			int nid = next_nid++;
-			btorf("%d sort bitvec %d\n", nid, width);
+			btor_node(nid, "sort bitvec", {}, {width});
 			sorts_bv[width] = nid;
 		}
 		return sorts_bv.at(width);
@@ -222,7 +490,7 @@ struct BtorWorker
 			int addr_sid = get_bv_sid(abits);
 			int data_sid = get_bv_sid(dbits);
 			int nid = next_nid++;
-			btorf("%d sort array %d %d\n", nid, addr_sid, data_sid);
+			btor_node(nid, "sort array", {addr_sid, data_sid});
 			sorts_mem[key] = nid;
 		}
 		return sorts_mem.at(key);
@@ -230,8 +498,13 @@ struct BtorWorker
 
 	void add_nid_sig(int nid, const SigSpec &sig)
 	{
-		if (verbose)
-			f << indent << stringf("; %d %s\n", nid, log_signal(sig));
+		if (verbose) {
+			// with sharing, the comment refers to the nid the node was written as
+			if (!share_mode)
+				f << indent << stringf("; %d %s\n", nid, log_signal(sig));
+			else if (out_nids.count(abs(nid)))
+				f << indent << stringf("; %d %s\n", map_nid(nid), log_signal(sig));
+		}
 
 		for (int i = 0; i < GetSize(sig); i++)
 			bit_nid[sig[i]] = make_pair(nid, i);
@@ -298,7 +571,7 @@ struct BtorWorker
 				// zero-extend the rest
 				int zeroes = get_sig_nid(Const(0, width-width_ay));
 				nid_a = next_nid++;
-				btorf("%d concat %d %d %d\n", nid_a, sid, zeroes, nid_a_padded);
+				btor_node(nid_a, "concat", {sid, zeroes, nid_a_padded});
 			} else {
 				nid_a = get_sig_nid(cell->getPort(ID::A), width, a_signed);
 			}
@@ -308,26 +581,26 @@ struct BtorWorker
 			if (btor_op == "shift")
 			{
 				int nid_r = next_nid++;
-				btorf("%d srl %d %d %d\n", nid_r, sid, nid_a, nid_b);
+				btor_node(nid_r, "srl", {sid, nid_a, nid_b});
 
 				int nid_b_neg = next_nid++;
-				btorf("%d neg %d %d\n", nid_b_neg, sid, nid_b);
+				btor_node(nid_b_neg, "neg", {sid, nid_b});
 
 				int nid_l = next_nid++;
-				btorf("%d sll %d %d %d\n", nid_l, sid, nid_a, nid_b_neg);
+				btor_node(nid_l, "sll", {sid, nid_a, nid_b_neg});
 
 				int sid_bit = get_bv_sid(1);
 				int nid_zero = get_sig_nid(Const(0, width));
 				int nid_b_ltz = next_nid++;
-				btorf("%d slt %d %d %d\n", nid_b_ltz, sid_bit, nid_b, nid_zero);
+				btor_node(nid_b_ltz, "slt", {sid_bit, nid_b, nid_zero});
 
 				nid = next_nid++;
-				btorf("%d ite %d %d %d %d%s\n", nid, sid, nid_b_ltz, nid_l, nid_r, getinfo(cell).c_str());
+				btor_node(nid, "ite", {sid, nid_b_ltz, nid_l, nid_r}, {}, getinfo(cell));
 			}
 			else
 			{
 				nid = next_nid++;
-				btorf("%d %s %d %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, nid_b, getinfo(cell).c_str());
+				btor_node(nid, btor_op, {sid, nid_a, nid_b}, {}, getinfo(cell));
 			}
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
@@ -335,7 +608,7 @@ struct BtorWorker
 			if (GetSize(sig) < width) {
 				int sid = get_bv_sid(GetSize(sig));
 				int nid2 = next_nid++;
-				btorf("%d slice %d %d %d 0\n", nid2, sid, nid, GetSize(sig)-1);
+				btor_node(nid2, "slice", {sid, nid}, {GetSize(sig)-1, 0});
 				nid = nid2;
 			}
 
@@ -368,14 +641,14 @@ struct BtorWorker
 
 			int sid = get_bv_sid(width);
 			int nid = next_nid++;
-			btorf("%d %c%s %d %d %d%s\n", nid, a_signed || b_signed ? 's' : 'u', btor_op.c_str(), sid, nid_a, nid_b, getinfo(cell).c_str());
+			btor_node(nid, stringf("%c%s", a_signed || b_signed ? 's' : 'u', btor_op.c_str()), {sid, nid_a, nid_b}, {}, getinfo(cell));
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
 
 			if (GetSize(sig) < width) {
 				int sid = get_bv_sid(GetSize(sig));
 				int nid2 = next_nid++;
-				btorf("%d slice %d %d %d 0\n", nid2, sid, nid, GetSize(sig)-1);
+				btor_node(nid2, "slice", {sid, nid}, {GetSize(sig)-1, 0});
 				nid = nid2;
 			}
 
@@ -393,13 +666,13 @@ struct BtorWorker
 			int nid2 = next_nid++;
 
 			if (cell->type == ID($_ANDNOT_)) {
-				btorf("%d not %d %d\n", nid1, sid, nid_b);
-				btorf("%d and %d %d %d%s\n", nid2, sid, nid_a, nid1, getinfo(cell).c_str());
+				btor_node(nid1, "not", {sid, nid_b});
+				btor_node(nid2, "and", {sid, nid_a, nid1}, {}, getinfo(cell));
 			}
 
 			if (cell->type == ID($_ORNOT_)) {
-				btorf("%d not %d %d\n", nid1, sid, nid_b);
-				btorf("%d or %d %d %d%s\n", nid2, sid, nid_a, nid1, getinfo(cell).c_str());
+				btor_node(nid1, "not", {sid, nid_b});
+				btor_node(nid2, "or", {sid, nid_a, nid1}, {}, getinfo(cell));
 			}
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
@@ -419,15 +692,15 @@ struct BtorWorker
 			int nid3 = next_nid++;
 
 			if (cell->type == ID($_OAI3_)) {
-				btorf("%d or %d %d %d\n", nid1, sid, nid_a, nid_b);
-				btorf("%d and %d %d %d\n", nid2, sid, nid1, nid_c);
-				btorf("%d not %d %d%s\n", nid3, sid, nid2, getinfo(cell).c_str());
+				btor_node(nid1, "or", {sid, nid_a, nid_b});
+				btor_node(nid2, "and", {sid, nid1, nid_c});
+				btor_node(nid3, "not", {sid, nid2}, {}, getinfo(cell));
 			}
 
 			if (cell->type == ID($_AOI3_)) {
-				btorf("%d and %d %d %d\n", nid1, sid, nid_a, nid_b);
-				btorf("%d or %d %d %d\n", nid2, sid, nid1, nid_c);
-				btorf("%d not %d %d%s\n", nid3, sid, nid2, getinfo(cell).c_str());
+				btor_node(nid1, "and", {sid, nid_a, nid_b});
+				btor_node(nid2, "or", {sid, nid1, nid_c});
+				btor_node(nid3, "not", {sid, nid2}, {}, getinfo(cell));
 			}
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
@@ -449,17 +722,17 @@ struct BtorWorker
 			int nid4 = next_nid++;
 
 			if (cell->type == ID($_OAI4_)) {
-				btorf("%d or %d %d %d\n", nid1, sid, nid_a, nid_b);
-				btorf("%d or %d %d %d\n", nid2, sid, nid_c, nid_d);
-				btorf("%d and %d %d %d\n", nid3, sid, nid1, nid2);
-				btorf("%d not %d %d%s\n", nid4, sid, nid3, getinfo(cell).c_str());
+				btor_node(nid1, "or", {sid, nid_a, nid_b});
+				btor_node(nid2, "or", {sid, nid_c, nid_d});
+				btor_node(nid3, "and", {sid, nid1, nid2});
+				btor_node(nid4, "not", {sid, nid3}, {}, getinfo(cell));
 			}
 
 			if (cell->type == ID($_AOI4_)) {
-				btorf("%d and %d %d %d\n", nid1, sid, nid_a, nid_b);
-				btorf("%d and %d %d %d\n", nid2, sid, nid_c, nid_d);
-				btorf("%d or %d %d %d\n", nid3, sid, nid1, nid2);
-				btorf("%d not %d %d%s\n", nid4, sid, nid3, getinfo(cell).c_str());
+				btor_node(nid1, "and", {sid, nid_a, nid_b});
+				btor_node(nid2, "and", {sid, nid_c, nid_d});
+				btor_node(nid3, "or", {sid, nid1, nid2});
+				btor_node(nid4, "not", {sid, nid3}, {}, getinfo(cell));
 			}
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
@@ -491,9 +764,9 @@ struct BtorWorker
 
 			int nid = next_nid++;
 			if (cell->type.in(ID($lt), ID($le), ID($ge), ID($gt))) {
-				btorf("%d %c%s %d %d %d%s\n", nid, a_signed || b_signed ? 's' : 'u', btor_op.c_str(), sid, nid_a, nid_b, getinfo(cell).c_str());
+				btor_node(nid, stringf("%c%s", a_signed || b_signed ? 's' : 'u', btor_op.c_str()), {sid, nid_a, nid_b}, {}, getinfo(cell));
 			} else {
-				btorf("%d %s %d %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, nid_b, getinfo(cell).c_str());
+				btor_node(nid, btor_op, {sid, nid_a, nid_b}, {}, getinfo(cell));
 			}
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
@@ -501,7 +774,7 @@ struct BtorWorker
 			if (GetSize(sig) > 1) {
 				int sid = get_bv_sid(GetSize(sig));
 				int nid2 = next_nid++;
-				btorf("%d uext %d %d %d\n", nid2, sid, nid, GetSize(sig) - 1);
+				btor_node(nid2, "uext", {sid, nid}, {GetSize(sig) - 1});
 				nid = nid2;
 			}
 
@@ -528,13 +801,13 @@ struct BtorWorker
 				log_assert(!btor_op.empty());
 				int sid = get_bv_sid(width);
 				nid = next_nid++;
-				btorf("%d %s %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, getinfo(cell).c_str());
+				btor_node(nid, btor_op, {sid, nid_a}, {}, getinfo(cell));
 			}
 
 			if (GetSize(sig) < width) {
 				int sid = get_bv_sid(GetSize(sig));
 				int nid2 = next_nid++;
-				btorf("%d slice %d %d %d 0\n", nid2, sid, nid, GetSize(sig)-1);
+				btor_node(nid2, "slice", {sid, nid}, {GetSize(sig)-1, 0});
 				nid = nid2;
 			}
 
@@ -556,21 +829,21 @@ struct BtorWorker
 
 			if (GetSize(cell->getPort(ID::A)) > 1) {
 				int nid_red_a = next_nid++;
-				btorf("%d redor %d %d\n", nid_red_a, sid, nid_a);
+				btor_node(nid_red_a, "redor", {sid, nid_a});
 				nid_a = nid_red_a;
 			}
 
 			if (btor_op != "not" && GetSize(cell->getPort(ID::B)) > 1) {
 				int nid_red_b = next_nid++;
-				btorf("%d redor %d %d\n", nid_red_b, sid, nid_b);
+				btor_node(nid_red_b, "redor", {sid, nid_b});
 				nid_b = nid_red_b;
 			}
 
 			int nid = next_nid++;
 			if (btor_op != "not")
-				btorf("%d %s %d %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, nid_b, getinfo(cell).c_str());
+				btor_node(nid, btor_op, {sid, nid_a, nid_b}, {}, getinfo(cell));
 			else
-				btorf("%d %s %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, getinfo(cell).c_str());
+				btor_node(nid, btor_op, {sid, nid_a}, {}, getinfo(cell));
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
 
@@ -578,7 +851,7 @@ struct BtorWorker
 				int sid = get_bv_sid(GetSize(sig));
 				int zeros_nid = get_sig_nid(Const(0, GetSize(sig)-1));
 				int nid2 = next_nid++;
-				btorf("%d concat %d %d %d\n", nid2, sid, zeros_nid, nid);
+				btor_node(nid2, "concat", {sid, zeros_nid, nid});
 				nid = nid2;
 			}
 
@@ -601,11 +874,11 @@ struct BtorWorker
 
 			if (cell->type == ID($reduce_xnor)) {
 				int nid2 = next_nid++;
-				btorf("%d %s %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, getinfo(cell).c_str());
-				btorf("%d not %d %d\n", nid2, sid, nid);
+				btor_node(nid, btor_op, {sid, nid_a}, {}, getinfo(cell));
+				btor_node(nid2, "not", {sid, nid});
 				nid = nid2;
 			} else {
-				btorf("%d %s %d %d%s\n", nid, btor_op.c_str(), sid, nid_a, getinfo(cell).c_str());
+				btor_node(nid, btor_op, {sid, nid_a}, {}, getinfo(cell));
 			}
 
 			SigSpec sig = sigmap(cell->getPort(ID::Y));
@@ -614,7 +887,7 @@ struct BtorWorker
 				int sid = get_bv_sid(GetSize(sig));
 				int zeros_nid = get_sig_nid(Const(0, GetSize(sig)-1));
 				int nid2 = next_nid++;
-				btorf("%d concat %d %d %d\n", nid2, sid, zeros_nid, nid);
+				btor_node(nid2, "concat", {sid, zeros_nid, nid});
 				nid = nid2;
 			}
 
@@ -639,10 +912,10 @@ struct BtorWorker
 			if (cell->type == ID($_NMUX_)) {
 				int tmp = nid;
 				nid = next_nid++;
-				btorf("%d ite %d %d %d %d\n", tmp, sid, nid_s, nid_b, nid_a);
-				btorf("%d not %d %d%s\n", nid, sid, tmp, getinfo(cell).c_str());
+				btor_node(tmp, "ite", {sid, nid_s, nid_b, nid_a});
+				btor_node(nid, "not", {sid, tmp}, {}, getinfo(cell));
 			} else {
-				btorf("%d ite %d %d %d %d%s\n", nid, sid, nid_s, nid_b, nid_a, getinfo(cell).c_str());
+				btor_node(nid, "ite", {sid, nid_s, nid_b, nid_a}, {}, getinfo(cell));
 			}
 
 			add_nid_sig(nid, sig_y);
@@ -665,9 +938,9 @@ struct BtorWorker
 				int nid_s = get_sig_nid(sig_s.extract(i));
 				int nid2 = next_nid++;
 				if (i == GetSize(sig_s)-1)
-					btorf("%d ite %d %d %d %d%s\n", nid2, sid, nid_s, nid_b, nid, getinfo(cell).c_str());
+					btor_node(nid2, "ite", {sid, nid_s, nid_b, nid}, {}, getinfo(cell));
 				else
-					btorf("%d ite %d %d %d %d\n", nid2, sid, nid_s, nid_b, nid);
+					btor_node(nid2, "ite", {sid, nid_s, nid_b, nid});
 				nid = nid2;
 			}
 
@@ -725,9 +998,9 @@ struct BtorWorker
 			int nid = next_nid++;
 
 			if (symbol.empty() || (!print_internal_names && symbol[0] == '$'))
-				btorf("%d state %d\n", nid, sid);
+				btor_node(nid, "state", {sid});
 			else
-				btorf("%d state %d %s\n", nid, sid, log_id(symbol));
+				btor_node(nid, "state", {sid}, {}, stringf(" %s", log_id(symbol)));
 
 			if (cell->get_bool_attribute(ID(clk2fflogic)))
 				ywmap_state(cell->getPort(ID::D)); // For a clk2fflogic FF the named signal is the D input not the Q output
@@ -738,7 +1011,7 @@ struct BtorWorker
 				int nid_init = next_nid++;
 				if (verbose)
 					btorf("; initval = %s\n", log_signal(initval));
-				btorf("%d init %d %d %d\n", nid_init, sid, nid, nid_init_val);
+				btor_node(nid_init, "init", {sid, nid, nid_init_val});
 			}
 
 			ff_todo.push_back(make_pair(nid, cell));
@@ -753,13 +1026,13 @@ struct BtorWorker
 			int sid = get_bv_sid(GetSize(sig_y));
 			int nid = next_nid++;
 
-			btorf("%d state %d%s\n", nid, sid, getinfo(cell).c_str());
+			btor_node(nid, "state", {sid}, {}, getinfo(cell));
 
 			ywmap_state(sig_y);
 
 			if (cell->type == ID($anyconst)) {
 				int nid2 = next_nid++;
-				btorf("%d next %d %d %d\n", nid2, sid, nid, nid);
+				btor_node(nid2, "next", {sid, nid, nid});
 			}
 
 			add_nid_sig(nid, sig_y);
@@ -776,9 +1049,9 @@ struct BtorWorker
 				int one_nid = get_sig_nid(State::S1);
 				int zero_nid = get_sig_nid(State::S0);
 				initstate_nid = next_nid++;
-				btorf("%d state %d%s\n", initstate_nid, sid, getinfo(cell).c_str());
-				btorf("%d init %d %d %d\n", next_nid++, sid, initstate_nid, one_nid);
-				btorf("%d next %d %d %d\n", next_nid++, sid, initstate_nid, zero_nid);
+				btor_node(initstate_nid, "state", {sid}, {}, getinfo(cell));
+				btor_node(next_nid++, "init", {sid, initstate_nid, one_nid});
+				btor_node(next_nid++, "next", {sid, initstate_nid, zero_nid});
 
 				ywmap_state(sig_y);
 			}
@@ -845,7 +1118,7 @@ struct BtorWorker
 				else
 				{
 					nid_init_val = next_nid++;
-					btorf("%d state %d\n", nid_init_val, sid);
+					btor_node(nid_init_val, "state", {sid});
 
 					ywmap_state(nullptr);
 
@@ -860,7 +1133,7 @@ struct BtorWorker
 						nid_init_val = next_nid++;
 						if (verbose)
 							btorf("; initval[%d] = %s\n", i, log_signal(thisword));
-						btorf("%d write %d %d %d %d\n", nid_init_val, sid, last_nid_init_val, nid_thisaddr, nid_thisword);
+						btor_node(nid_init_val, "write", {sid, last_nid_init_val, nid_thisaddr, nid_thisword});
 					}
 				}
 			}
@@ -870,16 +1143,16 @@ struct BtorWorker
 			int nid_head = nid;
 
 			if (mem->memid[0] == '$')
-				btorf("%d state %d\n", nid, sid);
+				btor_node(nid, "state", {sid});
 			else
-				btorf("%d state %d %s\n", nid, sid, log_id(mem->memid));
+				btor_node(nid, "state", {sid}, {}, stringf(" %s", log_id(mem->memid)));
 
 			ywmap_state(cell);
 
 			if (nid_init_val >= 0)
 			{
 				int nid_init = next_nid++;
-				btorf("%d init %d %d %d\n", nid_init, sid, nid, nid_init_val);
+				btor_node(nid_init, "init", {sid, nid, nid_init_val});
 			}
 
 			if (asyncwr)
@@ -894,28 +1167,28 @@ struct BtorWorker
 					int we_nid = get_sig_nid(port.en);
 
 					int nid2 = next_nid++;
-					btorf("%d read %d %d %d\n", nid2, data_sid, nid_head, wa_nid);
+					btor_node(nid2, "read", {data_sid, nid_head, wa_nid});
 
 					int nid3 = next_nid++;
-					btorf("%d not %d %d\n", nid3, data_sid, we_nid);
+					btor_node(nid3, "not", {data_sid, we_nid});
 
 					int nid4 = next_nid++;
-					btorf("%d and %d %d %d\n", nid4, data_sid, nid2, nid3);
+					btor_node(nid4, "and", {data_sid, nid2, nid3});
 
 					int nid5 = next_nid++;
-					btorf("%d and %d %d %d\n", nid5, data_sid, wd_nid, we_nid);
+					btor_node(nid5, "and", {data_sid, wd_nid, we_nid});
 
 					int nid6 = next_nid++;
-					btorf("%d or %d %d %d\n", nid6, data_sid, nid5, nid4);
+					btor_node(nid6, "or", {data_sid, nid5, nid4});
 
 					int nid7 = next_nid++;
-					btorf("%d write %d %d %d %d\n", nid7, sid, nid_head, wa_nid, nid6);
+					btor_node(nid7, "write", {sid, nid_head, wa_nid, nid6});
 
 					int nid8 = next_nid++;
-					btorf("%d redor %d %d\n", nid8, bool_sid, we_nid);
+					btor_node(nid8, "redor", {bool_sid, we_nid});
 
 					int nid9 = next_nid++;
-					btorf("%d ite %d %d %d %d\n", nid9, sid, nid8, nid7, nid_head);
+					btor_node(nid9, "ite", {sid, nid8, nid7, nid_head});
 
 					nid_head = nid9;
 				}
@@ -929,7 +1202,7 @@ struct BtorWorker
 				int ra_nid = get_sig_nid(ra);
 				int rd_nid = next_nid++;
 
-				btorf("%d read %d %d %d\n", rd_nid, data_sid, nid_head, ra_nid);
+				btor_node(rd_nid, "read", {data_sid, nid_head, ra_nid});
 
 				add_nid_sig(rd_nid, port.data);
 			}
@@ -941,7 +1214,7 @@ struct BtorWorker
 			else
 			{
 				int nid2 = next_nid++;
-				btorf("%d next %d %d %d\n", nid2, sid, nid, nid_head);
+				btor_node(nid2, "next", {sid, nid, nid_head});
 			}
 
 			goto okay;
@@ -999,10 +1272,10 @@ struct BtorWorker
 
 				int nid_input = next_nid++;
 				if (is_init) {
-					btorf("%d state %d\n", nid_input, sid);
+					btor_node(nid_input, "state", {sid});
 					ywmap_state(sig);
 				} else {
-					btorf("%d input %d\n", nid_input, sid);
+					btor_node(nid_input, "input", {sid});
 					ywmap_input(sig);
 				}
 
@@ -1012,7 +1285,7 @@ struct BtorWorker
 				} else {
 					int nid_mask_undef = get_sig_nid(sig_mask_undef);
 					nid_masked_input = next_nid++;
-					btorf("%d and %d %d %d\n", nid_masked_input, sid, nid_input, nid_mask_undef);
+					btor_node(nid_masked_input, "and", {sid, nid_input, nid_mask_undef});
 				}
 
 				if (sig_noundef.is_fully_zero()) {
@@ -1020,7 +1293,7 @@ struct BtorWorker
 				} else {
 					int nid_noundef = get_sig_nid(sig_noundef);
 					nid = next_nid++;
-					btorf("%d or %d %d %d\n", nid, sid, nid_masked_input, nid_noundef);
+					btor_node(nid, "or", {sid, nid_masked_input, nid_noundef});
 				}
 
 				goto extend_or_trim;
@@ -1051,7 +1324,7 @@ struct BtorWorker
 						if (consts.count(c) == 0) {
 							int sid = get_bv_sid(GetSize(c));
 							int nid = next_nid++;
-							btorf("%d const %d %s\n", nid, sid, c.as_string().c_str());
+							btor_const(nid, sid, c);
 							consts[c] = nid;
 							nid_width[nid] = GetSize(c);
 						}
@@ -1078,7 +1351,7 @@ struct BtorWorker
 
 							int sid = get_bv_sid(GetSize(s));
 							int nid = next_nid++;
-							btorf("%d input %d\n", nid, sid);
+							btor_node(nid, "input", {sid});
 							ywmap_input(s);
 							nid_width[nid] = GetSize(s);
 							add_nid_sig(nid, s);
@@ -1119,7 +1392,7 @@ struct BtorWorker
 				if (lower != 0 || upper+1 != nid_width.at(nid2)) {
 					int sid = get_bv_sid(upper-lower+1);
 					nid3 = next_nid++;
-					btorf("%d slice %d %d %d %d\n", nid3, sid, nid2, upper, lower);
+					btor_node(nid3, "slice", {sid, nid2}, {upper, lower});
 				}
 
 				int nid4 = nid3;
@@ -1127,7 +1400,7 @@ struct BtorWorker
 				if (nid >= 0) {
 					int sid = get_bv_sid(width+upper-lower+1);
 					nid4 = next_nid++;
-					btorf("%d concat %d %d %d\n", nid4, sid, nid3, nid);
+					btor_node(nid4, "concat", {sid, nid3, nid});
 				}
 
 				width += upper-lower+1;
@@ -1147,15 +1420,14 @@ struct BtorWorker
 			{
 				int sid = get_bv_sid(to_width);
 				int nid2 = next_nid++;
-				btorf("%d slice %d %d %d 0\n", nid2, sid, nid, to_width-1);
+				btor_node(nid2, "slice", {sid, nid}, {to_width-1, 0});
 				nid = nid2;
 			}
 			else
 			{
 				int sid = get_bv_sid(to_width);
 				int nid2 = next_nid++;
-				btorf("%d %s %d %d %d\n", nid2, is_signed ? "sext" : "uext",
-						sid, nid, to_width - GetSize(sig));
+				btor_node(nid2, is_signed ? "sext" : "uext", {sid, nid}, {to_width - GetSize(sig)});
 				nid = nid2;
 			}
 		}
@@ -1163,8 +1435,10 @@ struct BtorWorker
 		return nid;
 	}
 
-	BtorWorker(std::ostream &f, RTLIL::Module *module, bool verbose, bool single_bad, bool cover_mode, bool print_internal_names, string info_filename, string ywmap_filename) :
-			f(f), sigmap(module), module(module), verbose(verbose), single_bad(single_bad), cover_mode(cover_mode), print_internal_names(print_internal_names), info_filename(info_filename)
+	BtorWorker(std::ostream &f, RTLIL::Module *module, bool verbose, bool single_bad, bool cover_mode, bool print_internal_names, bool share_mode, bool fold_mode,
+			string info_filename, string ywmap_filename) :
+			f(f), sigmap(module), module(module), verbose(verbose), single_bad(single_bad), cover_mode(cover_mode), print_internal_names(print_internal_names),
+			share_mode(share_mode), fold_mode(fold_mode), info_filename(info_filename)
 	{
 		if (!info_filename.empty())
 			infof("name %s\n", log_id(module));
@@ -1215,7 +1489,7 @@ struct BtorWorker
 			int sid = get_bv_sid(GetSize(sig));
 			int nid = next_nid++;
 
-			btorf("%d input %d%s\n", nid, sid, getinfo(wire).c_str());
+			btor_node(nid, "input", {sid}, {}, getinfo(wire));
 			ywmap_input(wire);
 			add_nid_sig(nid, sig);
 
@@ -1260,7 +1534,7 @@ struct BtorWorker
 			btorf_push(stringf("output %s", log_id(wire)));
 
 			int nid = get_sig_nid(wire);
-			btorf("%d output %d%s\n", next_nid++, nid, getinfo(wire).c_str());
+			btor_node(next_nid++, "output", {nid}, {}, getinfo(wire));
 
 			btorf_pop(stringf("output %s", log_id(wire)));
 		}
@@ -1278,9 +1552,9 @@ struct BtorWorker
 				int nid_a_or_not_en = next_nid++;
 				int nid = next_nid++;
 
-				btorf("%d not %d %d\n", nid_not_en, sid, nid_en);
-				btorf("%d or %d %d %d\n", nid_a_or_not_en, sid, nid_a, nid_not_en);
-				btorf("%d constraint %d\n", nid, nid_a_or_not_en);
+				btor_node(nid_not_en, "not", {sid, nid_en});
+				btor_node(nid_a_or_not_en, "or", {sid, nid_a, nid_not_en});
+				btor_node(nid, "constraint", {nid_a_or_not_en});
 
 				btorf_pop(log_id(cell));
 			}
@@ -1295,8 +1569,8 @@ struct BtorWorker
 				int nid_not_a = next_nid++;
 				int nid_en_and_not_a = next_nid++;
 
-				btorf("%d not %d %d\n", nid_not_a, sid, nid_a);
-				btorf("%d and %d %d %d\n", nid_en_and_not_a, sid, nid_en, nid_not_a);
+				btor_node(nid_not_a, "not", {sid, nid_a});
+				btor_node(nid_en_and_not_a, "and", {sid, nid_en, nid_not_a});
 
 				if (single_bad && !cover_mode) {
 					bad_properties.push_back(nid_en_and_not_a);
@@ -1305,7 +1579,7 @@ struct BtorWorker
 						infof("bad %d%s\n", nid_en_and_not_a, getinfo(cell, true).c_str());
 					} else {
 						int nid = next_nid++;
-						btorf("%d bad %d%s\n", nid, nid_en_and_not_a, getinfo(cell, true).c_str());
+						btor_node(nid, "bad", {nid_en_and_not_a}, {}, getinfo(cell, true));
 					}
 				}
 
@@ -1321,13 +1595,13 @@ struct BtorWorker
 				int nid_en = get_sig_nid(cell->getPort(ID::EN));
 				int nid_en_and_a = next_nid++;
 
-				btorf("%d and %d %d %d\n", nid_en_and_a, sid, nid_en, nid_a);
+				btor_node(nid_en_and_a, "and", {sid, nid_en, nid_a});
 
 				if (single_bad) {
 					bad_properties.push_back(nid_en_and_a);
 				} else {
 					int nid = next_nid++;
-					btorf("%d bad %d%s\n", nid, nid_en_and_a, getinfo(cell, true).c_str());
+					btor_node(nid, "bad", {nid_en_and_a}, {}, getinfo(cell, true));
 				}
 
 				btorf_pop(log_id(cell));
@@ -1348,7 +1622,7 @@ struct BtorWorker
 				continue;
 
 			int this_nid = next_nid++;
-			btorf("%d uext %d %d %d%s\n", this_nid, sid, nid, 0, getinfo(wire).c_str());
+			btor_node(this_nid, "uext", {sid, nid}, {0}, getinfo(wire));
 			if (info_clocks.count(nid))
 				info_clocks[this_nid] |= info_clocks[nid];
 
@@ -1371,7 +1645,7 @@ struct BtorWorker
 				SigSpec sig = sigmap(cell->getPort(ID::D));
 				int nid_q = get_sig_nid(sig);
 				int sid = get_bv_sid(GetSize(sig));
-				btorf("%d next %d %d %d%s\n", next_nid++, sid, nid, nid_q, getinfo(cell).c_str());
+				btor_node(next_nid++, "next", {sid, nid, nid_q}, {}, getinfo(cell));
 
 				btorf_pop(stringf("next %s", log_id(cell)));
 			}
@@ -1403,34 +1677,34 @@ struct BtorWorker
 					int we_nid = get_sig_nid(port.en);
 
 					int nid2 = next_nid++;
-					btorf("%d read %d %d %d\n", nid2, data_sid, nid_head, wa_nid);
+					btor_node(nid2, "read", {data_sid, nid_head, wa_nid});
 
 					int nid3 = next_nid++;
-					btorf("%d not %d %d\n", nid3, data_sid, we_nid);
+					btor_node(nid3, "not", {data_sid, we_nid});
 
 					int nid4 = next_nid++;
-					btorf("%d and %d %d %d\n", nid4, data_sid, nid2, nid3);
+					btor_node(nid4, "and", {data_sid, nid2, nid3});
 
 					int nid5 = next_nid++;
-					btorf("%d and %d %d %d\n", nid5, data_sid, wd_nid, we_nid);
+					btor_node(nid5, "and", {data_sid, wd_nid, we_nid});
 
 					int nid6 = next_nid++;
-					btorf("%d or %d %d %d\n", nid6, data_sid, nid5, nid4);
+					btor_node(nid6, "or", {data_sid, nid5, nid4});
 
 					int nid7 = next_nid++;
-					btorf("%d write %d %d %d %d\n", nid7, sid, nid_head, wa_nid, nid6);
+					btor_node(nid7, "write", {sid, nid_head, wa_nid, nid6});
 
 					int nid8 = next_nid++;
-					btorf("%d redor %d %d\n", nid8, bool_sid, we_nid);
+					btor_node(nid8, "redor", {bool_sid, we_nid});
 
 					int nid9 = next_nid++;
-					btorf("%d ite %d %d %d %d\n", nid9, sid, nid8, nid7, nid_head);
+					btor_node(nid9, "ite", {sid, nid8, nid7, nid_head});
 
 					nid_head = nid9;
 				}
 
 				int nid2 = next_nid++;
-				btorf("%d next %d %d %d%s\n", nid2, sid, nid, nid_head, (mem->cell ? getinfo(mem->cell) : getinfo(mem->mem)).c_str());
+				btor_node(nid2, "next", {sid, nid, nid_head}, {}, mem->cell ? getinfo(mem->cell) : getinfo(mem->mem));
 
 				btorf_pop(stringf("next %s", log_id(mem->memid)));
 			}
@@ -1451,7 +1725,7 @@ struct BtorWorker
 				int nid = next_nid++;
 
 				bad_properties.push_back(nid);
-				btorf("%d or %d %d %d\n", nid, sid, nid_a, nid_b);
+				btor_node(nid, "or", {sid, nid_a, nid_b});
 			}
 
 			if (!bad_properties.empty()) {
@@ -1462,7 +1736,7 @@ struct BtorWorker
 				int nid = next_nid++;
 				log_assert(cursor == 0);
 				log_assert(GetSize(todo) == 1);
-				btorf("%d bad %d\n", nid, todo[cursor]);
+				btor_node(nid, "bad", {todo[cursor]});
 			}
 		}
 
@@ -1491,7 +1765,7 @@ struct BtorWorker
 			if (f.fail())
 				log_error("Can't open file `%s' for writing: %s\n", info_filename.c_str(), strerror(errno));
 			for (auto &it : info_lines)
-				f << it;
+				f << (share_mode ? map_info_line(it) : it);
 			f.close();
 		}
 
@@ -1530,6 +1804,9 @@ struct BtorWorker
 
 			ywmap_json.end_object();
 		}
+
+		if (share_mode)
+			log("Wrote %d BTOR nodes, dropped %d duplicate and %d folded nodes.\n", next_out_nid-1, shared_count, folded_count);
 	}
 };
 
@@ -1561,10 +1838,21 @@ struct BtorBackend : public Backend {
 		log("  -ywmap <filename>\n");
 		log("    Create a map file for conversion to and from Yosys witness traces\n");
 		log("\n");
+		log("  -noshare\n");
+		log("    Write every node as it is created. By default a node that is identical\n");
+		log("    to an earlier one (same operator, sort and arguments) is not written\n");
+		log("    again and its users refer to the earlier one instead.\n");
+		log("\n");
+		log("  -fold\n");
+		log("    Also fold operations on constants and simple identities (full-width\n");
+		log("    slices, extensions by 0, double negation, and/or/xor/add with a neutral\n");
+		log("    constant, ite with a constant or both branches the same, ...)\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		bool verbose = false, single_bad = false, cover_mode = false, print_internal_names = false;
+		bool share_mode = true, fold_mode = false;
 		string info_filename;
 		string ywmap_filename;
 
@@ -1603,6 +1891,14 @@ struct BtorBackend : public Backend {
 				ywmap_filename = args[++argidx];
 				continue;
 			}
+			if (args[argidx] == "-noshare") {
+				share_mode = false;
+				continue;
+			}
+			if (args[argidx] == "-fold") {
+				fold_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
@@ -1615,7 +1911,10 @@ struct BtorBackend : public Backend {
 		*f << stringf("; BTOR description generated by %s for module %s.\n",
 				yosys_maybe_version(), log_id(topmod));
 
-		BtorWorker(*f, topmod, verbose, single_bad, cover_mode, print_internal_names, info_filename, ywmap_filename);
+		if (fold_mode && !share_mode)
+			log_cmd_error("Option -fold can't be combined with -noshare.\n");
+
+		BtorWorker(*f, topmod, verbose, single_bad, cover_mode, print_internal_names, share_mode, fold_mode, info_filename, ywmap_filename);
 
 		*f << stringf("; end of yosys output\n");
 	}
@@ -738,6 +738,8 @@ struct CxxrtlWorker {
 	bool debug_alias = false;
 	bool debug_eval = false;
 
+	bool activity = false;
+
 	std::ostringstream f;
 	std::string indent;
 	int temporary = 0;
@@ -753,6 +755,7 @@ struct CxxrtlWorker {
 	dict<RTLIL::SigBit, bool> bit_has_state;
 	dict<const RTLIL::Module*, pool<std::string>> blackbox_specializations;
 	dict<const RTLIL::Module*, bool> eval_converges;
+	pool<const RTLIL::Module*> activity_modules;
 
 	void inc_indent() {
 		indent += "\t";
@@ -2105,10 +2108,23 @@ struct CxxrtlWorker {
 		f << "value<" << wire->width << "> " << mangle(wire) << ";\n";
 	}
 
+	// Input ports whose values are compared with their values at the previous evaluation by modules with activity
+	// tracking. Buffered inputs are compared by their next value, since edge detectors use it.
+	std::vector<const RTLIL::Wire*> activity_inputs(RTLIL::Module *module)
+	{
+		std::vector<const RTLIL::Wire*> inputs;
+		for (auto wire : module->wires())
+			if (wire->port_input && wire_types[wire].is_member())
+				inputs.push_back(wire);
+		return inputs;
+	}
+
 	void dump_reset_method(RTLIL::Module *module)
 	{
 		int mem_init_idx = 0;
 		inc_indent();
+			if (activity_modules.count(module))
+				f << indent << "activity_pending = true;\n";
 			for (auto wire : module->wires()) {
 				const auto &wire_type = wire_types[wire];
 				if (!wire_type.is_named() || wire_type.is_local()) continue;
@@ -2175,6 +2191,26 @@ struct CxxrtlWorker {
 	void dump_eval_method(RTLIL::Module *module)
 	{
 		inc_indent();
+			if (activity_modules.count(module)) {
+				// Evaluating the module again is only necessary if its inputs or its state changed.
+				std::vector<const RTLIL::Wire*> inputs = activity_inputs(module);
+				f << indent << "if (!activity_pending";
+				for (auto wire : inputs)
+					f << " &&\n" << indent << "\t\t" << mangle(wire) << (wire_types[wire].is_buffered() ? ".next" : "")
+					  << " == activity_" << mangle(wire);
+				f << ") {\n";
+				inc_indent();
+					f << indent << "activity.skipped++;\n";
+					f << indent << "return true;\n";
+				dec_indent();
+				f << indent << "}\n";
+				f << indent << "activity_pending = false;\n";
+				for (auto wire : inputs)
+					f << indent << "activity_" << mangle(wire) << " = " << mangle(wire)
+					  << (wire_types[wire].is_buffered() ? ".next" : "") << ";\n";
+			}
+			if (activity && !module->get_bool_attribute(ID(cxxrtl_blackbox)))
+				f << indent << "activity.evaluated++;\n";
 			f << indent << "bool converged = " << (eval_converges.at(module) ? "true" : "false") << ";\n";
 			if (!module->get_bool_attribute(ID(cxxrtl_blackbox))) {
 				for (auto wire : module->wires()) {
@@ -2287,10 +2323,40 @@ struct CxxrtlWorker {
 					f << indent << "if (" << mangle(cell) << access << "commit(observer)) changed = true;\n";
 				}
 			}
+			if (activity_modules.count(module))
+				f << indent << "if (changed) activity_pending = true;\n";
 			f << indent << "return changed;\n";
 		dec_indent();
 	}
 
+	void dump_invalidate_method(RTLIL::Module *module)
+	{
+		inc_indent();
+			if (activity_modules.count(module))
+				f << indent << "activity_pending = true;\n";
+			for (auto cell : module->cells()) {
+				if (is_internal_cell(cell->type))
+					continue;
+				const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
+				f << indent << mangle(cell) << access << "invalidate();\n";
+			}
+		dec_indent();
+	}
+
+	void dump_activity_info_method(RTLIL::Module *module)
+	{
+		inc_indent();
+			f << indent << "counters[path] = activity;\n";
+			for (auto cell : module->cells()) {
+				if (is_internal_cell(cell->type))
+					continue;
+				const char *access = is_cxxrtl_blackbox_cell(cell) ? "->" : ".";
+				f << indent << mangle(cell) << access;
+				f << "activity_info(counters, path + " << escape_cxx_string(get_hdl_name(cell) + ' ') << ");\n";
+			}
+		dec_indent();
+	}
+
 	void dump_serialized_metadata(const dict<RTLIL::IdString, RTLIL::Const> &metadata_map) {
 		// Creating thousands metadata_map objects using initializer lists in a single function results in one of:
 		// 1. Megabytes of stack usage (with __attribute__((optnone))).
@@ -2714,6 +2780,15 @@ struct CxxrtlWorker {
 				}
 				if (has_cells)
 					f << "\n";
+				if (activity) {
+					if (activity_modules.count(module)) {
+						for (auto wire : activity_inputs(module))
+							f << indent << "value<" << wire->width << "> activity_" << mangle(wire) << ";\n";
+						f << indent << "bool activity_pending = true;\n";
+					}
+					f << indent << "activity_counters activity;\n";
+					f << "\n";
+				}
 				f << indent << mangle(module) << "(interior) {}\n";
 				f << indent << mangle(module) << "() {\n";
 				inc_indent();
@@ -2734,6 +2809,13 @@ struct CxxrtlWorker {
 				f << indent << indent << "observer observer;\n";
 				f << indent << indent << "return commit<>(observer);\n";
 				f << indent << "}\n";
+				if (activity) {
+					f << "\n";
+					f << indent << "void invalidate() override;\n";
+					f << "\n";
+					f << indent << "void activity_info(std::map<std::string, activity_counters> &counters, "
+					            << "std::string path) const override;\n";
+				}
 				if (debug_info) {
 					if (debug_eval) {
 						f << "\n";
@@ -2766,6 +2848,17 @@ struct CxxrtlWorker {
 		f << indent << "bool " << mangle(module) << "::eval(performer *performer) {\n";
 		dump_eval_method(module);
 		f << indent << "}\n";
+		if (activity) {
+			f << "\n";
+			f << indent << "void " << mangle(module) << "::invalidate() {\n";
+			dump_invalidate_method(module);
+			f << indent << "}\n";
+			f << "\n";
+			f << indent << "void " << mangle(module) << "::activity_info(std::map<std::string, activity_counters> &counters, "
+			            << "std::string path) const {\n";
+			dump_activity_info_method(module);
+			f << indent << "}\n";
+		}
 		if (debug_info) {
 			if (debug_eval) {
 				f << "\n";
@@ -2811,6 +2904,22 @@ struct CxxrtlWorker {
 		log_assert(no_loops);
 		modules.insert(modules.end(), topo_design.sorted.begin(), topo_design.sorted.end());
 
+		if (activity) {
+			// Black boxes may change their outputs on their own, so neither they nor any module containing them may skip
+			// evaluation. Submodules are sorted before the modules that instantiate them.
+			for (auto module : topo_design.sorted) {
+				bool has_blackbox = false;
+				for (auto cell : module->cells())
+					if (!is_internal_cell(cell->type) && (is_cxxrtl_blackbox_cell(cell) ||
+							!activity_modules.count(design->module(cell->type))))
+						has_blackbox = true;
+				if (has_blackbox)
+					log("Module `%s' contains black boxes and is always evaluated.\n", log_id(module));
+				else
+					activity_modules.insert(module);
+			}
+		}
+
 		if (split_intf) {
 			// The only thing more depraved than include guards, is mangling filenames to turn them into include guards.
 			std::string include_guard = design_ns + "_header";
@@ -3675,6 +3784,15 @@ struct CxxrtlBackend : public Backend {
 		log("        processes significantly improves evaluation performance at the cost of\n");
 		log("        slight increase in compilation time.\n");
 		log("\n");
+		log("    -activity\n");
+		log("        skip evaluating a module instance if neither its inputs nor its state\n");
+		log("        changed since it was last evaluated, and count evaluated and skipped\n");
+		log("        evaluations; the counts are available through `activity_info()`.\n");
+		log("        each module instance is evaluated or skipped as a whole, so this is\n");
+		log("        only useful together with -noflatten or (*keep_hierarchy*). modules\n");
+		log("        that contain black boxes are always evaluated. code that changes the\n");
+		log("        design state directly must call `invalidate()` afterwards.\n");
+		log("\n");
 		log("    -O <level>\n");
 		log("        set the optimization level. the default is -O%d. higher optimization\n", DEFAULT_OPT_LEVEL);
 		log("        levels dramatically decrease compile and run time, and highest level\n");
@@ -3762,6 +3880,10 @@ struct CxxrtlBackend : public Backend {
 				noproc = true;
 				continue;
 			}
+			if (args[argidx] == "-activity") {
+				worker.activity = true;
+				continue;
+			}
 			if (args[argidx] == "-Og") {
 				log_warning("The `-Og` option has been removed. Use `-g3` instead for complete "
 				            "design coverage regardless of optimization level.\n");
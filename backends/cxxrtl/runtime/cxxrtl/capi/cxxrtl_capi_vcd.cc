@@ -26,6 +26,7 @@ extern const cxxrtl::debug_items &cxxrtl_debug_items_from_handle(cxxrtl_handle h
 struct _cxxrtl_vcd {
 	cxxrtl::vcd_writer writer;
 	bool flush = false;
+	std::unique_ptr<cxxrtl::vcd_async_writer> async;
 };
 
 cxxrtl_vcd cxxrtl_vcd_create() {
@@ -33,6 +34,8 @@ cxxrtl_vcd cxxrtl_vcd_create() {
 }
 
 void cxxrtl_vcd_destroy(cxxrtl_vcd vcd) {
+	// The background thread must finish with the variables before the writer is released.
+	vcd->async.reset();
 	delete vcd;
 }
 
@@ -69,7 +72,10 @@ void cxxrtl_vcd_sample(cxxrtl_vcd vcd, uint64_t time) {
 		vcd->writer.buffer.clear();
 		vcd->flush = false;
 	}
-	vcd->writer.sample(time);
+	if (vcd->async)
+		vcd->async->sample(time);
+	else
+		vcd->writer.sample(time);
 }
 
 void cxxrtl_vcd_read(cxxrtl_vcd vcd, const char **data, size_t *size) {
@@ -81,3 +87,21 @@ void cxxrtl_vcd_read(cxxrtl_vcd vcd, const char **data, size_t *size) {
 	*size = vcd->writer.buffer.size();
 	vcd->flush = true;
 }
+
+void cxxrtl_vcd_start_async(cxxrtl_vcd vcd, size_t capacity, void *data,
+                            void (*sink)(void *data, const char *buf, size_t size)) {
+	assert(!vcd->async);
+	if (vcd->flush) {
+		vcd->writer.buffer.clear();
+		vcd->flush = false;
+	}
+	vcd->async.reset(new cxxrtl::vcd_async_writer(vcd->writer,
+		[=](const char *buf, size_t size) {
+			sink(data, buf, size);
+		}, capacity));
+}
+
+void cxxrtl_vcd_flush(cxxrtl_vcd vcd) {
+	if (vcd->async)
+		vcd->async->flush();
+}
@@ -100,6 +100,23 @@ void cxxrtl_vcd_sample(cxxrtl_vcd vcd, uint64_t time);
 // this function will always return zero sized chunks.
 void cxxrtl_vcd_read(cxxrtl_vcd vcd, const char **data, size_t *size);
 
+// Format and write VCD data on a background thread.
+//
+// After this call, `cxxrtl_vcd_sample` only copies the values of changed signals into a ring buffer
+// of approximately `capacity` bytes, and waits if the ring buffer is full. A background thread formats
+// the values and calls `sink` with the provided `data` and the next chunk of VCD data, including any
+// data that was buffered but not yet retrieved with `cxxrtl_vcd_read`. The `sink` is always called
+// from the background thread, never concurrently with itself.
+//
+// Objects must be scheduled before this call, and `cxxrtl_vcd_read` must not be used after it.
+void cxxrtl_vcd_start_async(cxxrtl_vcd vcd, size_t capacity, void *data,
+                            void (*sink)(void *data, const char *buf, size_t size));
+
+// Wait until all VCD data sampled so far has been passed to the sink.
+//
+// Has no effect unless `cxxrtl_vcd_start_async` was called. Destroying the VCD writer also flushes it.
+void cxxrtl_vcd_flush(cxxrtl_vcd vcd);
+
 #ifdef __cplusplus
 }
 #endif
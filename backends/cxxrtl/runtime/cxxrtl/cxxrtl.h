@@ -1542,12 +1542,21 @@ struct debug_scopes {
 // and the constructor of interior modules that should not call it.
 struct interior {};
 
+// Evaluation counters of a module instance, maintained by designs generated with `write_cxxrtl -activity`.
+struct activity_counters {
+	uint64_t evaluated = 0;
+	uint64_t skipped = 0;
+};
+
 // The core API of the `module` class consists of only four virtual methods: `reset()`, `eval()`,
 // `commit`, and `debug_info()`. (The virtual destructor is made necessary by C++.) Every other method
 // is a convenience method, and exists solely to simplify some common pattern for C++ API consumers.
 // No behavior may be added to such convenience methods that other parts of CXXRTL can rely on, since
 // there is no guarantee they will be called (and, for example, other CXXRTL libraries will often call
 // the `eval()` and `commit()` directly instead, as well as being exposed in the C API).
+//
+// The `invalidate()` and `activity_info()` methods are only meaningful for designs generated with activity tracking,
+// and do nothing otherwise.
 struct module {
 	module() {}
 	virtual ~module() {}
@@ -1586,6 +1595,17 @@ struct module {
 		(void)items, (void)scopes, (void)path, (void)cell_attrs;
 	}
 
+	// With activity tracking, `eval()` skips a module instance if neither its inputs nor its state changed since
+	// it was last evaluated. Code that changes the design state other than through inputs and `commit()`, such as
+	// `cxxrtl::player` or a debugger writing to `curr`, must call `invalidate()` afterwards.
+	virtual void invalidate() {}
+
+	// Collects the evaluation counters of this module instance and its submodules, keyed by the same hierarchical
+	// path as used by `debug_info()`.
+	virtual void activity_info(std::map<std::string, activity_counters> &counters, std::string path) const {
+		(void)counters, (void)path;
+	}
+
 	// Compatibility method.
 #if __has_attribute(deprecated)
 	__attribute__((deprecated("Use `debug_info(&items, /*scopes=*/nullptr, path);` instead.")))
@@ -102,6 +102,12 @@
 // sample time. It continues reading incremental samples after that point until it reaches the requested sample time.
 // This process is very cheap as the design is not evaluated; it is essentially a (convoluted) memory copy operation.
 //
+// Non-incremental samples serve as checkpoints. The recorder can be configured to write one periodically, which bounds
+// the amount of data read by a rewind to the checkpoint interval. The player keeps an index of the checkpoints it has
+// seen; when asked to rewind past the end of the indexed part of the log, it first skims the log up to the requested
+// sample, reading only the packet structure without changing the design state, and adds the checkpoints it finds to
+// the index.
+//
 // During replaying, the player evaluates the design at the current time, which causes all debug items to assume
 // the values they had before recording. This process is expensive. Once done, the player advances to the next state
 // by reading the next (complete or incremental) sample, as above. Since a range of samples is replayed, this process
@@ -189,6 +195,9 @@ public:
 
 		// These functions aren't overloaded because of implicit numeric conversions.
 
+		// Once the buffer is full, it is written out synchronously on the calling (simulation) thread. Unlike
+		// `vcd_async_writer`, there is no background thread here; the reader relies on flushed data being in the
+		// file once `flush()` returns.
 		void emit_word(uint32_t word) {
 			if (position + 1 == buffer.size())
 				flush();
@@ -478,6 +487,23 @@ public:
 				data[chunks * index + offset] = absorb_word();
 		}
 
+		// Same as `read_change_data`, but discards the data.
+		void skip_change_data(uint32_t header, size_t chunks) {
+			switch (header & CHANGE_MASK) {
+				case PACKET_CHANGEL:
+				case PACKET_CHANGEH:
+					return;
+				case PACKET_CHANGE:
+					break;
+				case PACKET_CHANGEI:
+					absorb_word();
+					break;
+				default:
+					assert(false && "Unrecognized change packet");
+			}
+			fseek(f, chunks * sizeof(uint32_t), SEEK_CUR);
+		}
+
 		bool read_diagnostic(uint32_t header, diagnostic &diagnostic) {
 			if ((header & ~DIAGNOSTIC_MASK) != PACKET_DIAGNOSTIC)
 				return false; // some other packet
@@ -550,10 +576,35 @@ class recorder {
 	spool::pointer_t pointer = 0;
 	time timestamp;
 
+	size_t checkpoint_interval = 0;
+	size_t samples_since_checkpoint = 0;
+	time previous_timestamp; // of the latest sample
+
+	void write_sample(bool incremental) {
+		writer.write_sample(incremental, pointer++, timestamp);
+		samples_since_checkpoint = incremental ? samples_since_checkpoint + 1 : 0;
+		previous_timestamp = timestamp;
+	}
+
+	// A checkpoint is only written for the first sample at a given time, since the player rewinds to the first of
+	// several consecutive samples with the same time.
+	bool checkpoint_due() {
+		return checkpoint_interval != 0 && samples_since_checkpoint >= checkpoint_interval &&
+			timestamp != previous_timestamp;
+	}
+
 public:
 	template<typename ...Args>
 	recorder(Args &&...args) : writer(std::forward<Args>(args)...) {}
 
+	// Once `interval` samples have been recorded after the latest complete sample, `record_incremental()` records
+	// a complete sample instead of an incremental one at the next time step. This bounds the cost of rewinding
+	// the player to any sample at the cost of a larger replay log. If `interval` is zero (the default), only samples
+	// recorded with `record_complete()` are complete.
+	void set_checkpoint_interval(size_t interval) {
+		checkpoint_interval = interval;
+	}
+
 	void start(module &module, std::string top_path = "") {
 		debug_items items;
 		module.debug_info(&items, /*scopes=*/nullptr, top_path);
@@ -602,7 +653,7 @@ public:
 	void record_complete() {
 		assert(streaming);
 
-		writer.write_sample(/*incremental=*/false, pointer++, timestamp);
+		write_sample(/*incremental=*/false);
 		for (auto var : variables) {
 			assert(var.ident != 0);
 			if (!var.memory)
@@ -636,7 +687,16 @@ public:
 		record_observer.ident_lookup = &ident_lookup;
 		record_observer.writer = &writer;
 
-		writer.write_sample(/*incremental=*/true, pointer++, timestamp);
+		if (checkpoint_due()) {
+			// The complete sample is written after the commit, so it contains the same values the incremental sample
+			// would have produced when replayed.
+			observer null_observer;
+			bool changed = module.commit(null_observer);
+			record_complete();
+			return changed;
+		}
+
+		write_sample(/*incremental=*/true);
 		for (auto input_index : inputs) {
 			variable &var = variables.at(input_index);
 			assert(!var.memory);
@@ -654,7 +714,7 @@ public:
 		// diagnostics should be rare enough that this inefficiency does not matter. If it turns out to be an issue, this
 		// code should be changed to accumulate diagnostics to a buffer that is flushed in `record_{complete,incremental}`
 		// and also in `advance_time` before the timestamp is changed. (Right now `advance_time` never writes to the spool.)
-		writer.write_sample(/*incremental=*/true, pointer++, timestamp);
+		write_sample(/*incremental=*/true);
 		writer.write_diagnostic(diagnostic);
 		writer.write_end();
 	}
@@ -666,7 +726,8 @@ public:
 
 // A CXXRTL player reads samples from a spool, and changes the design state accordingly. To start reading samples,
 // a spool must have been initialized: the recorder must have been started and an initial complete sample must have
-// been written.
+// been written. If the design was generated with activity tracking, `module::invalidate()` must be called after
+// the player changes the design state and before the design is evaluated.
 class player {
 	struct variable {
 		size_t chunks;
@@ -683,6 +744,47 @@ class player {
 
 	std::map<spool::pointer_t, spool::reader::pos_t, std::greater<spool::pointer_t>> index_by_pointer;
 	std::map<time, spool::reader::pos_t, std::greater<time>> index_by_timestamp;
+	spool::reader::pos_t indexed_position = 0; // every complete sample before this position is in the index
+
+	void index_sample(bool incremental, spool::pointer_t pointer, const time &timestamp, spool::reader::pos_t position) {
+		// It is possible (though not very useful) to have several complete samples with the same timestamp in a row.
+		// Ensure that we associate the timestamp with the position of the first such complete sample.
+		if (!incremental && !index_by_pointer.count(pointer)) {
+			index_by_pointer[pointer] = position;
+			if (!index_by_timestamp.count(timestamp))
+				index_by_timestamp[timestamp] = position;
+		}
+	}
+
+	// Skims the log after `indexed_position` without changing the design state, indexing complete samples, and stops
+	// at the first sample for which `past_target(pointer, timestamp)` returns `true`, or at the end of the log.
+	template<class Predicate>
+	void extend_index(const Predicate &past_target) {
+		auto position = reader.position();
+		reader.rewind(indexed_position);
+		while (true) {
+			bool incremental;
+			spool::pointer_t sample_pointer;
+			time sample_timestamp;
+			auto sample_position = reader.position();
+			if (!reader.read_sample(incremental, sample_pointer, sample_timestamp) ||
+					past_target(sample_pointer, sample_timestamp))
+				break;
+			index_sample(incremental, sample_pointer, sample_timestamp, sample_position);
+
+			uint32_t header;
+			while (reader.read_header(header)) {
+				spool::ident_t ident;
+				diagnostic diag;
+				if (reader.read_change_ident(header, ident))
+					reader.skip_change_data(header, variables.at(ident).chunks);
+				else if (!reader.read_diagnostic(header, diag))
+					assert(false && "Unrecognized packet header");
+			}
+			indexed_position = reader.position();
+		}
+		reader.rewind(position);
+	}
 
 	bool peek_sample(spool::pointer_t &pointer, time &timestamp) {
 		bool incremental;
@@ -730,6 +832,7 @@ public:
 		}
 		assert(variables.size() > 0);
 		streaming = true;
+		indexed_position = reader.position();
 
 		// Establish the initial state of the design.
 		std::vector<diagnostic> diagnostics;
@@ -770,6 +873,8 @@ public:
 	bool rewind_to(spool::pointer_t at_pointer, std::vector<diagnostic> *diagnostics) {
 		assert(initialized);
 
+		extend_index([=](spool::pointer_t pointer, const time &) { return pointer > at_pointer; });
+
 		// The pointers in the replay log start from one that is greater than `at_pointer`. In this case the pointer will
 		// never be reached.
 		assert(index_by_pointer.size() > 0);
@@ -800,6 +905,8 @@ public:
 	bool rewind_to_or_before(const time &at_or_before_timestamp, std::vector<diagnostic> *diagnostics) {
 		assert(initialized);
 
+		extend_index([&](spool::pointer_t, const time &timestamp) { return timestamp > at_or_before_timestamp; });
+
 		// The timestamps in the replay log start from one that is greater than `at_or_before_timestamp`. In this case
 		// the timestamp will never be reached. Otherwise, this function will always succeed.
 		assert(index_by_timestamp.size() > 0);
@@ -842,15 +949,7 @@ public:
 
 		// The very first sample that is read must be a complete sample. This is required for the rewind functions to work.
 		assert(initialized || !incremental);
-
-		// It is possible (though not very useful) to have several complete samples with the same timestamp in a row.
-		// Ensure that we associate the timestamp with the position of the first such complete sample. (This condition
-		// works because the player never jumps over a sample.)
-		if (!incremental && !index_by_pointer.count(pointer)) {
-			assert(!index_by_timestamp.count(timestamp));
-			index_by_pointer[pointer] = position;
-			index_by_timestamp[timestamp] = position;
-		}
+		index_sample(incremental, pointer, timestamp, position);
 
 		uint32_t header;
 		while (reader.read_header(header)) {
@@ -864,6 +963,8 @@ public:
 					diagnostics->push_back(diag);
 			} else assert(false && "Unrecognized packet header");
 		}
+		if (position == indexed_position)
+			indexed_position = reader.position();
 		return true;
 	}
 };
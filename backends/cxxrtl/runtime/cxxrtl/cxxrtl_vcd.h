@@ -19,11 +19,20 @@
 #ifndef CXXRTL_VCD_H
 #define CXXRTL_VCD_H
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
 #include <cxxrtl/cxxrtl.h>
 
 namespace cxxrtl {
 
+class vcd_async_writer;
+
 class vcd_writer {
+	friend class vcd_async_writer;
+
 	struct variable {
 		size_t ident;
 		size_t width;
@@ -66,13 +75,17 @@ class vcd_writer {
 		}
 	}
 
-	void emit_ident(size_t ident) {
+	static void emit_ident(std::string &buffer, size_t ident) {
 		do {
 			buffer += '!' + ident % 94; // "base94"
 			ident /= 94;
 		} while (ident != 0);
 	}
 
+	void emit_ident(size_t ident) {
+		emit_ident(buffer, ident);
+	}
+
 	void emit_name(const std::string &name) {
 		for (char c : name) {
 			if (c == ':') {
@@ -107,30 +120,25 @@ class vcd_writer {
 		streaming = true;
 	}
 
-	void emit_time(uint64_t timestamp) {
-		assert(streaming);
+	static void emit_time(std::string &buffer, uint64_t timestamp) {
 		buffer += "#" + std::to_string(timestamp) + "\n";
 	}
 
-	void emit_scalar(const variable &var) {
-		assert(streaming);
-		assert(var.width == 1);
-		buffer += (*var.curr ? '1' : '0');
-		emit_ident(var.ident);
-		buffer += '\n';
-	}
-
-	void emit_vector(const variable &var) {
-		assert(streaming);
-		buffer += 'b';
-		for (size_t bit = var.width - 1; bit != (size_t)-1; bit--) {
-			bool bit_curr = var.curr[bit / (8 * sizeof(chunk_t))] & (1 << (bit % (8 * sizeof(chunk_t))));
-			buffer += (bit_curr ? '1' : '0');
+	// Emits `value` rather than `var.curr`, so that values captured earlier can be formatted, too.
+	static void emit_value(std::string &buffer, const variable &var, const chunk_t *value) {
+		if (var.width == 1) {
+			buffer += (*value ? '1' : '0');
+		} else {
+			buffer += 'b';
+			for (size_t bit = var.width - 1; bit != (size_t)-1; bit--) {
+				bool bit_curr = value[bit / (8 * sizeof(chunk_t))] & (1 << (bit % (8 * sizeof(chunk_t))));
+				buffer += (bit_curr ? '1' : '0');
+			}
+			if (var.width == 0)
+				buffer += '0';
+			buffer += ' ';
 		}
-		if (var.width == 0)
-			buffer += '0';
-		buffer += ' ';
-		emit_ident(var.ident);
+		emit_ident(buffer, var.ident);
 		buffer += '\n';
 	}
 
@@ -265,14 +273,158 @@ public:
 			emit_enddefinitions();
 		}
 		reset_outlines();
-		emit_time(timestamp);
+		emit_time(buffer, timestamp);
 		for (auto var : variables)
-			if (test_variable(var) || first_sample) {
-				if (var.width == 1)
-					emit_scalar(var);
+			if (test_variable(var) || first_sample)
+				emit_value(buffer, var, var.curr);
+	}
+};
+
+// Moves the formatting and writing of VCD data off the simulation thread. Sampling only copies the changed values
+// into a single-producer single-consumer ring buffer; a background thread formats them using the variables of
+// the wrapped `vcd_writer` and passes the text to `sink` in large pieces. When the ring buffer is full, sampling
+// waits for the background thread to catch up.
+//
+// Variables must be added to the wrapped writer before the first sample is taken through this class, and the writer
+// must not be used directly afterwards. Any data already in `writer.buffer` is passed to the sink first.
+class vcd_async_writer {
+	static constexpr chunk_t TIME_MARKER = ~(chunk_t)0;
+	static constexpr size_t SINK_THRESHOLD = 1 << 20;
+
+	vcd_writer &writer;
+	std::function<void(const char *, size_t)> sink;
+
+	std::vector<chunk_t> ring;
+	size_t ring_mask;
+	// Positions only ever increase; `head` is written by the simulation thread, `tail` and `written` by
+	// the background thread.
+	std::atomic<size_t> head { 0 };
+	std::atomic<size_t> tail { 0 };
+	std::atomic<size_t> written { 0 };
+	std::atomic<bool> stopping { false };
+	std::thread thread;
+
+	static size_t chunks_of(const vcd_writer::variable &var) {
+		return (var.width + (sizeof(chunk_t) * 8 - 1)) / (sizeof(chunk_t) * 8);
+	}
+
+	void push(const chunk_t *data, size_t count, size_t &position) {
+		for (size_t offset = 0; offset < count; offset++)
+			ring[(position + offset) & ring_mask] = data[offset];
+		position += count;
+	}
+
+	void reserve(size_t count) {
+		// Backpressure: the ring buffer is sized so that any single record fits into it.
+		while (ring.size() - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire)) < count)
+			std::this_thread::yield();
+	}
+
+	void run() {
+		std::string text;
+		std::swap(text, writer.buffer);
+		std::vector<chunk_t> value;
+		size_t position = tail.load(std::memory_order_relaxed);
+		unsigned idle = 0;
+		while (true) {
+			size_t end = head.load(std::memory_order_acquire);
+			if (position == end) {
+				if (!text.empty()) {
+					sink(text.data(), text.size());
+					text.clear();
+				}
+				written.store(position, std::memory_order_release);
+				if (stopping.load(std::memory_order_acquire) && position == head.load(std::memory_order_acquire))
+					break;
+				if (++idle < 64)
+					std::this_thread::yield();
 				else
-					emit_vector(var);
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+				continue;
 			}
+			idle = 0;
+			while (position != end) {
+				chunk_t header = ring[position++ & ring_mask];
+				if (header == TIME_MARKER) {
+					uint64_t timestamp = ring[position++ & ring_mask];
+					timestamp |= (uint64_t)ring[position++ & ring_mask] << 32;
+					vcd_writer::emit_time(text, timestamp);
+				} else {
+					const vcd_writer::variable &var = writer.variables[header];
+					value.resize(chunks_of(var));
+					for (size_t offset = 0; offset < value.size(); offset++)
+						value[offset] = ring[position++ & ring_mask];
+					vcd_writer::emit_value(text, var, value.data());
+				}
+			}
+			tail.store(position, std::memory_order_release);
+			if (text.size() >= SINK_THRESHOLD) {
+				sink(text.data(), text.size());
+				text.clear();
+			}
+		}
+	}
+
+public:
+	vcd_async_writer(vcd_writer &writer, std::function<void(const char *, size_t)> sink, size_t capacity = 4 << 20)
+	: writer(writer), sink(sink) {
+		size_t words = capacity / sizeof(chunk_t);
+		for (auto &var : writer.variables)
+			words = std::max(words, 2 * (1 + chunks_of(var)));
+		size_t ring_size = 64;
+		while (ring_size < words)
+			ring_size *= 2;
+		ring.resize(ring_size);
+		ring_mask = ring_size - 1;
+	}
+
+	vcd_async_writer(const vcd_async_writer &) = delete;
+	vcd_async_writer &operator=(const vcd_async_writer &) = delete;
+
+	~vcd_async_writer() {
+		if (thread.joinable()) {
+			stopping.store(true, std::memory_order_release);
+			thread.join();
+		} else if (!writer.buffer.empty()) {
+			sink(writer.buffer.data(), writer.buffer.size());
+			writer.buffer.clear();
+		}
+	}
+
+	// Same as `vcd_writer::sample()`, but only the comparison and the copying of values is done by the caller.
+	void sample(uint64_t timestamp) {
+		bool first_sample = !writer.streaming;
+		if (first_sample) {
+			writer.emit_scope({});
+			writer.emit_enddefinitions();
+		}
+		if (!thread.joinable())
+			thread = std::thread(&vcd_async_writer::run, this);
+		writer.reset_outlines();
+
+		size_t position = head.load(std::memory_order_relaxed);
+		reserve(3);
+		chunk_t time_record[3] = { TIME_MARKER, (chunk_t)timestamp, (chunk_t)(timestamp >> 32) };
+		push(time_record, 3, position);
+		head.store(position, std::memory_order_release);
+
+		for (size_t index = 0; index < writer.variables.size(); index++) {
+			auto &var = writer.variables[index];
+			if (writer.test_variable(var) || first_sample) {
+				chunk_t header = index;
+				reserve(1 + chunks_of(var));
+				push(&header, 1, position);
+				push(var.curr, chunks_of(var), position);
+				head.store(position, std::memory_order_release);
+			}
+		}
+	}
+
+	// Waits until everything sampled so far has been passed to the sink.
+	void flush() {
+		size_t target = head.load(std::memory_order_relaxed);
+		while (thread.joinable() && written.load(std::memory_order_acquire) < target)
+			std::this_thread::yield();
 	}
 };
 
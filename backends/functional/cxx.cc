@@ -170,12 +170,14 @@ struct CxxModule {
 	CxxStruct input_struct, output_struct, state_struct;
 	std::string module_name;
 
-	explicit CxxModule(Module *module) :
+	CxxModule(Module *module, bool optimize) :
 		ir(Functional::IR::from_module(module)),
 		input_struct("Inputs"),
 		output_struct("Outputs"),
 		state_struct("State")
 	{
+		if (optimize)
+			ir.optimize();
 		for (auto input : ir.inputs())
 			input_struct.insert(input->name, input->sort);
 		for (auto output : ir.outputs())
@@ -202,16 +204,15 @@ struct CxxModule {
 			if (state->sort.is_signal())
 				f.print("\tstate.{} = {};\n", state_struct[state->name], cxx_const(state->initial_value_signal()));
 			else if (state->sort.is_memory()) {
-				f.print("\t{{\n");
-				f.print("\t\tstd::array<Signal<{}>, {}> mem;\n", state->sort.data_width(), 1<<state->sort.addr_width());
+				// start from a memory filled with the default value and write the
+				// other words, instead of building the whole array on the stack
 				const auto &contents = state->initial_value_memory();
-				f.print("\t\tmem.fill({});\n", cxx_const(contents.default_value()));
+				std::string name = state_struct[state->name];
+				f.print("\tstate.{} = {}({});\n", name, CxxType(state->sort).to_string(), cxx_const(contents.default_value()));
 				for(auto range : contents)
 					for(auto addr = range.base(); addr < range.limit(); addr++)
 						if(!equal_def(range[addr], contents.default_value()))
-							f.print("\t\tmem[{}] = {};\n", addr, cxx_const(range[addr]));
-				f.print("\t\tstate.{} = mem;\n", state_struct[state->name]);
-				f.print("\t}}\n");
+							f.print("\tstate.{0} = state.{0}.write({1}, {2});\n", name, cxx_const(RTLIL::Const(addr, state->sort.addr_width())), cxx_const(range[addr]));
 			}
 		}
 		f.print("}}\n\n");
@@ -246,14 +247,20 @@ struct FunctionalCxxBackend : public Backend
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("TODO: add help message\n");
+		log("    write_functional_cxx [options] [filename]\n");
+		log("\n");
+		log("Functional C++ Backend.\n");
+		log("\n");
+		log("    -noopt\n");
+		log("        do not optimize the functional IR before writing it (merging duplicate\n");
+		log("        nodes, folding constants, slices and concatenations)\n");
 		log("\n");
     }
 
-	void printCxx(std::ostream &stream, std::string, Module *module)
+	void printCxx(std::ostream &stream, std::string, Module *module, bool optimize)
 	{
 		CxxWriter f(stream);
-		CxxModule mod(module);
+		CxxModule mod(module, optimize);
 		mod.write_header(f);
 		mod.write_struct_def(f);
 		mod.write_eval_def(f);
@@ -264,12 +271,22 @@ struct FunctionalCxxBackend : public Backend
 	{
         log_header(design, "Executing Functional C++ backend.\n");
 
-		size_t argidx = 1;
+		bool optimize = true;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-noopt") {
+				optimize = false;
+				continue;
+			}
+			break;
+		}
 		extra_args(f, filename, args, argidx, design);
 
 		for (auto module : design->selected_modules()) {
             log("Dumping module `%s'.\n", module->name.c_str());
-			printCxx(*f, filename, module);
+			printCxx(*f, filename, module, optimize);
 		}
 	}
 } FunctionalCxxBackend;
@@ -23,78 +23,121 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <iostream>
 #include <algorithm>
 
+// Signals are stored in 64-bit words, least significant word first. Bits above
+// n in the last word are always zero, so that word-wise comparisons and
+// arithmetic need no further masking on the inputs.
 template<size_t n>
 class Signal {
     template<size_t m> friend class Signal;
-    std::array<bool, n> _bits;
-public:
-    Signal() { }
-    Signal(uint32_t val)
+    static constexpr size_t words = n == 0 ? 1 : (n + 63) / 64;
+    static constexpr uint64_t tail_mask = n == 0 ? 0 : n % 64 == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (n % 64)) - 1;
+    std::array<uint64_t, words> _words;
+
+    void mask_tail() { _words[words - 1] &= tail_mask; }
+
+    // the 64 bits starting at bit offset, zero-filled past the last word
+    uint64_t extract_word(size_t offset) const
+    {
+        size_t w = offset / 64, s = offset % 64;
+        if(w >= words) return 0;
+        uint64_t ret = _words[w] >> s;
+        if(s != 0 && w + 1 < words)
+            ret |= _words[w + 1] << (64 - s);
+        return ret;
+    }
+
+    // or the bits of b into this signal, starting at bit offset
+    template<size_t m>
+    void deposit(size_t offset, Signal<m> const &b)
+    {
+        size_t w = offset / 64, s = offset % 64;
+        for(size_t i = 0; i < Signal<m>::words && w + i < words; i++) {
+            _words[w + i] |= b._words[i] << s;
+            if(s != 0 && w + i + 1 < words)
+                _words[w + i + 1] |= b._words[i] >> (64 - s);
+        }
+        mask_tail();
+    }
+
+    static void mul64(uint64_t a, uint64_t b, uint64_t &lo, uint64_t &hi)
     {
-        for(size_t i = 0; i < n; i++)
-            if(i < 32)
-                _bits[i] = val & (1<<i);
-            else
-                _bits[i] = false;
+        uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+        uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+        uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+        lo = (mid << 32) | (uint32_t)p0;
+        hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
     }
 
-    Signal(std::initializer_list<uint32_t> vals)
+    static int popcount64(uint64_t x)
     {
-        size_t k, i;
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        int ret = 0;
+        for(; x != 0; x &= x - 1)
+            ret++;
+        return ret;
+#endif
+    }
+public:
+    Signal() : _words{} { }
+    Signal(uint32_t val) : _words{}
+    {
+        _words[0] = val;
+        mask_tail();
+    }
 
-        k = 0;
+    Signal(std::initializer_list<uint32_t> vals) : _words{}
+    {
+        size_t k = 0;
         for (auto val : vals) {
-            for(i = 0; i < 32; i++)
-                if(i + k < n)
-                    _bits[i + k] = val & (1<<i);
+            if(k / 64 < words)
+                _words[k / 64] |= (uint64_t)val << (k % 64);
             k += 32;
         }
-        for(; k < n; k++)
-            _bits[k] = false;
+        mask_tail();
     }
 
     template<typename T>
     static Signal from_array(T vals)
     {
-        size_t k, i;
         Signal ret;
-
-        k = 0;
+        size_t k = 0;
         for (auto val : vals) {
-            for(i = 0; i < 32; i++)
-                if(i + k < n)
-                    ret._bits[i + k] = val & (1<<i);
+            if(k / 64 < words)
+                ret._words[k / 64] |= (uint64_t)(uint32_t)val << (k % 64);
             k += 32;
         }
-        for(; k < n; k++)
-            ret._bits[k] = false;
+        ret.mask_tail();
         return ret;
     }
 
     static Signal from_signed(int32_t val)
     {
         Signal<n> ret;
-        for(size_t i = 0; i < n; i++)
-            if(i < 32)
-                ret._bits[i] = val & (1<<i);
-            else
-                ret._bits[i] = val < 0;
+        ret._words.fill(val < 0 ? ~(uint64_t)0 : 0);
+        ret._words[0] = (uint64_t)(int64_t)val;
+        ret.mask_tail();
         return ret;
     }
     static Signal repeat(bool b)
     {
         Signal<n> ret;
-        for(size_t i = 0; i < n; i++)
-            ret._bits[i] = b;
+        if(b) {
+            ret._words.fill(~(uint64_t)0);
+            ret.mask_tail();
+        }
         return ret;
     }
 
     int size() const { return n; }
-    bool operator[](int i) const { assert(n >= 0 && i < n); return _bits[i]; }
+    bool operator[](int i) const { assert(i >= 0 && (size_t)i < n); return (_words[i / 64] >> (i % 64)) & 1; }
 
     template<size_t m>
     Signal<m> slice(size_t offset) const
@@ -102,52 +145,61 @@ public:
         Signal<m> ret;
 
         assert(offset + m <= n);
-        std::copy(_bits.begin() + offset, _bits.begin() + offset + m, ret._bits.begin());
+        if(offset % 64 == 0)
+            std::copy(_words.begin() + offset / 64, _words.begin() + offset / 64 + Signal<m>::words, ret._words.begin());
+        else
+            for(size_t i = 0; i < Signal<m>::words; i++)
+                ret._words[i] = extract_word(offset + 64 * i);
+        ret.mask_tail();
         return ret;
     }
 
     bool any() const
     {
-        for(int i = 0; i < n; i++)
-            if(_bits[i])
+        for(size_t i = 0; i < words; i++)
+            if(_words[i] != 0)
                 return true;
         return false;
     }
 
     bool all() const
     {
-        for(int i = 0; i < n; i++)
-            if(!_bits[i])
+        for(size_t i = 0; i + 1 < words; i++)
+            if(_words[i] != ~(uint64_t)0)
                 return false;
-        return true;
+        return _words[words - 1] == tail_mask;
     }
 
     bool parity() const
     {
-        bool result = false;
-        for(int i = 0; i < n; i++)
-            result ^= _bits[i];
-        return result;
+        uint64_t x = 0;
+        for(size_t i = 0; i < words; i++)
+            x ^= _words[i];
+        return popcount64(x) & 1;
     }
 
-    bool sign() const { return _bits[n-1]; }
+    bool sign() const { return n != 0 && (*this)[n-1]; }
 
     template<typename T>
     T as_numeric() const
     {
         T ret = 0;
-        for(size_t i = 0; i < std::min<size_t>(sizeof(T) * 8, n); i++)
-            if(_bits[i])
-                ret |= ((T)1)<<i;
+        for(size_t i = 0; i < words && 64 * i < sizeof(T) * 8; i++)
+            ret |= (T)_words[i] << (64 * i);
         return ret;
     }
 
     template<typename T>
     T as_numeric_clamped() const
     {
-        for(size_t i = sizeof(T) * 8; i < n; i++)
-            if(_bits[i])
+        constexpr size_t bits = sizeof(T) * 8;
+        for(size_t i = bits / 64; bits < n && i < words; i++) {
+            uint64_t w = _words[i];
+            if(i == bits / 64)
+                w >>= bits % 64;
+            if(w != 0)
                 return ~((T)0);
+        }
         return as_numeric<T>();
     }
 
@@ -157,7 +209,7 @@ private:
     std::string as_string_p2(int b) const {
         std::string ret;
         for(int i = (n - 1) - (n - 1) % b; i >= 0; i -= b)
-            ret += "0123456789abcdef"[(*this >> Signal<32>(i)).as_int() & ((1<<b)-1)];
+            ret += "0123456789abcdef"[extract_word(i) & ((1<<b)-1)];
         return ret;
     }
     std::string as_string_b10() const {
@@ -198,57 +250,65 @@ public:
     Signal<n> operator ~() const
     {
         Signal<n> ret;
-        for(size_t i = 0; i < n; i++)
-            ret._bits[i] = !_bits[i];
+        for(size_t i = 0; i < words; i++)
+            ret._words[i] = ~_words[i];
+        ret.mask_tail();
         return ret;
     }
 
-    Signal<n> operator -() const
-    {
-        Signal<n> ret;
-        int x = 1;
-        for(size_t i = 0; i < n; i++) {
-            x += (int)!_bits[i];
-            ret._bits[i] = (x & 1) != 0;
-            x >>= 1;
-        }
-        return ret;
-    }
+    Signal<n> operator -() const { return Signal<n>() - *this; }
 
     Signal<n> operator +(Signal<n> const &b) const
     {
         Signal<n> ret;
-        int x = 0;
-        for(size_t i = 0; i < n; i++){
-            x += (int)_bits[i] + (int)b._bits[i];
-            ret._bits[i] = x & 1;
-            x >>= 1;
+        uint64_t carry = 0;
+        for(size_t i = 0; i < words; i++){
+            uint64_t sum = _words[i] + carry;
+            carry = sum < carry;
+            ret._words[i] = sum + b._words[i];
+            carry += ret._words[i] < sum;
         }
+        ret.mask_tail();
         return ret;
     }
 
     Signal<n> operator -(Signal<n> const &b) const
     {
         Signal<n> ret;
-        int x = 1;
-        for(size_t i = 0; i < n; i++){
-            x += (int)_bits[i] + (int)!b._bits[i];
-            ret._bits[i] = x & 1;
-            x >>= 1;
+        uint64_t borrow = 0;
+        for(size_t i = 0; i < words; i++){
+            uint64_t diff = _words[i] - b._words[i];
+            uint64_t next_borrow = _words[i] < b._words[i];
+            next_borrow += diff < borrow;
+            ret._words[i] = diff - borrow;
+            borrow = next_borrow;
         }
+        ret.mask_tail();
         return ret;
     }
 
     Signal<n> operator *(Signal<n> const &b) const
     {
         Signal<n> ret;
-        int x = 0;
-        for(size_t i = 0; i < n; i++){
-            for(size_t j = 0; j <= i; j++)
-                x += (int)_bits[j] & (int)b._bits[i-j];
-            ret._bits[i] = x & 1;
-            x >>= 1;
+        if(words == 1) {
+            ret._words[0] = _words[0] * b._words[0];
+            ret.mask_tail();
+            return ret;
+        }
+        for(size_t i = 0; i < words; i++){
+            uint64_t carry = 0;
+            for(size_t j = 0; i + j < words; j++){
+                uint64_t lo, hi;
+                mul64(_words[i], b._words[j], lo, hi);
+                uint64_t sum = ret._words[i + j] + lo;
+                hi += sum < lo;
+                sum += carry;
+                hi += sum < carry;
+                ret._words[i + j] = sum;
+                carry = hi;
+            }
         }
+        ret.mask_tail();
         return ret;
     }
 
@@ -256,116 +316,135 @@ private:
     Signal<n> divmod(Signal<n> const &b, bool modulo) const
     {
         if(!b.any()) return 0;
+        if(words == 1) {
+            Signal<n> ret;
+            ret._words[0] = modulo ? _words[0] % b._words[0] : _words[0] / b._words[0];
+            return ret;
+        }
         Signal<n> q = 0;
         Signal<n> r = 0;
         for(size_t i = n; i-- != 0; ){
-            r = r << Signal<1>(1);
-            r._bits[0] = _bits[i];
-            if(r >= b){
+            // r < b before the shift, so r - b below fits in n bits even
+            // when the shift carries out of the top bit
+            bool overflow = r.sign();
+            r = r.shift_left(1);
+            r._words[0] |= (*this)[i];
+            if(overflow || r >= b){
                 r = r - b;
-                q._bits[i] = true;
+                q._words[i / 64] |= (uint64_t)1 << (i % 64);
             }
         }
         return modulo ? r : q;
     }
+
+    Signal<n> shift_left(size_t amount) const
+    {
+        Signal<n> ret;
+        if(amount >= n)
+            return ret;
+        size_t w = amount / 64, s = amount % 64;
+        for(size_t i = words; i-- > w; ){
+            ret._words[i] = _words[i - w] << s;
+            if(s != 0 && i > w)
+                ret._words[i] |= _words[i - w - 1] >> (64 - s);
+        }
+        ret.mask_tail();
+        return ret;
+    }
+
+    Signal<n> shift_right(size_t amount) const
+    {
+        Signal<n> ret;
+        if(amount >= n)
+            return ret;
+        for(size_t i = 0; i < words; i++)
+            ret._words[i] = extract_word(amount + 64 * i);
+        return ret;
+    }
 public:
 
     Signal<n> operator /(Signal<n> const &b) const { return divmod(b, false); }
     Signal<n> operator %(Signal<n> const &b) const { return divmod(b, true); }
 
-    bool operator ==(Signal<n> const &b) const
-    {
-        for(size_t i = 0; i < n; i++)
-            if(_bits[i] != b._bits[i])
-                return false;
-        return true;
-    }
+    bool operator ==(Signal<n> const &b) const { return _words == b._words; }
 
     bool operator >=(Signal<n> const &b) const
     {
-        for(size_t i = n; i-- != 0; )
-            if(_bits[i] != b._bits[i])
-                return _bits[i];
+        for(size_t i = words; i-- != 0; )
+            if(_words[i] != b._words[i])
+                return _words[i] > b._words[i];
         return true;
     }
 
     bool operator >(Signal<n> const &b) const
     {
-        for(size_t i = n; i-- != 0; )
-            if(_bits[i] != b._bits[i])
-                return _bits[i];
+        for(size_t i = words; i-- != 0; )
+            if(_words[i] != b._words[i])
+                return _words[i] > b._words[i];
         return false;
     }
 
     bool operator !=(Signal<n> const &b) const { return !(*this == b); }
-    bool operator <=(Signal<n> const &b) const { return b <= *this; }
-    bool operator <(Signal<n> const &b) const { return b < *this; }
+    bool operator <=(Signal<n> const &b) const { return b >= *this; }
+    bool operator <(Signal<n> const &b) const { return b > *this; }
 
     bool signed_greater_than(Signal<n> const &b) const
     {
-        if(_bits[n-1] != b._bits[n-1])
-            return b._bits[n-1];
+        if(sign() != b.sign())
+            return b.sign();
         return *this > b;
     }
 
     bool signed_greater_equal(Signal<n> const &b) const
     {
-        if(_bits[n-1] != b._bits[n-1])
-            return b._bits[n-1];
+        if(sign() != b.sign())
+            return b.sign();
         return *this >= b;
     }
 
     Signal<n> operator &(Signal<n> const &b) const
     {
         Signal<n> ret;
-        for(size_t i = 0; i < n; i++)
-            ret._bits[i] = _bits[i] && b._bits[i];
+        for(size_t i = 0; i < words; i++)
+            ret._words[i] = _words[i] & b._words[i];
         return ret;
     }
 
     Signal<n> operator |(Signal<n> const &b) const
     {
         Signal<n> ret;
-        for(size_t i = 0; i < n; i++)
-            ret._bits[i] = _bits[i] || b._bits[i];
+        for(size_t i = 0; i < words; i++)
+            ret._words[i] = _words[i] | b._words[i];
         return ret;
     }
 
     Signal<n> operator ^(Signal<n> const &b) const
     {
         Signal<n> ret;
-        for(size_t i = 0; i < n; i++)
-            ret._bits[i] = _bits[i] != b._bits[i];
+        for(size_t i = 0; i < words; i++)
+            ret._words[i] = _words[i] ^ b._words[i];
         return ret;
     }
 
     template<size_t nb>
     Signal<n> operator <<(Signal<nb> const &b) const
     {
-        Signal<n> ret = 0;
-        size_t amount = b.template as_numeric_clamped<size_t>();
-        if(amount < n)
-            std::copy(_bits.begin(), _bits.begin() + (n - amount), ret._bits.begin() + amount);
-        return ret;
+        return shift_left(b.template as_numeric_clamped<size_t>());
     }
 
     template<size_t nb>
     Signal<n> operator >>(Signal<nb> const &b) const
     {
-        Signal<n> ret = 0;
-        size_t amount = b.template as_numeric_clamped<size_t>();
-        if(amount < n)
-            std::copy(_bits.begin() + amount, _bits.end(), ret._bits.begin());
-        return ret;
+        return shift_right(b.template as_numeric_clamped<size_t>());
     }
 
     template<size_t nb>
     Signal<n> arithmetic_shift_right(Signal<nb> const &b) const
     {
-        Signal<n> ret = Signal::repeat(sign());
         size_t amount = b.template as_numeric_clamped<size_t>();
-        if(amount < n)
-            std::copy(_bits.begin() + amount, _bits.end(), ret._bits.begin());
+        Signal<n> ret = shift_right(amount);
+        if(sign())
+            ret = ret | ~Signal::repeat(true).shift_right(amount);
         return ret;
     }
 
@@ -373,8 +452,8 @@ public:
     Signal<n+m> concat(Signal<m> const& b) const
     {
         Signal<n + m> ret;
-        std::copy(_bits.begin(), _bits.end(), ret._bits.begin());
-        std::copy(b._bits.begin(), b._bits.end(), ret._bits.begin() + n);
+        std::copy(_words.begin(), _words.end(), ret._words.begin());
+        ret.deposit(n, b);
         return ret;
     }
 
@@ -382,8 +461,8 @@ public:
     Signal<m> zero_extend() const
     {
         assert(m >= n);
-        Signal<m> ret = 0;
-        std::copy(_bits.begin(), _bits.end(), ret._bits.begin());
+        Signal<m> ret;
+        std::copy(_words.begin(), _words.end(), ret._words.begin());
         return ret;
     }
 
@@ -391,26 +470,96 @@ public:
     Signal<m> sign_extend() const
     {
         assert(m >= n);
-        Signal<m> ret = Signal<m>::repeat(sign());
-        std::copy(_bits.begin(), _bits.end(), ret._bits.begin());
+        Signal<m> ret = zero_extend<m>();
+        if(sign())
+            ret = ret | ~Signal<m>::repeat(true).shift_right(m - n);
         return ret;
     }
 };
 
+// Memories are persistent radix trees over the address bits: copying a memory
+// shares all of its nodes, and write() copies only the nodes on the path to
+// the written address, so both take O(log n) time and space regardless of the
+// size of the memory. Nodes are immutable once they are reachable from a
+// Memory, which is what allows the sharing.
 template<size_t a, size_t d>
 class Memory {
-    std::array<Signal<d>, 1<<a> _contents;
+    static constexpr size_t leaf_bits = a < 4 ? a : 4;
+    static constexpr size_t inner_bits = 4;
+    static constexpr size_t levels = (a - leaf_bits + inner_bits - 1) / inner_bits;
+
+    struct Node { };
+    struct Leaf : Node {
+        std::array<Signal<d>, 1<<leaf_bits> data;
+    };
+    struct Inner : Node {
+        std::array<std::shared_ptr<const Node>, 1<<inner_bits> children;
+    };
+
+    std::shared_ptr<const Node> _root;
+
+    static size_t child_index(size_t addr, size_t level)
+    {
+        return (addr >> (leaf_bits + inner_bits * (level - 1))) & ((1<<inner_bits) - 1);
+    }
+
+    static std::shared_ptr<const Node> filled(Signal<d> const &value)
+    {
+        auto leaf = std::make_shared<Leaf>();
+        leaf->data.fill(value);
+        std::shared_ptr<const Node> node = leaf;
+        for(size_t level = 1; level <= levels; level++) {
+            auto inner = std::make_shared<Inner>();
+            inner->children.fill(node);
+            node = inner;
+        }
+        return node;
+    }
+
+    template<typename T>
+    static std::shared_ptr<const Node> build(T const &contents, size_t base, size_t level)
+    {
+        if(level == 0) {
+            auto leaf = std::make_shared<Leaf>();
+            for(size_t i = 0; i < leaf->data.size() && base + i < contents.size(); i++)
+                leaf->data[i] = contents[base + i];
+            return leaf;
+        }
+        auto inner = std::make_shared<Inner>();
+        size_t stride = (size_t)1 << (leaf_bits + inner_bits * (level - 1));
+        for(size_t i = 0; i < inner->children.size() && base + i * stride < contents.size(); i++)
+            inner->children[i] = build(contents, base + i * stride, level - 1);
+        return inner;
+    }
+
+    static std::shared_ptr<const Node> update(Node const *node, size_t addr, Signal<d> const &data, size_t level)
+    {
+        if(level == 0) {
+            auto leaf = std::make_shared<Leaf>(static_cast<Leaf const &>(*node));
+            leaf->data[addr & ((1<<leaf_bits) - 1)] = data;
+            return leaf;
+        }
+        auto inner = std::make_shared<Inner>(static_cast<Inner const &>(*node));
+        auto &child = inner->children[child_index(addr, level)];
+        child = update(child.get(), addr, data, level - 1);
+        return inner;
+    }
 public:
-    Memory() {}
-    Memory(std::array<Signal<d>, 1<<a> const &contents) : _contents(contents) {}
+    Memory() : _root(filled(Signal<d>())) {}
+    explicit Memory(Signal<d> const &value) : _root(filled(value)) {}
+    Memory(std::array<Signal<d>, 1<<a> const &contents) : _root(build(contents, 0, levels)) {}
     Signal<d> read(Signal<a> addr) const
     {
-        return _contents[addr.template as_numeric<size_t>()];
+        size_t i = addr.template as_numeric<size_t>();
+        Node const *node = _root.get();
+        for(size_t level = levels; level > 0; level--)
+            node = static_cast<Inner const *>(node)->children[child_index(i, level)].get();
+        return static_cast<Leaf const *>(node)->data[i & ((1<<leaf_bits) - 1)];
     }
     Memory write(Signal<a> addr, Signal<d> data) const
     {
         Memory ret = *this;
-        ret._contents[addr.template as_numeric<size_t>()] = data;
+        ret._root = update(_root.get(), addr.template as_numeric<size_t>(), data, levels);
         return ret;
     }
 };
@@ -192,7 +192,7 @@ struct SmtModule {
 	SmtStruct output_struct;
 	SmtStruct state_struct;
 
-	SmtModule(Module *module)
+	SmtModule(Module *module, bool optimize)
 		: ir(Functional::IR::from_module(module))
 		, scope()
 		, name(scope.unique_name(module->name))
@@ -200,6 +200,8 @@ struct SmtModule {
 		, output_struct(scope.unique_name(module->name.str() + "_Outputs"), scope)
 		, state_struct(scope.unique_name(module->name.str() + "_State"), scope)
 	{
+		if (optimize)
+			ir.optimize();
 		scope.reserve(name + "-initial");
 		for (auto input : ir.inputs())
 			input_struct.insert(input->name, input->sort);
@@ -275,18 +277,39 @@ struct SmtModule {
 struct FunctionalSmtBackend : public Backend {
 	FunctionalSmtBackend() : Backend("functional_smt2", "Generate SMT-LIB from Functional IR") {}
 
-	void help() override { log("\nFunctional SMT Backend.\n\n"); }
+	void help() override {
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    write_functional_smt2 [options] [filename]\n");
+		log("\n");
+		log("Functional SMT Backend.\n");
+		log("\n");
+		log("    -noopt\n");
+		log("        do not optimize the functional IR before writing it (merging duplicate\n");
+		log("        nodes, folding constants, slices and concatenations)\n");
+		log("\n");
+	}
 
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		log_header(design, "Executing Functional SMT Backend.\n");
 
-		size_t argidx = 1;
+		bool optimize = true;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-noopt") {
+				optimize = false;
+				continue;
+			}
+			break;
+		}
 		extra_args(f, filename, args, argidx, design);
 
 		for (auto module : design->selected_modules()) {
 			log("Processing module `%s`.\n", module->name.c_str());
-			SmtModule smt(module);
+			SmtModule smt(module, optimize);
 			smt.write(*f);
 		}
 	}
@@ -193,7 +193,7 @@ struct SmtrModule {
 	SmtrStruct output_struct;
 	SmtrStruct state_struct;
 
-	SmtrModule(Module *module)
+	SmtrModule(Module *module, bool optimize)
 		: ir(Functional::IR::from_module(module))
 		, scope()
 		, name(scope.unique_name(module->name))
@@ -201,6 +201,8 @@ struct SmtrModule {
 		, output_struct(scope.unique_name(module->name.str() + "_Outputs"), scope)
 		, state_struct(scope.unique_name(module->name.str() + "_State"), scope)
 	{
+		if (optimize)
+			ir.optimize();
 		scope.reserve(name + "_initial");
 		for (auto input : ir.inputs())
 			input_struct.insert(input->name, input->sort);
@@ -283,11 +285,16 @@ struct FunctionalSmtrBackend : public Backend {
 		log("    -provides\n");
 		log("        include 'provide' statement(s) for loading output as a module\n");
 		log("\n");
+		log("    -noopt\n");
+		log("        do not optimize the functional IR before writing it (merging duplicate\n");
+		log("        nodes, folding constants, slices and concatenations)\n");
+		log("\n");
 	}
 
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		auto provides = false;
+		auto optimize = true;
 
 		log_header(design, "Executing Functional Rosette Backend.\n");
 
@@ -296,6 +303,8 @@ struct FunctionalSmtrBackend : public Backend {
 		{
 			if (args[argidx] == "-provides")
 				provides = true;
+			else if (args[argidx] == "-noopt")
+				optimize = false;
 			else
 				break;
 		}
@@ -308,7 +317,7 @@ struct FunctionalSmtrBackend : public Backend {
 
 		for (auto module : design->selected_modules()) {
 			log("Processing module `%s`.\n", module->name.c_str());
-			SmtrModule smtr(module);
+			SmtrModule smtr(module, optimize);
 			smtr.write(*f);
 		}
 	}
@@ -35,9 +35,9 @@ struct Smt2Worker
 	CellTypes ct;
 	SigMap sigmap;
 	RTLIL::Module *module;
-	bool bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode;
+	bool bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, compactmode;
 	dict<IdString, int> &mod_stbv_width;
-	int idcounter = 0, statebv_width = 0;
+	int idcounter = 0, statebv_width = 0, shared_count = 0;
 
 	std::vector<std::string> decls, trans, hier, dtmembers;
 	std::map<RTLIL::SigBit, RTLIL::Cell*> bit_driver;
@@ -54,6 +54,7 @@ struct Smt2Worker
 	std::map<Mem*, int> memarrays;
 	std::map<int, int> bvsizes;
 	dict<IdString, char*> ids;
+	dict<std::string, int> shared_funs;
 
 	bool is_smtlib2_module;
 
@@ -116,9 +117,9 @@ struct Smt2Worker
 	}
 
 	Smt2Worker(RTLIL::Module *module, bool bvmode, bool memmode, bool wiresmode, bool verbose, bool statebv, bool statedt, bool forallmode,
-		   dict<IdString, int> &mod_stbv_width, dict<IdString, dict<IdString, pair<bool, bool>>> &mod_clk_cache)
+		   bool compactmode, dict<IdString, int> &mod_stbv_width, dict<IdString, dict<IdString, pair<bool, bool>>> &mod_clk_cache)
 	    : ct(module->design), sigmap(module), module(module), bvmode(bvmode), memmode(memmode), wiresmode(wiresmode), verbose(verbose),
-	      statebv(statebv), statedt(statedt), forallmode(forallmode), mod_stbv_width(mod_stbv_width),
+	      statebv(statebv), statedt(statedt), forallmode(forallmode), compactmode(compactmode), mod_stbv_width(mod_stbv_width),
 	      is_smtlib2_module(module->has_attribute(ID::smtlib2_module))
 	{
 		pool<SigBit> noclock;
@@ -304,8 +305,13 @@ struct Smt2Worker
 		log_assert(bvmode);
 		sigmap.apply(sig);
 
-		log_assert(bvsizes.count(id) == 0);
-		bvsizes[id] = GetSize(sig);
+		if (compactmode && bvsizes.count(id)) {
+			// a shared function, see define_fun()
+			log_assert(bvsizes.at(id) == GetSize(sig));
+		} else {
+			log_assert(bvsizes.count(id) == 0);
+			bvsizes[id] = GetSize(sig);
+		}
 
 		for (int i = 0; i < GetSize(sig); i++) {
 			log_assert(fcache.count(sig[i]) == 0);
@@ -433,6 +439,27 @@ struct Smt2Worker
 		}
 	}
 
+	// Defines the function for a cell output and returns its id. In compact
+	// mode a function with the same sort and body is defined only once, and
+	// cells computing the same expression share it.
+	int define_fun(const std::string &sort, const std::string &expr, RTLIL::SigSpec sig)
+	{
+		if (compactmode) {
+			std::string key = sort + " " + expr;
+			auto it = shared_funs.find(key);
+			if (it != shared_funs.end()) {
+				if (verbose) log("%*s-> shared: %s#%d\n", 2+2*GetSize(recursive_cells), "", get_id(module), it->second);
+				shared_count++;
+				return it->second;
+			}
+			shared_funs[key] = idcounter;
+		}
+
+		decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) %s %s) ; %s\n",
+				get_id(module), idcounter, get_id(module), sort.c_str(), expr.c_str(), log_signal(sig)));
+		return idcounter++;
+	}
+
 	void export_gate(RTLIL::Cell *cell, std::string expr)
 	{
 		RTLIL::SigBit bit = sigmap(cell->getPort(ID::Y).as_bit());
@@ -450,9 +477,7 @@ struct Smt2Worker
 		if (verbose)
 			log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-		decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) Bool %s) ; %s\n",
-				get_id(module), idcounter, get_id(module), processed_expr.c_str(), log_signal(bit)));
-		register_bool(bit, idcounter++);
+		register_bool(bit, define_fun("Bool", processed_expr, bit));
 		recursive_cells.erase(cell);
 	}
 
@@ -500,15 +525,10 @@ struct Smt2Worker
 		if (verbose)
 			log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-		if (type == 'b') {
-			decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) Bool %s) ; %s\n",
-					get_id(module), idcounter, get_id(module), processed_expr.c_str(), log_signal(sig_y)));
-			register_boolvec(sig_y, idcounter++);
-		} else {
-			decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) (_ BitVec %d) %s) ; %s\n",
-					get_id(module), idcounter, get_id(module), GetSize(sig_y), processed_expr.c_str(), log_signal(sig_y)));
-			register_bv(sig_y, idcounter++);
-		}
+		if (type == 'b')
+			register_boolvec(sig_y, define_fun("Bool", processed_expr, sig_y));
+		else
+			register_bv(sig_y, define_fun(stringf("(_ BitVec %d)", GetSize(sig_y)), processed_expr, sig_y));
 
 		recursive_cells.erase(cell);
 	}
@@ -531,9 +551,7 @@ struct Smt2Worker
 		if (verbose)
 			log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-		decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) Bool %s) ; %s\n",
-				get_id(module), idcounter, get_id(module), processed_expr.c_str(), log_signal(sig_y)));
-		register_boolvec(sig_y, idcounter++);
+		register_boolvec(sig_y, define_fun("Bool", processed_expr, sig_y));
 		recursive_cells.erase(cell);
 	}
 
@@ -753,9 +771,7 @@ struct Smt2Worker
 					log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
 				RTLIL::SigSpec sig = sigmap(cell->getPort(ID::Y));
-				decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) (_ BitVec %d) %s) ; %s\n",
-						get_id(module), idcounter, get_id(module), width, processed_expr.c_str(), log_signal(sig)));
-				register_bv(sig, idcounter++);
+				register_bv(sig, define_fun(stringf("(_ BitVec %d)", width), processed_expr, sig));
 				recursive_cells.erase(cell);
 				return;
 			}
@@ -1506,6 +1522,15 @@ struct Smt2Worker
 		else
 			f << "true)";
 		f << stringf(" ; end of module %s\n", get_id(module));
+
+		if (compactmode) {
+			f << stringf("; yosys-smt2-step\n");
+			f << stringf("(define-fun |%s_step| ((state |%s_s|) (next_state |%s_s|)) Bool (and (|%s_t| state next_state) "
+					"(|%s_h| next_state) (|%s_u| next_state) (not (|%s_is| next_state))))\n", get_id(module), get_id(module),
+					get_id(module), get_id(module), get_id(module), get_id(module), get_id(module));
+			if (shared_count > 0)
+				log("Shared %d duplicate cell functions in module %s.\n", shared_count, log_id(module));
+		}
 	}
 
 	template<class T> static std::vector<std::string> witness_path(T *obj) {
@@ -1653,6 +1678,12 @@ struct Smt2Backend : public Backend {
 		log("    (define-fun |<mod>_u| ((state |<mod>_s|)) Bool (...))\n");
 		log("        This function evaluates to 'true' if all assumptions hold in the state.\n");
 		log("\n");
+		log("    ; yosys-smt2-step\n");
+		log("    (define-fun |<mod>_step| ((state |<mod>_s|) (next_state |<mod>_s|)) Bool (...))\n");
+		log("        Only with -compact. This function combines everything that has to be\n");
+		log("        asserted for a non-initial state 'next_state' that follows 'state': the\n");
+		log("        transition, the hierarchy, the assumptions and '<mod>_is' being false.\n");
+		log("\n");
 		log("    ; yosys-smt2-assert <id> <filename:linenum>\n");
 		log("    (define-fun |<mod>_a <id>| ((state |<mod>_s|)) Bool (...))\n");
 		log("        Each $assert cell is converted into one of this functions. The function\n");
@@ -1699,6 +1730,11 @@ struct Smt2Backend : public Backend {
 		log("        create '<mod>_n' functions for all public wires. by default only ports,\n");
 		log("        registers, and wires with the 'keep' attribute are exported.\n");
 		log("\n");
+		log("    -compact\n");
+		log("        define a function only once for cells that compute the same expression\n");
+		log("        and emit the '<mod>_step' function. yosys-smtbmc uses the latter to\n");
+		log("        unroll the transition relation with one assertion per step.\n");
+		log("\n");
 		log("    -tpl <template_file>\n");
 		log("        use the given template file. the line containing only the token '%%%%'\n");
 		log("        is replaced with the regular output of this command.\n");
@@ -1760,7 +1796,7 @@ struct Smt2Backend : public Backend {
 	{
 		std::ifstream template_f;
 		bool bvmode = true, memmode = true, wiresmode = false, verbose = false, statebv = false, statedt = false;
-		bool forallmode = false;
+		bool forallmode = false, compactmode = false;
 		dict<std::string, std::string> solver_options;
 
 		log_header(design, "Executing SMT2 backend.\n");
@@ -1810,6 +1846,10 @@ struct Smt2Backend : public Backend {
 				verbose = true;
 				continue;
 			}
+			if (args[argidx] == "-compact") {
+				compactmode = true;
+				continue;
+			}
 			if (args[argidx] == "-solver-option" && argidx+2 < args.size()) {
 				solver_options.emplace(args[argidx+1], args[argidx+2]);
 				argidx += 2;
@@ -1904,7 +1944,7 @@ struct Smt2Backend : public Backend {
 
 			log("Creating SMT-LIBv2 representation of module %s.\n", log_id(module));
 
-			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, mod_stbv_width, mod_clk_cache);
+			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, compactmode, mod_stbv_width, mod_clk_cache);
 			worker.run();
 			worker.write(*f);
 
@@ -1627,6 +1627,27 @@ def smt_state(step):
     smt.write("(declare-fun s%d () |%s_s|)" % (step, topmod))
     states.append("s%d" % step)
 
+# With 'write_smt2 -compact' everything that is asserted for a non-initial
+# step apart from the constraints is combined in <mod>_step, and the text for a
+# step is prepared once here. Tracked assumptions must be asserted separately,
+# and the forall mode needs the antecedent/consequent split, so neither can
+# use it.
+step_template = None
+if smt.modinfo[topmod].has_step and not track_assumes and not smt.forall:
+    step_template = "(declare-fun s%%d () |%s_s|)\n(assert (|%s_step| s%%d s%%d))\n" % (topmod, topmod)
+
+def smt_step(step):
+    if step_template is None:
+        smt_state(step)
+        smt_assert_design_assumes(step)
+        smt_assert_antecedent("(|%s_h| s%d)" % (topmod, step))
+        smt_assert_antecedent("(|%s_t| s%d s%d)" % (topmod, step-1, step))
+        smt_assert_antecedent("(not (|%s_is| s%d))" % (topmod, step))
+    else:
+        smt.write_template(step_template, (step, step-1, step))
+        states.append("s%d" % step)
+    smt_assert_consequent(get_constr_expr(constr_assumes, step))
+
 def smt_assert(expr):
     if expr == "true":
         return
@@ -1954,12 +1975,11 @@ else:  # not tempind, covermode
     step = 0
     retstatus = "PASSED"
     while step < num_steps:
-        smt_state(step)
-        smt_assert_design_assumes(step)
-        smt_assert_antecedent("(|%s_h| s%d)" % (topmod, step))
-        smt_assert_consequent(get_constr_expr(constr_assumes, step))
-
         if step == 0:
+            smt_state(step)
+            smt_assert_design_assumes(step)
+            smt_assert_antecedent("(|%s_h| s%d)" % (topmod, step))
+            smt_assert_consequent(get_constr_expr(constr_assumes, step))
             if noinit:
                 smt_assert_antecedent("(not (|%s_is| s%d))" % (topmod, step))
             else:
@@ -1967,8 +1987,7 @@ else:  # not tempind, covermode
                 smt_assert_antecedent("(|%s_is| s0)" % (topmod))
 
         else:
-            smt_assert_antecedent("(|%s_t| s%d s%d)" % (topmod, step-1, step))
-            smt_assert_antecedent("(not (|%s_is| s%d))" % (topmod, step))
+            smt_step(step)
 
         if step < skip_steps:
             if assume_skipped is not None and step >= assume_skipped:
@@ -1983,12 +2002,7 @@ else:  # not tempind, covermode
         last_check_step = step
         for i in range(1, step_size):
             if step+i < num_steps:
-                smt_state(step+i)
-                smt_assert_antecedent("(not (|%s_is| s%d))" % (topmod, step+i))
-                smt_assert_design_assumes(step + i)
-                smt_assert_antecedent("(|%s_h| s%d)" % (topmod, step+i))
-                smt_assert_antecedent("(|%s_t| s%d s%d)" % (topmod, step+i-1, step+i))
-                smt_assert_consequent(get_constr_expr(constr_assumes, step+i))
+                smt_step(step+i)
                 last_check_step = step+i
 
         if not gentrace:
@@ -124,6 +124,7 @@ class SmtModInfo:
         self.allseqs = dict()
         self.asize = dict()
         self.witness = []
+        self.has_step = False
 
 
 class SmtIo:
@@ -531,6 +532,19 @@ class SmtIo:
             else:
                 self.p_write(stmt + "\n", True)
 
+    def write_template(self, template, args):
+        # Writes 'template % args', where the template is a block of newline
+        # separated statements without comments that is written many times,
+        # e.g. once per step. Unless the statements need to be looked at
+        # (unrolling, non-incremental mode, debug output) the block is sent to
+        # the solver as it is, without the per-statement processing of write().
+        text = template % args
+        if not self.setup_done or self.unroll or self.noincr or self.debug_print or self.debug_file or self.solver == "dummy":
+            for stmt in text.splitlines():
+                self.write(stmt)
+            return
+        self.p_write(text, True)
+
     def info(self, stmt):
         if not stmt.startswith("; yosys-smt2-"):
             return
@@ -567,6 +581,9 @@ class SmtIo:
         if fields[1] == "yosys-smt2-topmod":
             self.topmod = fields[2]
 
+        if fields[1] == "yosys-smt2-step":
+            self.modinfo[self.curmod].has_step = True
+
         if fields[1] == "yosys-smt2-input":
             self.modinfo[self.curmod].inputs.add(fields[2])
             self.modinfo[self.curmod].wsize[fields[2]] = int(fields[3])
@@ -38,7 +38,7 @@ USING_YOSYS_NAMESPACE
 
 using namespace VERILOG_BACKEND;
 
-const pool<string> VERILOG_BACKEND::verilog_keywords() {
+const pool<string> &VERILOG_BACKEND::verilog_keywords() {
 	static const pool<string> res = {
 		// IEEE 1800-2017 Annex B
 		"accept_on", "alias", "always", "always_comb", "always_ff", "always_latch", "and", "assert", "assign", "assume", "automatic", "before",
@@ -99,6 +99,10 @@ bool verbose, norename, noattr, attr2comment, noexpr, nodec, nohex, nostr, extme
 int auto_name_counter, auto_name_offset, auto_name_digits, extmem_counter;
 dict<RTLIL::IdString, int> auto_name_map;
 std::set<RTLIL::IdString> reg_wires;
+
+// Verilog spelling of identifiers, as returned by id(). Escaped names do not depend on the
+// module and are kept for a whole write_verilog call, auto-renamed ones only per module.
+dict<RTLIL::IdString, std::string> escaped_id_cache, renamed_id_cache;
 std::string auto_prefix, extmem_prefix;
 
 RTLIL::Module *active_module;
@@ -131,6 +135,7 @@ void reset_auto_counter_id(RTLIL::IdString id, bool may_rename)
 void reset_auto_counter(RTLIL::Module *module)
 {
 	auto_name_map.clear();
+	renamed_id_cache.clear();
 	auto_name_counter = 0;
 	auto_name_offset = 0;
 
@@ -161,13 +166,9 @@ std::string next_auto_id()
 	return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_counter++);
 }
 
-std::string id(RTLIL::IdString internal_id, bool may_rename = true)
+// Verilog spelling of a public or private name, without renaming
+std::string escaped_id(const char *str)
 {
-	const char *str = internal_id.c_str();
-
-	if (may_rename && auto_name_map.count(internal_id) != 0)
-		return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_map[internal_id]);
-
 	if (*str == '\\')
 		str++;
 
@@ -176,6 +177,25 @@ std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 	return std::string(str);
 }
 
+std::string id(RTLIL::IdString internal_id, bool may_rename = true)
+{
+	if (may_rename) {
+		auto it = auto_name_map.find(internal_id);
+		if (it != auto_name_map.end()) {
+			auto cached = renamed_id_cache.find(internal_id);
+			if (cached != renamed_id_cache.end())
+				return cached->second;
+			return renamed_id_cache[internal_id] = stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + it->second);
+		}
+	}
+
+	auto cached = escaped_id_cache.find(internal_id);
+	if (cached != escaped_id_cache.end())
+		return cached->second;
+
+	return escaped_id_cache[internal_id] = escaped_id(internal_id.c_str());
+}
+
 bool is_reg_wire(RTLIL::SigSpec sig, std::string &reg_name)
 {
 	if (!sig.is_chunk() || sig.as_chunk().wire == NULL)
@@ -350,22 +370,23 @@ void dump_sigchunk(std::ostream &f, const RTLIL::SigChunk &chunk, bool no_decima
 	if (chunk.wire == NULL) {
 		dump_const(f, chunk.data, chunk.width, chunk.offset, no_decimal);
 	} else {
+		// This is the most frequently called function when writing large netlists,
+		// so write directly to the stream instead of going through stringf().
+		f << id(chunk.wire->name);
 		if (chunk.width == chunk.wire->width && chunk.offset == 0) {
-			f << stringf("%s", id(chunk.wire->name).c_str());
+			return;
 		} else if (chunk.width == 1) {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << '[' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), chunk.offset + chunk.wire->start_offset);
+				f << '[' << chunk.offset + chunk.wire->start_offset << ']';
 		} else {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
-						(chunk.wire->width - (chunk.offset + chunk.width - 1) - 1) + chunk.wire->start_offset,
-						(chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << '[' << (chunk.wire->width - (chunk.offset + chunk.width - 1) - 1) + chunk.wire->start_offset
+						<< ':' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
-						(chunk.offset + chunk.width - 1) + chunk.wire->start_offset,
-						chunk.offset + chunk.wire->start_offset);
+				f << '[' << (chunk.offset + chunk.width - 1) + chunk.wire->start_offset
+						<< ':' << chunk.offset + chunk.wire->start_offset << ']';
 		}
 	}
 }
@@ -380,13 +401,13 @@ void dump_sigspec(std::ostream &f, const RTLIL::SigSpec &sig)
 	if (sig.is_chunk()) {
 		dump_sigchunk(f, sig.as_chunk());
 	} else {
-		f << stringf("{ ");
+		f << "{ ";
 		for (auto it = sig.chunks().rbegin(); it != sig.chunks().rend(); ++it) {
 			if (it != sig.chunks().rbegin())
-				f << stringf(", ");
+				f << ", ";
 			dump_sigchunk(f, *it, true);
 		}
-		f << stringf(" }");
+		f << " }";
 	}
 }
 
@@ -497,10 +518,10 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 				log_error("Can't open file `%s' for writing: %s\n", extmem_filename.c_str(), strerror(errno));
 			else
 			{
-				Const data = mem.get_init_data();
+				MemContents data = mem.get_init_contents();
 				for (int i=0; i<mem.size; i++)
 				{
-					RTLIL::Const element = data.extract(i*mem.width, mem.width);
+					RTLIL::Const element = data[i];
 					for (int j=0; j<element.size(); j++)
 					{
 						switch (element[element.size()-j-1])
@@ -956,14 +977,31 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 	}
 }
 
-void dump_cell_expr_port(std::ostream &f, RTLIL::Cell *cell, std::string port, bool gen_signed = true)
+// The <port>_SIGNED parameter of the ports that have one, so that the name isn't built for every cell
+RTLIL::IdString signed_param(RTLIL::IdString port)
 {
-	if (gen_signed && cell->parameters.count("\\" + port + "_SIGNED") > 0 && cell->parameters["\\" + port + "_SIGNED"].as_bool()) {
-		f << stringf("$signed(");
-		dump_sigspec(f, cell->getPort("\\" + port));
-		f << stringf(")");
-	} else
-		dump_sigspec(f, cell->getPort("\\" + port));
+	if (port == ID::A)
+		return ID::A_SIGNED;
+	if (port == ID::B)
+		return ID::B_SIGNED;
+	if (port == ID::C)
+		return ID::C_SIGNED;
+	return RTLIL::IdString();
+}
+
+void dump_cell_expr_port(std::ostream &f, RTLIL::Cell *cell, RTLIL::IdString port, bool gen_signed = true)
+{
+	RTLIL::IdString param = gen_signed ? signed_param(port) : RTLIL::IdString();
+	if (!param.empty()) {
+		auto it = cell->parameters.find(param);
+		if (it != cell->parameters.end() && it->second.as_bool()) {
+			f << "$signed(";
+			dump_sigspec(f, cell->getPort(port));
+			f << ")";
+			return;
+		}
+	}
+	dump_sigspec(f, cell->getPort(port));
 }
 
 std::string cellname(RTLIL::Cell *cell)
@@ -993,7 +1031,8 @@ std::string cellname(RTLIL::Cell *cell)
 		if (active_module && active_module->count_id(cell_name) > 0)
 				goto no_special_reg_name;
 
-		return id(cell_name);
+		// not an existing name, so neither renamed nor worth caching
+		return escaped_id(cell_name.c_str());
 	}
 	else
 	{
@@ -1008,7 +1047,7 @@ void dump_cell_expr_uniop(std::ostream &f, std::string indent, RTLIL::Cell *cell
 	dump_sigspec(f, cell->getPort(ID::Y));
 	f << stringf(" = %s ", op.c_str());
 	dump_attributes(f, "", cell->attributes, " ");
-	dump_cell_expr_port(f, cell, "A", true);
+	dump_cell_expr_port(f, cell, ID::A, true);
 	f << stringf(";\n");
 }
 
@@ -1017,10 +1056,10 @@ void dump_cell_expr_binop(std::ostream &f, std::string indent, RTLIL::Cell *cell
 	f << stringf("%s" "assign ", indent.c_str());
 	dump_sigspec(f, cell->getPort(ID::Y));
 	f << stringf(" = ");
-	dump_cell_expr_port(f, cell, "A", true);
+	dump_cell_expr_port(f, cell, ID::A, true);
 	f << stringf(" %s ", op.c_str());
 	dump_attributes(f, "", cell->attributes, " ");
-	dump_cell_expr_port(f, cell, "B", true);
+	dump_cell_expr_port(f, cell, ID::B, true);
 	f << stringf(";\n");
 }
 
@@ -1086,47 +1125,38 @@ void dump_cell_expr_check(std::ostream &f, std::string indent, const RTLIL::Cell
 bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 {
 	if (cell->type == ID($_NOT_)) {
-		f << stringf("%s" "assign ", indent.c_str());
+		f << indent << "assign ";
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
-		f << stringf("~");
+		f << " = ~";
 		dump_attributes(f, "", cell->attributes, " ");
-		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(";\n");
+		dump_cell_expr_port(f, cell, ID::A, false);
+		f << ";\n";
 		return true;
 	}
 
 	if (cell->type.in(ID($_BUF_), ID($buf))) {
-		f << stringf("%s" "assign ", indent.c_str());
+		f << indent << "assign ";
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
-		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(";\n");
+		f << " = ";
+		dump_cell_expr_port(f, cell, ID::A, false);
+		f << ";\n";
 		return true;
 	}
 
 	if (cell->type.in(ID($_AND_), ID($_NAND_), ID($_OR_), ID($_NOR_), ID($_XOR_), ID($_XNOR_), ID($_ANDNOT_), ID($_ORNOT_))) {
-		f << stringf("%s" "assign ", indent.c_str());
+		// Gate-level netlists consist mostly of these, so classify the cell type only once.
+		bool invert_y = cell->type.in(ID($_NAND_), ID($_NOR_), ID($_XNOR_));
+		bool invert_b = cell->type.in(ID($_ANDNOT_), ID($_ORNOT_));
+		char op = cell->type.in(ID($_AND_), ID($_NAND_), ID($_ANDNOT_)) ? '&' : cell->type.in(ID($_OR_), ID($_NOR_), ID($_ORNOT_)) ? '|' : '^';
+		f << indent << "assign ";
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
-		if (cell->type.in(ID($_NAND_), ID($_NOR_), ID($_XNOR_)))
-			f << stringf("~(");
-		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(" ");
-		if (cell->type.in(ID($_AND_), ID($_NAND_), ID($_ANDNOT_)))
-			f << stringf("&");
-		if (cell->type.in(ID($_OR_), ID($_NOR_), ID($_ORNOT_)))
-			f << stringf("|");
-		if (cell->type.in(ID($_XOR_), ID($_XNOR_)))
-			f << stringf("^");
+		f << (invert_y ? " = ~(" : " = ");
+		dump_cell_expr_port(f, cell, ID::A, false);
+		f << ' ' << op;
 		dump_attributes(f, "", cell->attributes, " ");
-		f << stringf(" ");
-		if (cell->type.in(ID($_ANDNOT_), ID($_ORNOT_)))
-			f << stringf("~(");
-		dump_cell_expr_port(f, cell, "B", false);
-		if (cell->type.in(ID($_NAND_), ID($_NOR_), ID($_XNOR_), ID($_ANDNOT_), ID($_ORNOT_)))
-			f << stringf(")");
-		f << stringf(";\n");
+		f << (invert_b ? " ~(" : " ");
+		dump_cell_expr_port(f, cell, ID::B, false);
+		f << (invert_y || invert_b ? ");\n" : ";\n");
 		return true;
 	}
 
@@ -1134,12 +1164,12 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
 		f << stringf(" = ");
-		dump_cell_expr_port(f, cell, "S", false);
+		dump_cell_expr_port(f, cell, ID::S, false);
 		f << stringf(" ? ");
 		dump_attributes(f, "", cell->attributes, " ");
-		dump_cell_expr_port(f, cell, "B", false);
+		dump_cell_expr_port(f, cell, ID::B, false);
 		f << stringf(" : ");
-		dump_cell_expr_port(f, cell, "A", false);
+		dump_cell_expr_port(f, cell, ID::A, false);
 		f << stringf(";\n");
 		return true;
 	}
@@ -1148,12 +1178,12 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
 		f << stringf(" = !(");
-		dump_cell_expr_port(f, cell, "S", false);
+		dump_cell_expr_port(f, cell, ID::S, false);
 		f << stringf(" ? ");
 		dump_attributes(f, "", cell->attributes, " ");
-		dump_cell_expr_port(f, cell, "B", false);
+		dump_cell_expr_port(f, cell, ID::B, false);
 		f << stringf(" : ");
-		dump_cell_expr_port(f, cell, "A", false);
+		dump_cell_expr_port(f, cell, ID::A, false);
 		f << stringf(");\n");
 		return true;
 	}
@@ -1162,13 +1192,13 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
 		f << stringf(" = ~((");
-		dump_cell_expr_port(f, cell, "A", false);
+		dump_cell_expr_port(f, cell, ID::A, false);
 		f << (cell->type == ID($_AOI3_) ? " & " : " | ");
-		dump_cell_expr_port(f, cell, "B", false);
+		dump_cell_expr_port(f, cell, ID::B, false);
 		f << (cell->type == ID($_AOI3_) ? ") |" : ") &");
 		dump_attributes(f, "", cell->attributes, " ");
 		f << stringf(" ");
-		dump_cell_expr_port(f, cell, "C", false);
+		dump_cell_expr_port(f, cell, ID::C, false);
 		f << stringf(");\n");
 		return true;
 	}
@@ -1177,15 +1207,15 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
 		f << stringf(" = ~((");
-		dump_cell_expr_port(f, cell, "A", false);
+		dump_cell_expr_port(f, cell, ID::A, false);
 		f << (cell->type == ID($_AOI4_) ? " & " : " | ");
-		dump_cell_expr_port(f, cell, "B", false);
+		dump_cell_expr_port(f, cell, ID::B, false);
 		f << (cell->type == ID($_AOI4_) ? ") |" : ") &");
 		dump_attributes(f, "", cell->attributes, " ");
 		f << stringf(" (");
-		dump_cell_expr_port(f, cell, "C", false);
+		dump_cell_expr_port(f, cell, ID::C, false);
 		f << (cell->type == ID($_AOI4_) ? " & " : " | ");
-		dump_cell_expr_port(f, cell, "D", false);
+		dump_cell_expr_port(f, cell, ID::D, false);
 		f << stringf("));\n");
 		return true;
 	}
@@ -1261,10 +1291,10 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			// intentionally one wider than maximum width
 			f << stringf("%s" "wire [%d:0] %s, %s, %s;\n", indent.c_str(), size_max, buf_a.c_str(), buf_b.c_str(), buf_num.c_str());
 			f << stringf("%s" "assign %s = ", indent.c_str(), buf_a.c_str());
-			dump_cell_expr_port(f, cell, "A", true);
+			dump_cell_expr_port(f, cell, ID::A, true);
 			f << stringf(";\n");
 			f << stringf("%s" "assign %s = ", indent.c_str(), buf_b.c_str());
-			dump_cell_expr_port(f, cell, "B", true);
+			dump_cell_expr_port(f, cell, ID::B, true);
 			f << stringf(";\n");
 
 			f << stringf("%s" "assign %s = ", indent.c_str(), buf_num.c_str());
@@ -1304,10 +1334,10 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 
 			std::string temp_id = next_auto_id();
 			f << stringf("%s" "wire [%d:0] %s = ", indent.c_str(), GetSize(cell->getPort(ID::A))-1, temp_id.c_str());
-			dump_cell_expr_port(f, cell, "A", true);
+			dump_cell_expr_port(f, cell, ID::A, true);
 			f << stringf(" %% ");
 			dump_attributes(f, "", cell->attributes, " ");
-			dump_cell_expr_port(f, cell, "B", true);
+			dump_cell_expr_port(f, cell, ID::B, true);
 			f << stringf(";\n");
 
 			f << stringf("%s" "assign ", indent.c_str());
@@ -1317,7 +1347,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			f << stringf(" == ");
 			dump_sigspec(f, sig_b.extract(sig_b.size()-1));
 			f << stringf(") || %s == 0 ? $signed(%s) : ", temp_id.c_str(), temp_id.c_str());
-			dump_cell_expr_port(f, cell, "B", true);
+			dump_cell_expr_port(f, cell, ID::B, true);
 			f << stringf(" + $signed(%s);\n", temp_id.c_str());
 			return true;
 		} else {
@@ -1334,19 +1364,19 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		f << stringf(" = ");
 		if (cell->getParam(ID::B_SIGNED).as_bool())
 		{
-			dump_cell_expr_port(f, cell, "B", true);
+			dump_cell_expr_port(f, cell, ID::B, true);
 			f << stringf(" < 0 ? ");
-			dump_cell_expr_port(f, cell, "A", true);
+			dump_cell_expr_port(f, cell, ID::A, true);
 			f << stringf(" << - ");
 			dump_sigspec(f, cell->getPort(ID::B));
 			f << stringf(" : ");
-			dump_cell_expr_port(f, cell, "A", true);
+			dump_cell_expr_port(f, cell, ID::A, true);
 			f << stringf(" >> ");
 			dump_sigspec(f, cell->getPort(ID::B));
 		}
 		else
 		{
-			dump_cell_expr_port(f, cell, "A", true);
+			dump_cell_expr_port(f, cell, ID::A, true);
 			f << stringf(" >> ");
 			dump_sigspec(f, cell->getPort(ID::B));
 		}
@@ -2517,6 +2547,8 @@ struct VerilogBackend : public Backend {
 
 		auto_name_map.clear();
 		reg_wires.clear();
+		escaped_id_cache.clear();
+		renamed_id_cache.clear();
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
@@ -2631,6 +2663,8 @@ struct VerilogBackend : public Backend {
 
 		auto_name_map.clear();
 		reg_wires.clear();
+		escaped_id_cache.clear();
+		renamed_id_cache.clear();
 	}
 } VerilogBackend;
 
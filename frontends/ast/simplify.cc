@@ -4443,6 +4443,43 @@ void AstNode::replace_result_wire_name_in_function(const std::string &from, cons
 		str = to;
 }
 
+// parse a single $readmem[bh] word directly into bits, for the common case where
+// this gives the same result as const2ast() without any warnings. returns false
+// if the token needs to go through const2ast().
+static bool readmem_parse_word(std::vector<RTLIL::State> &bits, const std::string &token, bool is_readmemh, int width)
+{
+	int bits_per_digit = is_readmemh ? 4 : 1;
+	int num_digits = 0;
+	for (char c : token) {
+		if (c == '_')
+			continue;
+		if (!(c == '0' || c == '1' || c == 'x' || c == 'X' || c == 'z' || c == 'Z' || c == '?' ||
+				(is_readmemh && (isdigit(c) || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F')))))
+			return false;
+		num_digits++;
+	}
+	if (num_digits == 0 || num_digits * bits_per_digit > width)
+		return false;
+
+	size_t base = bits.size();
+	for (auto it = token.rbegin(); it != token.rend(); it++) {
+		char c = *it;
+		if (c == '_')
+			continue;
+		RTLIL::State undef = RTLIL::State::S0;
+		if (c == 'x' || c == 'X')
+			undef = RTLIL::State::Sx;
+		else if (c == 'z' || c == 'Z' || c == '?')
+			undef = RTLIL::State::Sz;
+		int value = isdigit(c) ? c - '0' : 10 + tolower(c) - 'a';
+		for (int i = 0; i < bits_per_digit; i++)
+			bits.push_back(undef != RTLIL::State::S0 ? undef : ((value >> i) & 1) ? RTLIL::State::S1 : RTLIL::State::S0);
+	}
+	RTLIL::State msb = bits.back();
+	bits.resize(base + width, msb == RTLIL::State::S0 || msb == RTLIL::State::S1 ? RTLIL::State::S0 : msb);
+	return true;
+}
+
 // replace a readmem[bh] TCALL ast node with a block of memory assignments
 AstNode *AstNode::readmem(bool is_readmemh, std::string mem_filename, AstNode *memory, int start_addr, int finish_addr, bool unconditional_init)
 {
@@ -4525,8 +4562,6 @@ AstNode *AstNode::readmem(bool is_readmemh, std::string mem_filename, AstNode *m
 				continue;
 			}
 
-			AstNode *value = VERILOG_FRONTEND::const2ast(stringf("%d'%c", mem_width, is_readmemh ? 'h' : 'b') + token);
-
 			if (unconditional_init)
 			{
 				if (meminit == nullptr || cursor != next_meminit_cursor)
@@ -4552,11 +4587,16 @@ AstNode *AstNode::readmem(bool is_readmemh, std::string mem_filename, AstNode *m
 
 				meminit_size++;
 				next_meminit_cursor++;
-				meminit_bits.insert(meminit_bits.end(), value->bits.begin(), value->bits.end());
-				delete value;
+				// most words can be decoded in place; anything unusual goes through the regular constant parser
+				if (!readmem_parse_word(meminit_bits, token, is_readmemh, mem_width)) {
+					AstNode *value = VERILOG_FRONTEND::const2ast(stringf("%d'%c", mem_width, is_readmemh ? 'h' : 'b') + token);
+					meminit_bits.insert(meminit_bits.end(), value->bits.begin(), value->bits.end());
+					delete value;
+				}
 			}
 			else
 			{
+				AstNode *value = VERILOG_FRONTEND::const2ast(stringf("%d'%c", mem_width, is_readmemh ? 'h' : 'b') + token);
 				block->children.push_back(new AstNode(AST_ASSIGN_EQ, new AstNode(AST_IDENTIFIER, new AstNode(AST_RANGE, AstNode::mkconst_int(cursor, false))), value));
 				block->children.back()->children[0]->str = memory->str;
 				block->children.back()->children[0]->id2ast = memory;
@@ -288,6 +288,7 @@ int main(int argc, char **argv)
 		("hash-seed", "mix up hashing values with <seed>, for extreme optimization and testing",
 			cxxopts::value<uint64_t>(), "<seed>")
 		("A,abort", "will call abort() at the end of the script. for debugging")
+		("module-arena", "allocate the wires and cells of each module from per-module slabs")
 		("x,experimental", "do not print warnings for the experimental <feature>",
 			cxxopts::value<std::vector<std::string>>(), "<feature>")
 		("g,debug", "globally enable debug log messages")
@@ -317,6 +318,7 @@ int main(int argc, char **argv)
 
 		if (result.count("M")) memhasher_on();
 		if (result.count("X")) yosys_xtrace += result.count("X");
+		if (result.count("module-arena")) yosys_module_arena = true;
 		if (result.count("A")) call_abort = true;
 		if (result.count("Q")) print_banner = false;
 		if (result.count("T")) print_stats = false;
@@ -797,6 +797,402 @@ void IR::forward_buf() {
     _graph.permute(perm, alias);
 }
 
+// Optimizer rebuilds the graph node by node in topological order. Each node
+// is simplified using the already simplified versions of its arguments and
+// is only added if no identical node exists yet. The new nodes are appended
+// after the old ones, which are dropped at the end.
+class Optimizer {
+	struct NodeKey {
+		IR::NodeData data;
+		Sort sort;
+		std::vector<int> args;
+		bool operator==(NodeKey const &other) const { return data == other.data && sort == other.sort && args == other.args; }
+		[[nodiscard]] Hasher hash_into(Hasher h) const {
+			h.eat(data);
+			h.eat(sort);
+			h.eat(args);
+			return h;
+		}
+	};
+
+	IR &_ir;
+	OptimizeStats &_stats;
+	dict<NodeKey, int> _existing;
+
+	Node node(int index) { return Node(_ir._graph[index]); }
+	bool is_const(int index) { return node(index).fn() == Fn::constant; }
+	RTLIL::Const const &const_value(int index) { return _ir._graph[index].function().as_const(); }
+	bool is_zero(int index) { return is_const(index) && const_value(index).is_fully_zero(); }
+	bool is_ones(int index) { return is_const(index) && const_value(index).is_fully_ones(); }
+	bool is_one(int index) {
+		return is_const(index) && RTLIL::const_eq(const_value(index), RTLIL::Const(1, const_value(index).size()), false, false, 1).as_bool();
+	}
+	int slice_offset(int index) { return _ir._graph[index].function().as_int(); }
+
+	int add(IR::NodeData data, Sort sort, std::vector<int> args)
+	{
+		NodeKey key{data, sort, args};
+		auto it = _existing.find(key);
+		if (it != _existing.end()) {
+			_stats.merged++;
+			return it->second;
+		}
+		int index = _ir._graph.add(std::move(data), IR::Attr{std::move(sort)}, args).index();
+		_existing.emplace(std::move(key), index);
+		return index;
+	}
+
+	int constant(RTLIL::Const value)
+	{
+		int width = value.size();
+		return add(IR::NodeData(Fn::constant, std::move(value)), Sort(width), {});
+	}
+
+	int slice(int a, int offset, int width) { return simplify(IR::NodeData(Fn::slice, offset), Sort(width), {a}); }
+	int zero_extend(int a, int width) { return simplify(IR::NodeData(Fn::zero_extend), Sort(width), {a}); }
+	int concat(int a, int b) { return simplify(IR::NodeData(Fn::concat), Sort(node(a).width() + node(b).width()), {a, b}); }
+
+	// evaluates a node whose arguments are all fully defined constants,
+	// returns an empty optional where the backends disagree (division by zero)
+	std::optional<RTLIL::Const> fold(IR::NodeData const &data, int width, std::vector<int> const &args)
+	{
+		std::vector<RTLIL::Const> c;
+		for (int arg : args)
+			c.push_back(const_value(arg));
+		RTLIL::Const r;
+		switch (data.fn()) {
+		case Fn::slice: r = c[0].extract(data.as_int(), width); break;
+		case Fn::zero_extend: r = c[0]; r.extu(width); break;
+		case Fn::sign_extend: r = c[0]; r.exts(width); break;
+		case Fn::concat: r = c[0]; r.append(c[1]); break;
+		case Fn::add: r = RTLIL::const_add(c[0], c[1], false, false, width); break;
+		case Fn::sub: r = RTLIL::const_sub(c[0], c[1], false, false, width); break;
+		case Fn::mul: r = RTLIL::const_mul(c[0], c[1], false, false, width); break;
+		case Fn::unsigned_div:
+		case Fn::unsigned_mod:
+			if (c[1].is_fully_zero())
+				return {};
+			if (data.fn() == Fn::unsigned_div)
+				r = RTLIL::const_div(c[0], c[1], false, false, width);
+			else
+				r = RTLIL::const_mod(c[0], c[1], false, false, width);
+			break;
+		case Fn::bitwise_and: r = RTLIL::const_and(c[0], c[1], false, false, width); break;
+		case Fn::bitwise_or: r = RTLIL::const_or(c[0], c[1], false, false, width); break;
+		case Fn::bitwise_xor: r = RTLIL::const_xor(c[0], c[1], false, false, width); break;
+		case Fn::bitwise_not: r = RTLIL::const_not(c[0], RTLIL::Const(), false, false, width); break;
+		case Fn::unary_minus: r = RTLIL::const_neg(c[0], RTLIL::Const(), false, false, width); break;
+		case Fn::reduce_and: r = RTLIL::const_reduce_and(c[0], RTLIL::Const(), false, false, 1); break;
+		case Fn::reduce_or: r = RTLIL::const_reduce_or(c[0], RTLIL::Const(), false, false, 1); break;
+		case Fn::reduce_xor: r = RTLIL::const_reduce_xor(c[0], RTLIL::Const(), false, false, 1); break;
+		case Fn::equal: r = RTLIL::const_eq(c[0], c[1], false, false, 1); break;
+		case Fn::not_equal: r = RTLIL::const_ne(c[0], c[1], false, false, 1); break;
+		case Fn::signed_greater_than: r = RTLIL::const_gt(c[0], c[1], true, true, 1); break;
+		case Fn::signed_greater_equal: r = RTLIL::const_ge(c[0], c[1], true, true, 1); break;
+		case Fn::unsigned_greater_than: r = RTLIL::const_gt(c[0], c[1], false, false, 1); break;
+		case Fn::unsigned_greater_equal: r = RTLIL::const_ge(c[0], c[1], false, false, 1); break;
+		case Fn::logical_shift_left: r = RTLIL::const_shl(c[0], c[1], false, false, width); break;
+		case Fn::logical_shift_right: r = RTLIL::const_shr(c[0], c[1], false, false, width); break;
+		case Fn::arithmetic_shift_right: r = RTLIL::const_sshr(c[0], c[1], true, false, width); break;
+		default: return {};
+		}
+		if (r.size() != width || !r.is_fully_def())
+			return {};
+		return r;
+	}
+
+	bool narrowing_preserves_value(Fn fn)
+	{
+		switch (fn) {
+		case Fn::add: case Fn::sub: case Fn::mul:
+		case Fn::bitwise_and: case Fn::bitwise_or: case Fn::bitwise_xor: case Fn::bitwise_not:
+		case Fn::unary_minus:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// whether slice(a, 0, width) simplifies to an existing or constant node
+	bool slice_is_free(Node a, int width)
+	{
+		switch (a.fn()) {
+		case Fn::constant:
+		case Fn::slice:
+			return true;
+		case Fn::zero_extend:
+		case Fn::sign_extend:
+			return a.arg(0).width() >= width;
+		case Fn::concat:
+			return a.arg(0).width() >= width;
+		default:
+			return false;
+		}
+	}
+
+	bool foldable(Fn fn)
+	{
+		switch (fn) {
+		case Fn::invalid: case Fn::buf: case Fn::constant: case Fn::input: case Fn::state:
+		case Fn::mux: case Fn::memory_read: case Fn::memory_write:
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	int simplify(IR::NodeData data, Sort sort, std::vector<int> args)
+	{
+		Fn fn = data.fn();
+
+		if (fn == Fn::buf)
+			return args[0];
+
+		if (foldable(fn) && !args.empty()) {
+			bool all_const = true;
+			for (int arg : args)
+				all_const = all_const && is_const(arg) && const_value(arg).is_fully_def();
+			if (all_const)
+				if (auto value = fold(data, sort.is_signal() ? sort.width() : 0, args)) {
+					_stats.folded_constants++;
+					return constant(*value);
+				}
+		}
+
+		switch (fn) {
+		case Fn::add:
+		case Fn::mul:
+		case Fn::bitwise_and:
+		case Fn::bitwise_or:
+		case Fn::bitwise_xor:
+		case Fn::equal:
+		case Fn::not_equal:
+			// commutative, order the arguments so that a+b and b+a are merged
+			if (args[0] > args[1])
+				std::swap(args[0], args[1]);
+			break;
+		default:
+			break;
+		}
+
+		int width = sort.is_signal() ? sort.width() : 0;
+		auto simplified = [&](int index) { _stats.simplified++; return index; };
+		auto folded = [&](int index) { _stats.folded_slices++; return index; };
+		switch (fn) {
+		case Fn::slice: {
+			int offset = data.as_int();
+			Node a = node(args[0]);
+			if (offset == 0 && width == a.width())
+				return folded(args[0]);
+			if (a.fn() == Fn::slice)
+				return folded(slice(a.arg(0).id(), slice_offset(a.id()) + offset, width));
+			if (a.fn() == Fn::concat) {
+				int lo_width = a.arg(0).width();
+				if (offset + width <= lo_width)
+					return folded(slice(a.arg(0).id(), offset, width));
+				if (offset >= lo_width)
+					return folded(slice(a.arg(1).id(), offset - lo_width, width));
+			}
+			if (a.fn() == Fn::zero_extend || a.fn() == Fn::sign_extend) {
+				int in_width = a.arg(0).width();
+				if (offset + width <= in_width)
+					return folded(slice(a.arg(0).id(), offset, width));
+				if (a.fn() == Fn::zero_extend && offset >= in_width)
+					return folded(constant(RTLIL::Const(State::S0, width)));
+			}
+			// the low bits of these only depend on the low bits of the
+			// arguments, so compute them at the narrower width instead
+			// when slicing the arguments does not need new nodes
+			if (offset == 0 && narrowing_preserves_value(a.fn())) {
+				bool narrowable = true;
+				for (size_t i = 0; i < a.arg_count(); i++)
+					narrowable = narrowable && slice_is_free(a.arg(i), width);
+				if (narrowable) {
+					std::vector<int> narrow_args;
+					for (size_t i = 0; i < a.arg_count(); i++)
+						narrow_args.push_back(slice(a.arg(i).id(), 0, width));
+					return folded(simplify(IR::NodeData(a.fn()), sort, narrow_args));
+				}
+			}
+			break;
+		}
+		case Fn::zero_extend:
+		case Fn::sign_extend: {
+			Node a = node(args[0]);
+			if (a.fn() == fn || (fn == Fn::sign_extend && a.fn() == Fn::zero_extend))
+				return folded(simplify(IR::NodeData(a.fn()), sort, {a.arg(0).id()}));
+			break;
+		}
+		case Fn::concat: {
+			Node a = node(args[0]), b = node(args[1]);
+			// adjacent slices of the same node
+			auto adjacent = [&](Node lo, Node hi) {
+				return lo.fn() == Fn::slice && hi.fn() == Fn::slice && lo.arg(0).id() == hi.arg(0).id() &&
+					slice_offset(lo.id()) + lo.width() == slice_offset(hi.id());
+			};
+			if (adjacent(a, b))
+				return folded(slice(a.arg(0).id(), slice_offset(a.id()), width));
+			if (a.fn() == Fn::concat && adjacent(a.arg(1), b))
+				return folded(concat(a.arg(0).id(), concat(a.arg(1).id(), b.id())));
+			if (b.fn() == Fn::concat && adjacent(a, b.arg(0)))
+				return folded(concat(concat(a.id(), b.arg(0).id()), b.arg(1).id()));
+			// neighbouring constants
+			if (is_const(args[1]) && a.fn() == Fn::concat && is_const(a.arg(1).id()))
+				return folded(concat(a.arg(0).id(), concat(a.arg(1).id(), args[1])));
+			if (is_zero(args[1]))
+				return folded(zero_extend(args[0], width));
+			break;
+		}
+		case Fn::add:
+		case Fn::bitwise_or:
+		case Fn::bitwise_xor:
+			if (is_zero(args[0]))
+				return simplified(args[1]);
+			if (is_zero(args[1]))
+				return simplified(args[0]);
+			if (fn == Fn::bitwise_or && (is_ones(args[0]) || is_ones(args[1])))
+				return simplified(constant(RTLIL::Const(State::S1, width)));
+			if (fn == Fn::bitwise_or && args[0] == args[1])
+				return simplified(args[0]);
+			if (fn == Fn::bitwise_xor && args[0] == args[1])
+				return simplified(constant(RTLIL::Const(State::S0, width)));
+			break;
+		case Fn::sub:
+			if (is_zero(args[1]))
+				return simplified(args[0]);
+			if (args[0] == args[1])
+				return simplified(constant(RTLIL::Const(State::S0, width)));
+			break;
+		case Fn::mul:
+			if (is_zero(args[0]) || is_zero(args[1]))
+				return simplified(constant(RTLIL::Const(State::S0, width)));
+			if (is_one(args[0]))
+				return simplified(args[1]);
+			if (is_one(args[1]))
+				return simplified(args[0]);
+			break;
+		case Fn::bitwise_and:
+			if (is_zero(args[0]) || is_zero(args[1]))
+				return simplified(constant(RTLIL::Const(State::S0, width)));
+			if (is_ones(args[0]))
+				return simplified(args[1]);
+			if (is_ones(args[1]) || args[0] == args[1])
+				return simplified(args[0]);
+			break;
+		case Fn::bitwise_not:
+		case Fn::unary_minus:
+			if (node(args[0]).fn() == fn)
+				return simplified(node(args[0]).arg(0).id());
+			break;
+		case Fn::reduce_and:
+			if (node(args[0]).width() == 1)
+				return simplified(args[0]);
+			break;
+		case Fn::reduce_or:
+		case Fn::reduce_xor: {
+			Node a = node(args[0]);
+			if (a.width() == 1)
+				return simplified(args[0]);
+			// zero bits do not contribute
+			if (a.fn() == Fn::zero_extend)
+				return simplified(simplify(data, sort, {a.arg(0).id()}));
+			if (a.fn() == Fn::concat && is_zero(a.arg(0).id()))
+				return simplified(simplify(data, sort, {a.arg(1).id()}));
+			if (a.fn() == Fn::concat && is_zero(a.arg(1).id()))
+				return simplified(simplify(data, sort, {a.arg(0).id()}));
+			break;
+		}
+		case Fn::equal:
+		case Fn::signed_greater_equal:
+		case Fn::unsigned_greater_equal:
+			if (args[0] == args[1])
+				return simplified(constant(RTLIL::Const(State::S1, 1)));
+			break;
+		case Fn::not_equal:
+		case Fn::signed_greater_than:
+		case Fn::unsigned_greater_than:
+			if (args[0] == args[1])
+				return simplified(constant(RTLIL::Const(State::S0, 1)));
+			break;
+		case Fn::logical_shift_left:
+		case Fn::logical_shift_right:
+		case Fn::arithmetic_shift_right:
+			if (is_zero(args[1]))
+				return simplified(args[0]);
+			break;
+		case Fn::mux:
+			if (is_const(args[2]) && const_value(args[2]).is_fully_def())
+				return simplified(const_value(args[2]).as_bool() ? args[1] : args[0]);
+			if (args[0] == args[1])
+				return simplified(args[0]);
+			if (width == 1 && is_zero(args[0]) && is_ones(args[1]))
+				return simplified(args[2]);
+			break;
+		case Fn::memory_read: {
+			Node mem = node(args[0]);
+			if (mem.fn() == Fn::memory_write && mem.arg(1).id() == args[1])
+				return simplified(mem.arg(2).id());
+			break;
+		}
+		default:
+			break;
+		}
+
+		return add(std::move(data), std::move(sort), std::move(args));
+	}
+
+public:
+	Optimizer(IR &ir, OptimizeStats &stats) : _ir(ir), _stats(stats) {}
+
+	void run()
+	{
+		IR::Graph &graph = _ir._graph;
+		int old_size = graph.size();
+		std::vector<int> repl(old_size, -1);
+		for (int i = 0; i < old_size; i++) {
+			auto ref = graph[i];
+			std::vector<int> args;
+			for (int j = 0; j < ref.size(); j++) {
+				int arg = ref.arg(j).index();
+				log_assert(arg < i);
+				args.push_back(repl[arg]);
+			}
+			int new_index = simplify(ref.function(), ref.attr().sort, std::move(args));
+			repl[i] = new_index;
+			if (graph[i].has_sparse_attr()) {
+				auto target = graph[new_index];
+				IdString name = graph[i].sparse_attr();
+				if (target.has_sparse_attr())
+					name = merge_name(target.sparse_attr(), name);
+				target.sparse_attr() = name;
+			}
+		}
+
+		// keep only the new nodes and map the old ones (still referenced by
+		// the output and state keys) to their replacements
+		std::vector<int> perm, inv_perm(graph.size(), -1);
+		for (int i = old_size; i < graph.size(); i++) {
+			inv_perm[i] = GetSize(perm);
+			perm.push_back(i);
+		}
+		for (int i = 0; i < old_size; i++)
+			inv_perm[i] = inv_perm[repl[i]];
+		graph.permute(perm, inv_perm);
+	}
+};
+
+OptimizeStats IR::optimize() {
+	OptimizeStats stats;
+	stats.nodes_before = size();
+	Optimizer(*this, stats).run();
+	// drops the nodes that are no longer used
+	topological_sort();
+	stats.nodes_after = size();
+	log("Optimized functional IR from %d to %d nodes: %d merged, %d constants folded, %d slices folded, %d simplified.\n",
+		stats.nodes_before, stats.nodes_after, stats.merged, stats.folded_constants, stats.folded_slices, stats.simplified);
+	return stats;
+}
+
 // Quoting routine to make error messages nicer
 static std::string quote_fmt(const char *fmt)
 {
@@ -156,6 +156,20 @@ namespace Functional {
 	class IR;
 	class Factory;
 	class Node;
+	class Optimizer;
+	// counts reported by IR::optimize()
+	struct OptimizeStats {
+		int nodes_before = 0;
+		int nodes_after = 0;
+		// nodes that turned out to be identical to an existing node
+		int merged = 0;
+		// nodes with constant arguments replaced by their value
+		int folded_constants = 0;
+		// slice, concat and extend nodes rewritten to act on their source directly
+		int folded_slices = 0;
+		// nodes removed by algebraic identities such as a & 0 or a == a
+		int simplified = 0;
+	};
 	class IRInput {
 		friend class Factory;
 	public:
@@ -207,6 +221,7 @@ namespace Functional {
 		friend class IRInput;
 		friend class IROutput;
 		friend class IRState;
+		friend class Optimizer;
 		// one NodeData is stored per Node, containing the function and non-node arguments
 		// note that NodeData is deduplicated by ComputeGraph
 		class NodeData {
@@ -255,6 +270,10 @@ namespace Functional {
 		Node operator[](int i);
 		void topological_sort();
 		void forward_buf();
+		// merges duplicate nodes, folds constants, slices and concatenations,
+		// applies simple algebraic identities and removes unused nodes.
+		// requires the nodes to be in topological order, as from_module leaves them
+		OptimizeStats optimize();
 		IRInput const& input(IdString name, IdString kind) const { return _inputs.at({name, kind}); }
 		IRInput const& input(IdString name) const { return input(name, ID($input)); }
 		IROutput const& output(IdString name, IdString kind) const { return _outputs.at({name, kind}); }
@@ -300,6 +319,7 @@ namespace Functional {
 		friend class IRInput;
 		friend class IROutput;
 		friend class IRState;
+		friend class Optimizer;
 		IR::Graph::ConstRef _ref;
 		explicit Node(IR::Graph::ConstRef ref) : _ref(ref) { }
 		explicit operator IR::Graph::ConstRef() { return _ref; }
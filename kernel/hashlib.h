@@ -56,6 +56,10 @@ namespace hashlib {
 const int hashtable_size_trigger = 2;
 const int hashtable_size_factor = 3;
 
+// A dict with at most this many entries has no hashtable and is searched linearly,
+// which avoids a separate allocation for the many tiny dicts (e.g. cell ports).
+const int hashtable_linear_limit = 8;
+
 namespace legacy {
 	inline uint32_t djb2_add(uint32_t a, uint32_t b) {
 		return ((a << 5) + a) + b;
@@ -381,6 +385,8 @@ class dict {
 	}
 #endif
 
+	// Without a hashtable (an empty dict, or one of at most hashtable_linear_limit
+	// entries) the key is not hashed at all, do_lookup() compares every entry.
 	Hasher::hash_t do_hash(const K &key) const
 	{
 		Hasher::hash_t hash = 0;
@@ -392,6 +398,8 @@ class dict {
 	void do_rehash()
 	{
 		hashtable.clear();
+		if (int(entries.size()) <= hashtable_linear_limit)
+			return;
 		hashtable.resize(hashtable_size(entries.capacity() * hashtable_size_factor), -1);
 
 		for (int i = 0; i < int(entries.size()); i++) {
@@ -405,9 +413,17 @@ class dict {
 	int do_erase(int index, Hasher::hash_t hash)
 	{
 		do_assert(index < int(entries.size()));
-		if (hashtable.empty() || index < 0)
+		if (index < 0)
 			return 0;
 
+		if (hashtable.empty()) {
+			int back_idx = entries.size()-1;
+			if (index != back_idx)
+				entries[index] = std::move(entries[back_idx]);
+			entries.pop_back();
+			return 1;
+		}
+
 		int k = hashtable[hash];
 		do_assert(0 <= k && k < int(entries.size()));
 
@@ -453,14 +469,18 @@ class dict {
 
 	int do_lookup(const K &key, Hasher::hash_t &hash) const
 	{
-		if (hashtable.empty())
-			return -1;
-
-		if (entries.size() * hashtable_size_trigger > hashtable.size()) {
+		if (!hashtable.empty() && entries.size() * hashtable_size_trigger > hashtable.size()) {
 			((dict*)this)->do_rehash();
 			hash = do_hash(key);
 		}
 
+		if (hashtable.empty()) {
+			for (int index = 0; index < int(entries.size()); index++)
+				if (ops.cmp(entries[index].udata.first, key))
+					return index;
+			return -1;
+		}
+
 		int index = hashtable[hash];
 
 		while (index >= 0 && !ops.cmp(entries[index].udata.first, key)) {
@@ -475,8 +495,10 @@ class dict {
 	{
 		if (hashtable.empty()) {
 			entries.emplace_back(std::pair<K, T>(key, T()), -1);
-			do_rehash();
-			hash = do_hash(key);
+			if (int(entries.size()) > hashtable_linear_limit) {
+				do_rehash();
+				hash = do_hash(key);
+			}
 		} else {
 			entries.emplace_back(std::pair<K, T>(key, T()), hashtable[hash]);
 			hashtable[hash] = entries.size() - 1;
@@ -488,8 +510,10 @@ class dict {
 	{
 		if (hashtable.empty()) {
 			entries.emplace_back(value, -1);
-			do_rehash();
-			hash = do_hash(value.first);
+			if (int(entries.size()) > hashtable_linear_limit) {
+				do_rehash();
+				hash = do_hash(value.first);
+			}
 		} else {
 			entries.emplace_back(value, hashtable[hash]);
 			hashtable[hash] = entries.size() - 1;
@@ -500,10 +524,11 @@ class dict {
 	int do_insert(std::pair<K, T> &&rvalue, Hasher::hash_t &hash)
 	{
 		if (hashtable.empty()) {
-			auto key = rvalue.first;
 			entries.emplace_back(std::forward<std::pair<K, T>>(rvalue), -1);
-			do_rehash();
-			hash = do_hash(key);
+			if (int(entries.size()) > hashtable_linear_limit) {
+				do_rehash();
+				hash = do_hash(entries.back().udata.first);
+			}
 		} else {
 			entries.emplace_back(std::forward<std::pair<K, T>>(rvalue), hashtable[hash]);
 			hashtable[hash] = entries.size() - 1;
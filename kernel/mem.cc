@@ -451,6 +451,30 @@ Const Mem::get_init_data() const {
 	return init_data;
 }
 
+MemContents Mem::get_init_contents() const {
+	MemContents contents(std::max(1, ceil_log2(size)), width);
+	for (auto &init : inits) {
+		if (init.removed || init.en.is_fully_zero())
+			continue;
+		int addr = init.addr.as_int() - start_offset;
+		int words = GetSize(init.data) / width;
+		int first = std::max(0, -addr), last = std::min(words, size - addr);
+		if (first >= last)
+			continue;
+		Const clipped;
+		const Const *data = &init.data;
+		if (first != 0 || last != words) {
+			clipped = init.data.extract(first * width, (last - first) * width);
+			data = &clipped;
+		}
+		if (init.en.is_fully_ones())
+			contents.insert_concatenated(addr + first, *data);
+		else
+			contents.insert_masked(addr + first, *data, init.en);
+	}
+	return contents;
+}
+
 void Mem::check() {
 	int max_wide_log2 = 0;
 	for (auto &port : rd_ports) {
@@ -1688,25 +1712,98 @@ MemContents::MemContents(Mem *mem) :
 		log_assert(init.en.size() == _data_width);
 		if(init.en.is_fully_ones())
 			insert_concatenated(init.addr.as_int(), init.data);
-		else {
-			// TODO: this case could be handled more efficiently by adding
-			// a flag to reserve_range that tells it to preserve
-			// previous contents
-			addr_t addr = init.addr.as_int();
-			addr_t words = init.data.size() / _data_width;
-			RTLIL::Const data = init.data;
-			log_assert(data.size() % _data_width == 0);
-			for(addr_t i = 0; i < words; i++) {
-				RTLIL::Const previous = (*this)[addr + i];
-				for(int j = 0; j < _data_width; j++)
-					if(init.en[j] != State::S1)
-						data.bits()[_data_width * i + j] = previous[j];
-			}
-			insert_concatenated(init.addr.as_int(), data);
-		}
+		else
+			insert_masked(init.addr.as_int(), init.data, init.en);
 	}
 }
 
+void MemContents::packed_bits::_fill(std::vector<uint64_t> &plane, size_t begin, size_t end, bool b) {
+	uint64_t word = b ? ~uint64_t(0) : 0;
+	while (begin < end && begin % 64 != 0)
+		_set(plane, begin++, b);
+	for (; begin + 64 <= end; begin += 64)
+		plane[begin / 64] = word;
+	while (begin < end)
+		_set(plane, begin++, b);
+}
+
+void MemContents::packed_bits::set(size_t i, RTLIL::State state) {
+	_expanded.reset();
+	bool undef = state != State::S0 && state != State::S1;
+	bool marker = state == State::Sa || state == State::Sm;
+	_set(_value, i, state == State::S1 || state == State::Sz || state == State::Sm);
+	if (undef && _undef.empty())
+		_undef.resize(_value.size(), 0);
+	if (!_undef.empty())
+		_set(_undef, i, undef);
+	if (marker && _marker.empty())
+		_marker.resize(_value.size(), 0);
+	if (!_marker.empty())
+		_set(_marker, i, marker);
+}
+
+void MemContents::packed_bits::fill(size_t begin, size_t end, RTLIL::State state) {
+	_expanded.reset();
+	bool undef = state != State::S0 && state != State::S1;
+	bool marker = state == State::Sa || state == State::Sm;
+	_fill(_value, begin, end, state == State::S1 || state == State::Sz || state == State::Sm);
+	if (undef && _undef.empty())
+		_undef.resize(_value.size(), 0);
+	if (!_undef.empty())
+		_fill(_undef, begin, end, undef);
+	if (marker && _marker.empty())
+		_marker.resize(_value.size(), 0);
+	if (!_marker.empty())
+		_fill(_marker, begin, end, marker);
+}
+
+void MemContents::packed_bits::resize(size_t size, RTLIL::State fill_state) {
+	_expanded.reset();
+	size_t old_size = _size;
+	// clear any stale bits past the end of a shrunk segment, so that growing it again only needs to fill the new bits
+	if (size < old_size) {
+		_fill(_value, size, std::min(old_size, _words(size) * 64), false);
+		if (!_undef.empty())
+			_fill(_undef, size, std::min(old_size, _words(size) * 64), false);
+		if (!_marker.empty())
+			_fill(_marker, size, std::min(old_size, _words(size) * 64), false);
+	}
+	_size = size;
+	_value.resize(_words(size), 0);
+	if (!_undef.empty())
+		_undef.resize(_words(size), 0);
+	if (!_marker.empty())
+		_marker.resize(_words(size), 0);
+	if (size > old_size && fill_state != State::S0)
+		fill(old_size, size, fill_state);
+}
+
+void MemContents::packed_bits::copy(size_t to, packed_bits const &other, size_t from, size_t len) {
+	log_assert(to + len <= _size && from + len <= other._size);
+	if (&other == this && to > from) {
+		for (size_t i = len; i-- > 0;)
+			set(to + i, get(from + i));
+	} else {
+		for (size_t i = 0; i < len; i++)
+			set(to + i, other.get(from + i));
+	}
+}
+
+RTLIL::Const MemContents::packed_bits::extract(size_t offset, size_t len) const {
+	log_assert(offset + len <= _size);
+	std::vector<State> bits;
+	bits.reserve(len);
+	for (size_t i = 0; i < len; i++)
+		bits.push_back(get(offset + i));
+	return RTLIL::Const(bits);
+}
+
+RTLIL::Const const &MemContents::packed_bits::expanded() const {
+	if (!_expanded)
+		_expanded = std::make_shared<const RTLIL::Const>(extract(0, _size));
+	return *_expanded;
+}
+
 MemContents::iterator & MemContents::iterator::operator++() {
 	auto it = _memory->_values.upper_bound(_addr);
 	if(it == _memory->_values.end()) {
@@ -1736,19 +1833,19 @@ void MemContents::check() {
 	}
 }
 
-bool MemContents::_range_contains(std::map<addr_t, RTLIL::Const>::iterator it, addr_t addr) const {
+bool MemContents::_range_contains(std::map<addr_t, packed_bits>::iterator it, addr_t addr) const {
 	// if addr < begin, the subtraction will overflow, and the comparison will always fail
 	// (since we have an invariant that begin + size <= 2^(addr_t bits))
 	return it != _values.end() && addr - _range_begin(it) < _range_size(it);
 }
 
 
-bool MemContents::_range_contains(std::map<addr_t, RTLIL::Const>::iterator it, addr_t begin_addr, addr_t end_addr) const {
+bool MemContents::_range_contains(std::map<addr_t, packed_bits>::iterator it, addr_t begin_addr, addr_t end_addr) const {
 	// note that we assume begin_addr <= end_addr
 	return it != _values.end() && _range_begin(it) <= begin_addr && end_addr - _range_begin(it) <= _range_size(it);
 }
 
-bool MemContents::_range_overlaps(std::map<addr_t, RTLIL::Const>::iterator it, addr_t begin_addr, addr_t end_addr) const {
+bool MemContents::_range_overlaps(std::map<addr_t, packed_bits>::iterator it, addr_t begin_addr, addr_t end_addr) const {
 	if(it == _values.end() || begin_addr >= end_addr)
 		return false;
 	auto top1 = _range_end(it) - 1;
@@ -1756,14 +1853,14 @@ bool MemContents::_range_overlaps(std::map<addr_t, RTLIL::Const>::iterator it, a
 	return !(top1 < begin_addr || top2 < _range_begin(it));
 }
 
-std::map<MemContents::addr_t, RTLIL::Const>::iterator MemContents::_range_at(addr_t addr) const {
+std::map<MemContents::addr_t, MemContents::packed_bits>::iterator MemContents::_range_at(addr_t addr) const {
 	// allow addr == 1<<_addr_width (which will just return end())
 	log_assert(addr <= (addr_t)(1<<_addr_width));
 	// get the first range with base > addr
 	// (we use const_cast since map::iterators are only passed around internally and not exposed to the user
 	// and using map::iterator in both the const and non-const case simplifies the code a little,
 	// at the cost of having to be a little careful when implementing const methods)
-	auto it = const_cast<std::map<addr_t, RTLIL::Const> &>(_values).upper_bound(addr);
+	auto it = const_cast<std::map<addr_t, packed_bits> &>(_values).upper_bound(addr);
 	// if we get the very first range, all ranges are past the addr, so return the first one
 	if(it == _values.begin())
 		return it;
@@ -1812,14 +1909,14 @@ void MemContents::clear_range(addr_t begin_addr, addr_t end_addr) {
 		auto end = _range_end(last_it);
 		// if there is data past the end address, preserve it by creating a new range
 		if(new_begin != end)
-			end_it = _values.emplace_hint(last_it, new_begin, last_it->second.extract(_range_offset(last_it, new_begin), (_range_end(last_it) - new_begin) * _data_width));
+			end_it = _values.emplace_hint(last_it, new_begin, last_it->second.slice(_range_offset(last_it, new_begin), (size_t)(_range_end(last_it) - new_begin) * _data_width));
 		// the original range will either be truncated in the next if() block or deleted in the erase, so we can leave it untruncated
 	}
 	if(_range_contains(begin_it, begin_addr)) {
 		auto new_end = begin_addr;
 		// if there is data before the start address, truncate but don't delete
 		if(new_end != begin_it->first) {
-			begin_it->second.extu(_range_offset(begin_it, new_end));
+			begin_it->second.resize(_range_offset(begin_it, new_end), State::S0);
 			++begin_it;
 		}
 		// else: begin_it will be deleted
@@ -1827,7 +1924,7 @@ void MemContents::clear_range(addr_t begin_addr, addr_t end_addr) {
 	_values.erase(begin_it, end_it);
 }
 
-std::map<MemContents::addr_t, RTLIL::Const>::iterator MemContents::_reserve_range(addr_t begin_addr, addr_t end_addr) {
+std::map<MemContents::addr_t, MemContents::packed_bits>::iterator MemContents::_reserve_range(addr_t begin_addr, addr_t end_addr) {
 	if(begin_addr >= end_addr)
 		return _values.end(); // need a dummy value to return, end() is cheap
 	// find the first range containing any addr >= begin_addr - 1
@@ -1845,25 +1942,25 @@ std::map<MemContents::addr_t, RTLIL::Const>::iterator MemContents::_reserve_rang
 		log_assert (lower_it != upper_it); // lower_it == upper_it should be excluded by the check above
 		// we have two different ranges touching at either end, we need to merge them
 		auto upper_end = _range_end(upper_it);
-		// make range bigger (maybe reserve here instead of resize?)
-		lower_it->second.bits().resize(_range_offset(lower_it, upper_end), State::Sx);
+		// make range bigger
+		lower_it->second.resize(_range_offset(lower_it, upper_end), State::Sx);
 		// copy only the data beyond our range
-		std::copy(_range_data(upper_it, end_addr), _range_data(upper_it, upper_end), _range_data(lower_it, end_addr));
+		lower_it->second.copy(_range_offset(lower_it, end_addr), upper_it->second, _range_offset(upper_it, end_addr), (size_t)(upper_end - end_addr) * _data_width);
 		// keep lower_it, but delete upper_it
 		_values.erase(std::next(lower_it), std::next(upper_it));
 		return lower_it;
 	} else if (lower_touch) {
 		// we have a range to the left, just make it bigger and delete any other that may exist.
-		lower_it->second.bits().resize(_range_offset(lower_it, end_addr), State::Sx);
+		lower_it->second.resize(_range_offset(lower_it, end_addr), State::Sx);
 		// keep lower_it and upper_it
 		_values.erase(std::next(lower_it), upper_it);
 		return lower_it;
 	} else if (upper_touch) {
 		// we have a range to the right, we need to expand it
-		// since we need to erase and reinsert to a new address, steal the data
-		RTLIL::Const data = std::move(upper_it->second);
 		// note that begin_addr is not in upper_it, otherwise the whole range covered check would have tripped
-		data.bits().insert(data.bits().begin(), (_range_begin(upper_it) - begin_addr) * _data_width, State::Sx);
+		size_t prefix = (size_t)(_range_begin(upper_it) - begin_addr) * _data_width;
+		packed_bits data(prefix + upper_it->second.size(), State::Sx);
+		data.copy(prefix, upper_it->second, 0, upper_it->second.size());
 		// delete lower_it and upper_it, then reinsert
 		_values.erase(lower_it, std::next(upper_it));
 		return _values.emplace(begin_addr, std::move(data)).first;
@@ -1871,7 +1968,7 @@ std::map<MemContents::addr_t, RTLIL::Const>::iterator MemContents::_reserve_rang
 		// no ranges are touching, so just delete all ranges in our range and allocate a new one
 		// could try to resize an existing range but not sure if that actually helps
 		_values.erase(lower_it, upper_it);
-		return _values.emplace(begin_addr, RTLIL::Const(State::Sx, (end_addr - begin_addr) * _data_width)).first;
+		return _values.emplace(begin_addr, packed_bits((size_t)(end_addr - begin_addr) * _data_width, State::Sx)).first;
 	}
 }
 
@@ -1880,16 +1977,32 @@ void MemContents::insert_concatenated(addr_t addr, RTLIL::Const const &values) {
 	log_assert(addr < (addr_t)(1<<_addr_width));
 	log_assert(words <= (addr_t)(1<<_addr_width) - addr);
 	auto it = _reserve_range(addr, addr + words);
-	auto to_begin = _range_data(it, addr);
-	std::copy(values.begin(), values.end(), to_begin);
+	size_t offset = _range_offset(it, addr);
+	size_t i = 0;
+	for (auto bit : values)
+		it->second.set(offset + i++, bit);
 	// if values is not word-aligned, fill any missing bits with 0
-	std::fill(to_begin + values.size(), to_begin + words * _data_width, State::S0);
+	it->second.fill(offset + values.size(), offset + (size_t)words * _data_width, State::S0);
 }
 
-std::vector<State>::iterator MemContents::_range_write(std::vector<State>::iterator it, RTLIL::Const const &word) {
-	auto from_end = word.size() <= _data_width ? word.end() : word.begin() + _data_width;
-	auto to_end = std::copy(word.begin(), from_end, it);
-	auto it_next = std::next(it, _data_width);
-	std::fill(to_end, it_next, State::S0);
-	return it_next;
-}
\ No newline at end of file
+void MemContents::insert_masked(addr_t addr, RTLIL::Const const &values, RTLIL::Const const &en) {
+	log_assert(en.size() == _data_width);
+	log_assert(values.size() % _data_width == 0);
+	addr_t words = values.size() / _data_width;
+	for (addr_t i = 0; i < words; i++) {
+		RTLIL::Const previous = (*this)[addr + i];
+		auto it = _reserve_range(addr + i, addr + i + 1);
+		size_t offset = _range_offset(it, addr + i);
+		for (int j = 0; j < _data_width; j++)
+			it->second.set(offset + j, en[j] == State::S1 ? values[(size_t)i * _data_width + j] : previous[j]);
+	}
+}
+
+size_t MemContents::_range_write(packed_bits &bits, size_t offset, RTLIL::Const const &word) {
+	int width = std::min(word.size(), _data_width);
+	int i = 0;
+	for (auto it = word.begin(); i < width; ++it, ++i)
+		bits.set(offset + i, *it);
+	bits.fill(offset + width, offset + _data_width, State::S0);
+	return offset + _data_width;
+}
@@ -26,6 +26,8 @@
 
 YOSYS_NAMESPACE_BEGIN
 
+class MemContents;
+
 struct MemRd : RTLIL::AttrObject {
 	bool removed;
 	Cell *cell;
@@ -130,6 +132,11 @@ struct Mem : RTLIL::AttrObject {
 	// the whole memory.  For all non-initialized bits, Sx will be returned.
 	Const get_init_data() const;
 
+	// Same as get_init_data, but returns the data as a bit-packed MemContents
+	// indexed from start_offset, without expanding it to one State per bit.
+	// The inits themselves still hold one State per bit.
+	MemContents get_init_contents() const;
+
 	// Constructs and returns the helper structures for all memories
 	// in a module.
 	static std::vector<Mem> get_all_memories(Module *module);
@@ -228,8 +235,49 @@ struct Mem : RTLIL::AttrObject {
 // MemContents efficiently represents the contents of a potentially sparse memory by storing only those segments that are actually defined
 class MemContents {
 public:
-	class range; class iterator;
+	class range; class iterator; class packed_bits;
 	using addr_t = uint32_t;
+	// bit-packed storage for the contents of a segment: 0 and 1 take a single bit,
+	// the planes describing other states are only allocated once such a state is stored
+	class packed_bits {
+		size_t _size = 0;
+		// value of 0/1 bits; for other states, distinguishes x/- (0) from z/m (1)
+		std::vector<uint64_t> _value;
+		// set for states other than 0 and 1, empty if there are none
+		std::vector<uint64_t> _undef;
+		// set for - and m, empty if there are none
+		std::vector<uint64_t> _marker;
+		// all bits expanded to one State each, only built by expanded() and dropped on every change
+		mutable std::shared_ptr<const RTLIL::Const> _expanded;
+		static bool _get(std::vector<uint64_t> const &plane, size_t i) { return (plane[i / 64] >> (i % 64)) & 1; }
+		static void _set(std::vector<uint64_t> &plane, size_t i, bool b) { if (b) plane[i / 64] |= uint64_t(1) << (i % 64); else plane[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+		static void _fill(std::vector<uint64_t> &plane, size_t begin, size_t end, bool b);
+		static size_t _words(size_t size) { return (size + 63) / 64; }
+	public:
+		packed_bits() {}
+		packed_bits(size_t size, RTLIL::State fill) { resize(size, fill); }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		RTLIL::State get(size_t i) const {
+			bool v = _get(_value, i);
+			if (_undef.empty() || !_get(_undef, i))
+				return v ? RTLIL::State::S1 : RTLIL::State::S0;
+			if (!_marker.empty() && _get(_marker, i))
+				return v ? RTLIL::State::Sm : RTLIL::State::Sa;
+			return v ? RTLIL::State::Sz : RTLIL::State::Sx;
+		}
+		void set(size_t i, RTLIL::State state);
+		// set the bits in [begin, end) to state
+		void fill(size_t begin, size_t end, RTLIL::State state);
+		// change the size, filling any new bits with state
+		void resize(size_t size, RTLIL::State fill);
+		// copy len bits starting at offset from of other to offset to
+		void copy(size_t to, packed_bits const &other, size_t from, size_t len);
+		packed_bits slice(size_t offset, size_t len) const { packed_bits res(len, RTLIL::State::S0); res.copy(0, *this, offset, len); return res; }
+		RTLIL::Const extract(size_t offset, size_t len) const;
+		// all bits as a Const, which is kept until the next change
+		RTLIL::Const const &expanded() const;
+	};
 private:
 	// we ban _addr_width == sizeof(addr_t) * 8 because it adds too many cornercases
 	int _addr_width;
@@ -239,45 +287,49 @@ private:
 	// invariants:
 	// - no overlapping or adjacent ranges
 	// - no empty ranges
-	// - all Consts are a multiple of the word size
-	std::map<addr_t, RTLIL::Const> _values;
+	// - all segments are a multiple of the word size
+	std::map<addr_t, packed_bits> _values;
 	// returns an iterator to the range containing addr, if it exists, or the first range past addr
-	std::map<addr_t, RTLIL::Const>::iterator _range_at(addr_t addr) const;
-	addr_t _range_size(std::map<addr_t, RTLIL::Const>::iterator it) const { return it->second.size() / _data_width; }
-	addr_t _range_begin(std::map<addr_t, RTLIL::Const>::iterator it) const { return it->first; }
-	addr_t _range_end(std::map<addr_t, RTLIL::Const>::iterator it) const { return _range_begin(it) + _range_size(it); }
+	std::map<addr_t, packed_bits>::iterator _range_at(addr_t addr) const;
+	addr_t _range_size(std::map<addr_t, packed_bits>::iterator it) const { return it->second.size() / _data_width; }
+	addr_t _range_begin(std::map<addr_t, packed_bits>::iterator it) const { return it->first; }
+	addr_t _range_end(std::map<addr_t, packed_bits>::iterator it) const { return _range_begin(it) + _range_size(it); }
 	// check if the iterator points to a range containing addr
-	bool _range_contains(std::map<addr_t, RTLIL::Const>::iterator it, addr_t addr) const;
+	bool _range_contains(std::map<addr_t, packed_bits>::iterator it, addr_t addr) const;
 	// check if the iterator points to a range containing [begin_addr, end_addr). assumes end_addr >= begin_addr.
-	bool _range_contains(std::map<addr_t, RTLIL::Const>::iterator it, addr_t begin_addr, addr_t end_addr) const;
+	bool _range_contains(std::map<addr_t, packed_bits>::iterator it, addr_t begin_addr, addr_t end_addr) const;
 	// check if the iterator points to a range overlapping with [begin_addr, end_addr)
-	bool _range_overlaps(std::map<addr_t, RTLIL::Const>::iterator it, addr_t begin_addr, addr_t end_addr) const;
+	bool _range_overlaps(std::map<addr_t, packed_bits>::iterator it, addr_t begin_addr, addr_t end_addr) const;
 	// return the offset the addr would have in the range at `it`
-	size_t _range_offset(std::map<addr_t, RTLIL::Const>::iterator it, addr_t addr) const { return (addr - it->first) * _data_width; }
-	// assuming _range_contains(it, addr), return an iterator pointing to the data at addr
-	std::vector<State>::iterator _range_data(std::map<addr_t, RTLIL::Const>::iterator it, addr_t addr) { return it->second.bits().begin() + _range_offset(it, addr); }
+	size_t _range_offset(std::map<addr_t, packed_bits>::iterator it, addr_t addr) const { return (size_t)(addr - it->first) * _data_width; }
 	// internal version of reserve_range that returns an iterator to the range
-	std::map<addr_t, RTLIL::Const>::iterator _reserve_range(addr_t begin_addr, addr_t end_addr);
-	// write a single word at addr, return iterator to next word
-	std::vector<State>::iterator _range_write(std::vector<State>::iterator it, RTLIL::Const const &data);
+	std::map<addr_t, packed_bits>::iterator _reserve_range(addr_t begin_addr, addr_t end_addr);
+	// write a single word at the given bit offset of a range, return the offset of the next word
+	size_t _range_write(packed_bits &bits, size_t offset, RTLIL::Const const &data);
 public:
 	class range {
 		int _data_width;
 		addr_t _base;
-		RTLIL::Const const &_values;
+		packed_bits const &_values;
 		friend class iterator;
-		range(int data_width, addr_t base, RTLIL::Const const &values)
+		range(int data_width, addr_t base, packed_bits const &values)
 		: _data_width(data_width), _base(base), _values(values) {}
 	public:
 		addr_t base() const { return _base; }
 		addr_t size() const { return ((addr_t) _values.size()) / _data_width; }
 		addr_t limit() const { return _base + size(); }
-		RTLIL::Const const &concatenated() const { return _values; }
+		// note that this expands the whole range on first use, prefer accessing it word by word
+		RTLIL::Const const &concatenated() const { return _values.expanded(); }
 		RTLIL::Const operator[](addr_t addr) const {
 			log_assert(addr - _base < size());
-			return _values.extract((addr - _base) * _data_width, _data_width);
+			return _values.extract((size_t)(addr - _base) * _data_width, _data_width);
 		}
 		RTLIL::Const at_offset(addr_t offset) const { return (*this)[_base + offset]; }
+		// return a single bit of the word at addr
+		RTLIL::State bit(addr_t addr, int bit) const {
+			log_assert(addr - _base < size() && bit >= 0 && bit < _data_width);
+			return _values.get((size_t)(addr - _base) * _data_width + bit);
+		}
 	};
 	class iterator {
 		MemContents const *_memory;
@@ -315,14 +367,17 @@ public:
 	void reserve_range(addr_t begin_addr, addr_t end_addr) { _reserve_range(begin_addr, end_addr); }
 	// insert multiple words (provided as a single concatenated RTLIL::Const) at the given address, overriding any previous assignment.
 	void insert_concatenated(addr_t addr, RTLIL::Const const &values);
+	// like insert_concatenated, but only overwrite the bits of each word that are set to 1 in the enable mask.
+	// bits of words that were not previously defined are taken from the default value.
+	void insert_masked(addr_t addr, RTLIL::Const const &values, RTLIL::Const const &en);
 	// insert multiple words at the given address, overriding any previous assignment.
 	template<typename Iterator> void insert_range(addr_t addr, Iterator begin, Iterator end) {
 		auto words = end - begin;
 		log_assert(addr < (addr_t)(1<<_addr_width)); log_assert(words <= (addr_t)(1<<_addr_width) - addr);
 		auto range = _reserve_range(addr, addr + words);
-		auto it = _range_data(range, addr);
+		auto offset = _range_offset(range, addr);
 		for(; begin != end; ++begin)
-			it = _range_write(it, *begin);
+			offset = _range_write(range->second, offset, *begin);
 	}
 	// undefine all words in the range [begin_addr, end_addr)
 	void clear_range(addr_t begin_addr, addr_t end_addr);
@@ -577,6 +577,263 @@ struct ModWalker
 	}
 };
 
+// Read-only connectivity snapshot of a module. Unlike ModIndex this is not a
+// monitor: the snapshot is taken by build() and only changes on rebuild(), so
+// queries made after modifying the module see the old connectivity (the same
+// as with ModWalker). Every wire bit gets a dense id, and the drivers and
+// consumers of all bits are stored in flat arrays indexed by that id.
+struct ModConnIndex
+{
+	struct PortBit
+	{
+		RTLIL::Cell *cell;
+		RTLIL::IdString port;
+		int offset;
+		PortBit(Cell* c, IdString p, int o) : cell(c), port(p), offset(o) {}
+
+		bool operator==(const PortBit &other) const {
+			return cell == other.cell && port == other.port && offset == other.offset;
+		}
+
+		[[nodiscard]] Hasher hash_into(Hasher h) const {
+			h.eat(cell->name);
+			h.eat(port);
+			h.eat(offset);
+			return h;
+		}
+	};
+
+	template<typename T>
+	struct Range
+	{
+		const T *first, *last;
+		const T *begin() const { return first; }
+		const T *end() const { return last; }
+		int size() const { return last - first; }
+		bool empty() const { return first == last; }
+	};
+
+	RTLIL::Design *design;
+	RTLIL::Module *module;
+
+	CellTypes ct;
+	SigMap sigmap;
+
+private:
+	enum : uint8_t { FLAG_INPUT = 1, FLAG_OUTPUT = 2 };
+
+	dict<RTLIL::Wire*, int> wire_ids;
+	dict<RTLIL::Cell*, int> cell_ids;
+	std::vector<uint8_t> bit_flags;
+	std::vector<int> driver_start, consumer_start;
+	std::vector<PortBit> driver_ports, consumer_ports;
+	std::vector<int> cell_input_start, cell_output_start;
+	std::vector<RTLIL::SigBit> cell_input_bits, cell_output_bits;
+
+	// Turns a list of (key, value) pairs into start offsets and a value
+	// array sorted by key, keeping the original order within each key.
+	template<typename T>
+	static void make_csr(int keys, std::vector<std::pair<int, T>> &entries, std::vector<int> &start, std::vector<T> &values)
+	{
+		start.assign(keys + 1, 0);
+		for (auto &it : entries)
+			start[it.first + 1]++;
+		for (int i = 0; i < keys; i++)
+			start[i + 1] += start[i];
+		std::vector<int> pos(start.begin(), start.end() - 1);
+		std::vector<int> order(entries.size());
+		for (int i = 0; i < GetSize(entries); i++)
+			order[pos[entries[i].first]++] = i;
+		values.clear();
+		values.reserve(entries.size());
+		for (int i : order)
+			values.push_back(entries[i].second);
+		entries.clear();
+		entries.shrink_to_fit();
+	}
+
+public:
+	ModConnIndex(RTLIL::Design *design, RTLIL::Module *module = nullptr) : design(design), module(nullptr)
+	{
+		ct.setup(design);
+		if (module)
+			build(module);
+	}
+
+	ModConnIndex(RTLIL::Module *module) : ModConnIndex(module->design, module) { }
+
+	void build(RTLIL::Module *module)
+	{
+		this->module = module;
+		sigmap.set(module);
+
+		int num_bits = 0;
+		wire_ids.clear();
+		for (auto wire : module->wires()) {
+			wire_ids[wire] = num_bits;
+			num_bits += wire->width;
+		}
+
+		bit_flags.assign(num_bits, 0);
+		for (auto wire : module->wires())
+			if (wire->port_input || wire->port_output)
+				for (auto bit : sigmap(wire))
+					if (bit.wire)
+						bit_flags[bit_id(bit)] |= (wire->port_input ? FLAG_INPUT : 0) | (wire->port_output ? FLAG_OUTPUT : 0);
+
+		std::vector<std::pair<int, PortBit>> drivers, consumers;
+		std::vector<std::pair<int, RTLIL::SigBit>> inputs, outputs;
+		cell_ids.clear();
+		for (auto cell : module->cells())
+		{
+			int cell_id = GetSize(cell_ids);
+			cell_ids[cell] = cell_id;
+			size_t first_input = inputs.size(), first_output = outputs.size();
+			bool known = ct.cell_known(cell->type);
+			for (auto &conn : cell->connections())
+			{
+				bool is_output = !known || ct.cell_output(cell->type, conn.first);
+				bool is_input = !known || ct.cell_input(cell->type, conn.first);
+				for (int i = 0; i < GetSize(conn.second); i++) {
+					RTLIL::SigBit bit = sigmap(conn.second[i]);
+					if (bit.wire == nullptr)
+						continue;
+					int id = bit_id(bit);
+					if (is_output) {
+						drivers.emplace_back(id, PortBit(cell, conn.first, i));
+						outputs.emplace_back(cell_id, bit);
+					}
+					if (is_input) {
+						consumers.emplace_back(id, PortBit(cell, conn.first, i));
+						inputs.emplace_back(cell_id, bit);
+					}
+				}
+			}
+			// the per-cell bit lists are sets, like in ModWalker
+			std::sort(inputs.begin() + first_input, inputs.end());
+			inputs.erase(std::unique(inputs.begin() + first_input, inputs.end()), inputs.end());
+			std::sort(outputs.begin() + first_output, outputs.end());
+			outputs.erase(std::unique(outputs.begin() + first_output, outputs.end()), outputs.end());
+		}
+
+		make_csr(num_bits, drivers, driver_start, driver_ports);
+		make_csr(num_bits, consumers, consumer_start, consumer_ports);
+		make_csr(GetSize(cell_ids), inputs, cell_input_start, cell_input_bits);
+		make_csr(GetSize(cell_ids), outputs, cell_output_start, cell_output_bits);
+	}
+
+	void rebuild()
+	{
+		log_assert(module != nullptr);
+		build(module);
+	}
+
+	// Returns the dense id of the sigmapped bit, or -1 for constants and for
+	// bits of wires that were added to the module after the last build().
+	int bit_id(RTLIL::SigBit bit) const
+	{
+		bit = sigmap(bit);
+		if (bit.wire == nullptr)
+			return -1;
+		auto it = wire_ids.find(bit.wire);
+		if (it == wire_ids.end())
+			return -1;
+		return it->second + bit.offset;
+	}
+
+	int num_bits() const { return GetSize(bit_flags); }
+
+	Range<PortBit> drivers(RTLIL::SigBit bit) const
+	{
+		int id = bit_id(bit);
+		if (id < 0)
+			return {nullptr, nullptr};
+		return {driver_ports.data() + driver_start[id], driver_ports.data() + driver_start[id + 1]};
+	}
+
+	Range<PortBit> consumers(RTLIL::SigBit bit) const
+	{
+		int id = bit_id(bit);
+		if (id < 0)
+			return {nullptr, nullptr};
+		return {consumer_ports.data() + consumer_start[id], consumer_ports.data() + consumer_start[id + 1]};
+	}
+
+	bool is_input(RTLIL::SigBit bit) const
+	{
+		int id = bit_id(bit);
+		return id >= 0 && (bit_flags[id] & FLAG_INPUT) != 0;
+	}
+
+	bool is_output(RTLIL::SigBit bit) const
+	{
+		int id = bit_id(bit);
+		return id >= 0 && (bit_flags[id] & FLAG_OUTPUT) != 0;
+	}
+
+	// Sigmapped input and output bits of a cell, each bit listed once.
+	Range<RTLIL::SigBit> cell_inputs(RTLIL::Cell *cell) const
+	{
+		auto it = cell_ids.find(cell);
+		if (it == cell_ids.end())
+			return {nullptr, nullptr};
+		return {cell_input_bits.data() + cell_input_start[it->second], cell_input_bits.data() + cell_input_start[it->second + 1]};
+	}
+
+	Range<RTLIL::SigBit> cell_outputs(RTLIL::Cell *cell) const
+	{
+		auto it = cell_ids.find(cell);
+		if (it == cell_ids.end())
+			return {nullptr, nullptr};
+		return {cell_output_bits.data() + cell_output_start[it->second], cell_output_bits.data() + cell_output_start[it->second + 1]};
+	}
+
+	bool has_drivers(const RTLIL::SigSpec &sig) const
+	{
+		for (auto bit : sig)
+			if (!drivers(bit).empty())
+				return true;
+		return false;
+	}
+
+	bool has_consumers(const RTLIL::SigSpec &sig) const
+	{
+		for (auto bit : sig)
+			if (!consumers(bit).empty())
+				return true;
+		return false;
+	}
+
+	bool has_inputs(const RTLIL::SigSpec &sig) const
+	{
+		for (auto bit : sig)
+			if (is_input(bit))
+				return true;
+		return false;
+	}
+
+	bool has_outputs(const RTLIL::SigSpec &sig) const
+	{
+		for (auto bit : sig)
+			if (is_output(bit))
+				return true;
+		return false;
+	}
+
+	// Heap memory held by the snapshot, not counting the SigMap.
+	size_t memory_usage() const
+	{
+		size_t bytes = bit_flags.capacity() * sizeof(uint8_t);
+		bytes += (driver_start.capacity() + consumer_start.capacity()) * sizeof(int);
+		bytes += (driver_ports.capacity() + consumer_ports.capacity()) * sizeof(PortBit);
+		bytes += (cell_input_start.capacity() + cell_output_start.capacity()) * sizeof(int);
+		bytes += (cell_input_bits.capacity() + cell_output_bits.capacity()) * sizeof(RTLIL::SigBit);
+		// one entry plus about two hashtable slots per dict element
+		bytes += (wire_ids.size() + cell_ids.size()) * (sizeof(std::pair<void*, int>) + 3 * sizeof(int));
+		return bytes;
+	}
+};
+
 YOSYS_NAMESPACE_END
 
 #endif
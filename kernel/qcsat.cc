@@ -23,7 +23,7 @@ USING_YOSYS_NAMESPACE
 
 std::vector<int> QuickConeSat::importSig(SigSpec sig)
 {
-	sig = modwalker.sigmap(sig);
+	sig = sigmap(sig);
 	for (auto bit : sig)
 		bits_queue.insert(bit);
 	return satgen.importSigSpec(sig);
@@ -31,7 +31,7 @@ std::vector<int> QuickConeSat::importSig(SigSpec sig)
 
 int QuickConeSat::importSigBit(SigBit bit)
 {
-	bit = modwalker.sigmap(bit);
+	bit = sigmap(bit);
 	bits_queue.insert(bit);
 	return satgen.importSigBit(bit);
 }
@@ -40,8 +40,17 @@ void QuickConeSat::prepare()
 {
 	while (!bits_queue.empty())
 	{
-		pool<ModWalker::PortBit> portbits;
-		modwalker.get_drivers(portbits, bits_queue);
+		std::vector<RTLIL::Cell*> driver_cells;
+		if (modwalker) {
+			pool<ModWalker::PortBit> portbits;
+			modwalker->get_drivers(portbits, bits_queue);
+			for (auto &pbit : portbits)
+				driver_cells.push_back(pbit.cell);
+		} else {
+			for (auto bit : bits_queue)
+				for (auto &pbit : connindex->drivers(bit))
+					driver_cells.push_back(pbit.cell);
+		}
 
 		for (auto bit : bits_queue)
 			if (bit.wire && bit.wire->get_bool_attribute(ID::onehot) && !imported_onehot.count(bit.wire))
@@ -56,18 +65,25 @@ void QuickConeSat::prepare()
 
 		bits_queue.clear();
 
-		for (auto &pbit : portbits)
+		for (auto cell : driver_cells)
 		{
-			if (imported_cells.count(pbit.cell))
-				continue;
-			if (cell_complexity(pbit.cell) > max_cell_complexity)
+			if (imported_cells.count(cell))
 				continue;
-			if (max_cell_outs && GetSize(modwalker.cell_outputs[pbit.cell]) > max_cell_outs)
+			if (cell_complexity(cell) > max_cell_complexity)
 				continue;
-			auto &inputs = modwalker.cell_inputs[pbit.cell];
-			bits_queue.insert(inputs.begin(), inputs.end());
-			satgen.importCell(pbit.cell);
-			imported_cells.insert(pbit.cell);
+			if (modwalker) {
+				if (max_cell_outs && GetSize(modwalker->cell_outputs[cell]) > max_cell_outs)
+					continue;
+				auto &inputs = modwalker->cell_inputs[cell];
+				bits_queue.insert(inputs.begin(), inputs.end());
+			} else {
+				if (max_cell_outs && connindex->cell_outputs(cell).size() > max_cell_outs)
+					continue;
+				for (auto bit : connindex->cell_inputs(cell))
+					bits_queue.insert(bit);
+			}
+			satgen.importCell(cell);
+			imported_cells.insert(cell);
 		}
 
 		if (max_cell_count && GetSize(imported_cells) > max_cell_count)
@@ -34,7 +34,10 @@ YOSYS_NAMESPACE_BEGIN
 // cannot exist in reality due to skipped constraints (ie. only UNSAT results
 // from this class should be considered binding).
 struct QuickConeSat {
-	ModWalker &modwalker;
+	// Exactly one of these is set, depending on the constructor used.
+	ModWalker *modwalker = nullptr;
+	ModConnIndex *connindex = nullptr;
+	SigMap &sigmap;
 	ezSatPtr ez;
 	SatGen satgen;
 
@@ -56,7 +59,8 @@ struct QuickConeSat {
 	pool<RTLIL::Wire*> imported_onehot;
 	pool<RTLIL::SigBit> bits_queue;
 
-	QuickConeSat(ModWalker &modwalker) : modwalker(modwalker), ez(), satgen(ez.get(), &modwalker.sigmap) {}
+	QuickConeSat(ModWalker &modwalker) : modwalker(&modwalker), sigmap(modwalker.sigmap), ez(), satgen(ez.get(), &modwalker.sigmap) {}
+	QuickConeSat(ModConnIndex &connindex) : connindex(&connindex), sigmap(connindex.sigmap), ez(), satgen(ez.get(), &connindex.sigmap) {}
 
 	// Imports a signal into the SAT solver, queues its input cone to be
 	// imported in the next prepare() call.
@@ -1282,6 +1282,106 @@ std::vector<RTLIL::Module*> RTLIL::Design::selected_modules(RTLIL::SelectPartial
 	return result;
 }
 
+// Fixed size slabs of uninitialized storage for objects of type T, with a free list
+// threaded through the unused slots. Objects are constructed and destroyed in place
+// by RTLIL::Module and are never moved.
+template<typename T>
+struct ObjectSlabs
+{
+	static constexpr int slab_size = 1024;
+
+	struct Slot {
+		// must be the first member, see deallocate()
+		alignas(T) unsigned char storage[sizeof(T)];
+		Slot *next_free;
+		int slab;
+		bool live;
+	};
+
+	struct Slab {
+		std::unique_ptr<Slot[]> slots;
+		int live = 0;
+	};
+
+	std::vector<Slab> slabs;
+	Slot *free_list = nullptr;
+	size_t live_objects = 0;
+
+	void *allocate()
+	{
+		if (free_list == nullptr)
+			add_slab();
+		Slot *slot = free_list;
+		free_list = slot->next_free;
+		slot->live = true;
+		slabs[slot->slab].live++;
+		live_objects++;
+		return slot->storage;
+	}
+
+	void deallocate(void *ptr)
+	{
+		Slot *slot = reinterpret_cast<Slot*>(ptr);
+		log_assert(slot->live);
+		slot->live = false;
+		slot->next_free = free_list;
+		free_list = slot;
+		slabs[slot->slab].live--;
+		live_objects--;
+	}
+
+	void add_slab()
+	{
+		Slab slab;
+		slab.slots.reset(new Slot[slab_size]);
+		for (int i = slab_size-1; i >= 0; i--) {
+			Slot &slot = slab.slots[i];
+			slot.slab = GetSize(slabs);
+			slot.live = false;
+			slot.next_free = free_list;
+			free_list = &slot;
+		}
+		slabs.push_back(std::move(slab));
+	}
+
+	// Releases empty slabs and rebuilds the free list in address order, so that new
+	// objects fill the remaining holes front to back.
+	int compact()
+	{
+		int freed = 0;
+		std::vector<Slab> kept;
+		for (auto &slab : slabs)
+			if (slab.live == 0)
+				freed++;
+			else
+				kept.push_back(std::move(slab));
+		slabs.swap(kept);
+
+		free_list = nullptr;
+		for (int i = GetSize(slabs)-1; i >= 0; i--)
+			for (int j = slab_size-1; j >= 0; j--) {
+				Slot &slot = slabs[i].slots[j];
+				slot.slab = i;
+				if (!slot.live) {
+					slot.next_free = free_list;
+					free_list = &slot;
+				}
+			}
+		return freed;
+	}
+
+	size_t allocated_objects() const
+	{
+		return slabs.size() * slab_size;
+	}
+};
+
+struct RTLIL::Module::Arena
+{
+	ObjectSlabs<RTLIL::Wire> wires;
+	ObjectSlabs<RTLIL::Cell> cells;
+};
+
 RTLIL::Module::Module()
 {
 	static unsigned int hashidx_count = 123456789;
@@ -1291,6 +1391,7 @@ RTLIL::Module::Module()
 	design = nullptr;
 	refcount_wires_ = 0;
 	refcount_cells_ = 0;
+	arena_ = yosys_module_arena ? new Arena : nullptr;
 
 #ifdef WITH_PYTHON
 	RTLIL::Module::get_all_modules()->insert(std::pair<unsigned int, RTLIL::Module*>(hashidx_, this));
@@ -1300,15 +1401,16 @@ RTLIL::Module::Module()
 RTLIL::Module::~Module()
 {
 	for (auto &pr : wires_)
-		delete pr.second;
+		free_wire(pr.second);
 	for (auto &pr : memories)
 		delete pr.second;
 	for (auto &pr : cells_)
-		delete pr.second;
+		free_cell(pr.second);
 	for (auto &pr : processes)
 		delete pr.second;
 	for (auto binding : bindings_)
 		delete binding;
+	delete arena_;
 #ifdef WITH_PYTHON
 	RTLIL::Module::get_all_modules()->erase(hashidx_);
 #endif
@@ -1335,7 +1437,7 @@ void RTLIL::Module::makeblackbox()
 	memories.clear();
 
 	for (auto it = cells_.begin(); it != cells_.end(); ++it)
-		delete it->second;
+		free_cell(it->second);
 	cells_.clear();
 
 	for (auto it = processes.begin(); it != processes.end(); ++it)
@@ -2681,7 +2783,7 @@ void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 	for (auto &it : wires) {
 		log_assert(wires_.count(it->name) != 0);
 		wires_.erase(it->name);
-		delete it;
+		free_wire(it);
 	}
 }
 
@@ -2693,7 +2795,7 @@ void RTLIL::Module::remove(RTLIL::Cell *cell)
 	log_assert(cells_.count(cell->name) != 0);
 	log_assert(refcount_cells_ == 0);
 	cells_.erase(cell->name);
-	delete cell;
+	free_cell(cell);
 }
 
 void RTLIL::Module::remove(RTLIL::Process *process)
@@ -2875,9 +2977,60 @@ void RTLIL::Module::fixup_ports()
 	}
 }
 
+RTLIL::Wire *RTLIL::Module::new_wire()
+{
+	if (arena_ == nullptr)
+		return new RTLIL::Wire;
+	return new (arena_->wires.allocate()) RTLIL::Wire;
+}
+
+RTLIL::Cell *RTLIL::Module::new_cell()
+{
+	if (arena_ == nullptr)
+		return new RTLIL::Cell;
+	return new (arena_->cells.allocate()) RTLIL::Cell;
+}
+
+void RTLIL::Module::free_wire(RTLIL::Wire *wire)
+{
+	if (arena_ == nullptr) {
+		delete wire;
+		return;
+	}
+	wire->~Wire();
+	arena_->wires.deallocate(wire);
+}
+
+void RTLIL::Module::free_cell(RTLIL::Cell *cell)
+{
+	if (arena_ == nullptr) {
+		delete cell;
+		return;
+	}
+	cell->~Cell();
+	arena_->cells.deallocate(cell);
+}
+
+int RTLIL::Module::compact_arena()
+{
+	if (arena_ == nullptr)
+		return 0;
+	return arena_->wires.compact() + arena_->cells.compact();
+}
+
+void RTLIL::Module::arena_stats(size_t &live_objects, size_t &allocated_objects) const
+{
+	live_objects = 0;
+	allocated_objects = 0;
+	if (arena_ == nullptr)
+		return;
+	live_objects = arena_->wires.live_objects + arena_->cells.live_objects;
+	allocated_objects = arena_->wires.allocated_objects() + arena_->cells.allocated_objects();
+}
+
 RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, int width)
 {
-	RTLIL::Wire *wire = new RTLIL::Wire;
+	RTLIL::Wire *wire = new_wire();
 	wire->name = name;
 	wire->width = width;
 	add(wire);
@@ -2900,7 +3053,7 @@ RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, const RTLIL::Wire *oth
 
 RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, RTLIL::IdString type)
 {
-	RTLIL::Cell *cell = new RTLIL::Cell;
+	RTLIL::Cell *cell = new_cell();
 	cell->name = name;
 	cell->type = type;
 	add(cell);
@@ -1496,6 +1496,16 @@ protected:
 	void add(RTLIL::Cell *cell);
 	void add(RTLIL::Process *process);
 
+	// Slab storage for the wires and cells of this module, only present when the module
+	// was created while yosys_module_arena was set.
+	struct Arena;
+	Arena *arena_;
+
+	RTLIL::Wire *new_wire();
+	RTLIL::Cell *new_cell();
+	void free_wire(RTLIL::Wire *wire);
+	void free_cell(RTLIL::Cell *cell);
+
 public:
 	RTLIL::Design *design;
 	pool<RTLIL::Monitor*> monitors;
@@ -1601,6 +1611,12 @@ public:
 	void swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2);
 	void swap_names(RTLIL::Cell *c1, RTLIL::Cell *c2);
 
+	// Returns slabs of the module's arena that no longer hold any live wires or cells to
+	// the system and returns their number. Objects are never moved.
+	int compact_arena();
+	bool has_arena() const { return arena_ != nullptr; }
+	void arena_stats(size_t &live_objects, size_t &allocated_objects) const;
+
 	RTLIL::IdString uniquify(RTLIL::IdString name);
 	RTLIL::IdString uniquify(RTLIL::IdString name, int &index);
 
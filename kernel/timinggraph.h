@@ -0,0 +1,660 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TIMINGGRAPH_H
+#define TIMINGGRAPH_H
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+#include "kernel/timinginfo.h"
+
+#include <queue>
+
+YOSYS_NAMESPACE_BEGIN
+
+// Timing graph of a single module, built from the specify arcs (see TimingInfo)
+// of the black- and white-box cells instantiated in it.
+//
+// Primary inputs arrive at time zero. Arrival times are kept separately for
+// each launching clock: paths starting at a primary input belong to the
+// SigBit() domain, and every clock-to-output arc starts a new domain named
+// after the (sigmapped) clock bit it is launched from.
+//
+// The graph registers itself as a monitor of the module. Changing the
+// connections of a cell only updates the arrival times in the fanout cone and
+// the downstream times in the fanin cone of that cell on the next query.
+// Module-level connections change the SigMap and cause a full rebuild. Call
+// invalidate() for edits the monitor does not see (e.g. cell parameters).
+struct TimingGraph : public RTLIL::Monitor
+{
+	struct Arc {
+		RTLIL::SigBit from, to;
+		RTLIL::Cell *cell = nullptr;
+		RTLIL::IdString from_port, to_port;
+		int delay = 0;
+		// clock-to-output arc, `from` is the clock pin
+		bool launch = false;
+	};
+
+	struct Endpoint {
+		// capturing cell and port, or nullptr for primary outputs
+		RTLIL::Cell *sink = nullptr;
+		RTLIL::IdString port;
+		// capturing clock, or SigBit() for primary outputs
+		RTLIL::SigBit clock;
+		int required = 0;
+	};
+
+	struct Arrival {
+		int time;
+		// arc setting `time`, or -1 for primary inputs
+		int arc;
+		bool operator==(const Arrival &other) const { return time == other.time && arc == other.arc; }
+	};
+
+	struct Node {
+		std::vector<int> fanin, fanout;
+		std::vector<Endpoint> endpoints;
+		dict<RTLIL::SigBit, Arrival> arrival;
+		// longest delay from this node to any endpoint (including the
+		// required time of the endpoint), or -1 if no endpoint is reachable
+		int downstream = -1;
+		// strictly increasing along arcs, used to order updates
+		int level = 0;
+		int drivers = 0;
+		bool primary_input = false;
+
+		int max_arrival(RTLIL::SigBit *domain = nullptr) const
+		{
+			int time = -1;
+			for (auto &it : arrival)
+				if (it.second.time > time) {
+					time = it.second.time;
+					if (domain)
+						*domain = it.first;
+				}
+			return time;
+		}
+
+		const Endpoint *worst_endpoint() const
+		{
+			const Endpoint *worst = nullptr;
+			for (auto &ep : endpoints)
+				if (!worst || worst->required < ep.required)
+					worst = &ep;
+			return worst;
+		}
+	};
+
+	struct PathStep {
+		RTLIL::SigBit bit;
+		int arrival;
+		// arc into `bit`, or -1 at the primary input starting the path
+		int arc;
+	};
+
+	struct Path {
+		RTLIL::SigBit launch_clock;
+		bool has_endpoint = false;
+		Endpoint endpoint;
+		// arrival time at the end of the path plus the required time of its endpoint
+		int arrival = 0;
+		std::vector<PathStep> steps;
+	};
+
+	RTLIL::Module *module;
+	SigMap sigmap;
+	TimingInfo timing;
+
+	dict<RTLIL::SigBit, Node> nodes;
+	std::vector<Arc> arcs;
+
+private:
+	struct CellData {
+		std::vector<int> arcs;
+		std::vector<RTLIL::SigBit> outputs, endpoints;
+	};
+
+	dict<RTLIL::Cell*, CellData> cell_data;
+	pool<RTLIL::Cell*> dirty_cells;
+	std::vector<int> free_arcs;
+	pool<RTLIL::SigBit> arrival_seeds, downstream_seeds;
+	pool<RTLIL::IdString> warned_types;
+	bool reload_pending;
+	bool reloading;
+
+	void add_arc(const Arc &arc)
+	{
+		int idx;
+		if (free_arcs.empty()) {
+			idx = GetSize(arcs);
+			arcs.push_back(arc);
+		} else {
+			idx = free_arcs.back();
+			free_arcs.pop_back();
+			arcs[idx] = arc;
+		}
+
+		nodes[arc.from].fanout.push_back(idx);
+		nodes[arc.to].fanin.push_back(idx);
+		cell_data.at(arc.cell).arcs.push_back(idx);
+		arrival_seeds.insert(arc.to);
+		downstream_seeds.insert(arc.from);
+
+		if (!reloading)
+			raise_levels(arc.from, arc.to);
+	}
+
+	void remove_arc(int idx)
+	{
+		Arc &arc = arcs[idx];
+		auto &fanout = nodes.at(arc.from).fanout;
+		fanout.erase(std::find(fanout.begin(), fanout.end(), idx));
+		auto &fanin = nodes.at(arc.to).fanin;
+		fanin.erase(std::find(fanin.begin(), fanin.end(), idx));
+		arrival_seeds.insert(arc.to);
+		downstream_seeds.insert(arc.from);
+		arc = Arc();
+		free_arcs.push_back(idx);
+	}
+
+	void add_cell(RTLIL::Cell *cell)
+	{
+		RTLIL::Design *design = module->design;
+		RTLIL::Module *inst_module = design ? design->module(cell->type) : nullptr;
+		if (!inst_module) {
+			if (warned_types.insert(cell->type).second)
+				log_warning("Cell type '%s' not recognised! Ignoring.\n", log_id(cell->type));
+			return;
+		}
+
+		if (!inst_module->get_blackbox_attribute()) {
+			if (warned_types.insert(cell->type).second)
+				log_warning("Cell type '%s' is not a black- nor white-box! Ignoring.\n", log_id(cell->type));
+			return;
+		}
+
+		RTLIL::IdString derived_type = inst_module->derive(design, cell->parameters);
+		inst_module = design->module(derived_type);
+		log_assert(inst_module);
+
+		if (!timing.count(derived_type)) {
+			auto &t = timing.setup_module(inst_module);
+			if (t.has_inputs && t.comb.empty() && t.arrival.empty() && t.required.empty())
+				log_warning("Module '%s' has no timing arcs!\n", log_id(cell->type));
+		}
+
+		auto &t = timing.at(derived_type);
+		if (t.comb.empty() && t.arrival.empty() && t.required.empty())
+			return;
+
+		auto &cd = cell_data[cell];
+		pool<std::pair<RTLIL::SigBit, TimingInfo::NameBit>> src_bits, dst_bits;
+
+		for (auto &conn : cell->connections()) {
+			auto rhs = sigmap(conn.second);
+			for (int i = 0; i < GetSize(rhs); i++) {
+				const auto &bit = rhs[i];
+				if (!bit.wire)
+					continue;
+				TimingInfo::NameBit namebit(conn.first, i);
+				if (cell->input(conn.first)) {
+					src_bits.insert(std::make_pair(bit, namebit));
+
+					auto it = t.required.find(namebit);
+					if (it != t.required.end()) {
+						Endpoint ep;
+						ep.sink = cell;
+						ep.port = conn.first;
+						ep.required = it->second.first;
+						TimingInfo::NameBit clock = it->second.second;
+						if (auto clock_bit = clock.get_connection(cell))
+							ep.clock = sigmap(*clock_bit);
+						nodes[bit].endpoints.push_back(ep);
+						cd.endpoints.push_back(bit);
+						downstream_seeds.insert(bit);
+					}
+				}
+				if (cell->output(conn.first)) {
+					dst_bits.insert(std::make_pair(bit, namebit));
+					nodes[bit].drivers++;
+					cd.outputs.push_back(bit);
+
+					auto it = t.arrival.find(namebit);
+					if (it == t.arrival.end())
+						continue;
+					TimingInfo::NameBit clock = it->second.second;
+					auto clock_bit = clock.get_connection(cell);
+					if (!clock_bit)
+						continue;
+					Arc arc;
+					arc.from = sigmap(*clock_bit);
+					arc.to = bit;
+					arc.cell = cell;
+					arc.from_port = clock.name;
+					arc.to_port = conn.first;
+					arc.delay = it->second.first;
+					arc.launch = true;
+					if (arc.from.wire)
+						add_arc(arc);
+				}
+			}
+		}
+
+		for (const auto &s : src_bits)
+			for (const auto &d : dst_bits) {
+				auto it = t.comb.find(TimingInfo::BitBit(s.second, d.second));
+				if (it == t.comb.end())
+					continue;
+				Arc arc;
+				arc.from = s.first;
+				arc.to = d.first;
+				arc.cell = cell;
+				arc.from_port = s.second.name;
+				arc.to_port = d.second.name;
+				arc.delay = it->second;
+				add_arc(arc);
+			}
+	}
+
+	void drop_cell(RTLIL::Cell *cell)
+	{
+		auto it = cell_data.find(cell);
+		if (it == cell_data.end())
+			return;
+
+		for (int idx : it->second.arcs)
+			remove_arc(idx);
+		for (auto &bit : it->second.outputs)
+			nodes.at(bit).drivers--;
+		for (auto &bit : it->second.endpoints) {
+			auto &endpoints = nodes.at(bit).endpoints;
+			endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+					[cell](const Endpoint &ep) { return ep.sink == cell; }), endpoints.end());
+			downstream_seeds.insert(bit);
+		}
+
+		cell_data.erase(it);
+	}
+
+	void raise_levels(RTLIL::SigBit from, RTLIL::SigBit to)
+	{
+		if (nodes.at(to).level > nodes.at(from).level)
+			return;
+
+		nodes.at(to).level = nodes.at(from).level + 1;
+		std::vector<RTLIL::SigBit> stack = {to};
+		while (!stack.empty()) {
+			RTLIL::SigBit bit = stack.back();
+			stack.pop_back();
+			if (bit == from)
+				log_error("Module '%s' contains a combinational loop through %s.\n", log_id(module), log_signal(bit));
+			const Node &n = nodes.at(bit);
+			for (int idx : n.fanout) {
+				Node &m = nodes.at(arcs[idx].to);
+				if (m.level <= n.level) {
+					m.level = n.level + 1;
+					stack.push_back(arcs[idx].to);
+				}
+			}
+		}
+	}
+
+	bool update_arrival(RTLIL::SigBit bit)
+	{
+		Node &n = nodes.at(bit);
+		dict<RTLIL::SigBit, Arrival> arrival;
+
+		auto merge = [&](RTLIL::SigBit domain, int time, int arc) {
+			auto r = arrival.insert(domain);
+			if (r.second || r.first->second.time < time)
+				r.first->second = Arrival{time, arc};
+		};
+
+		if (n.primary_input)
+			merge(RTLIL::SigBit(), 0, -1);
+
+		for (int idx : n.fanin) {
+			const Arc &arc = arcs[idx];
+			const Node &src = nodes.at(arc.from);
+			if (arc.launch) {
+				// the clock itself must be reachable from a primary input
+				int clock_arrival = src.max_arrival();
+				if (clock_arrival >= 0)
+					merge(arc.from, clock_arrival + arc.delay, idx);
+			} else {
+				for (auto &it : src.arrival)
+					merge(it.first, it.second.time + arc.delay, idx);
+			}
+		}
+
+		if (arrival == n.arrival)
+			return false;
+		n.arrival = std::move(arrival);
+		return true;
+	}
+
+	bool update_downstream(RTLIL::SigBit bit)
+	{
+		Node &n = nodes.at(bit);
+		int downstream = -1;
+
+		for (auto &ep : n.endpoints)
+			downstream = std::max(downstream, ep.required);
+		for (int idx : n.fanout) {
+			int dst_downstream = nodes.at(arcs[idx].to).downstream;
+			if (dst_downstream >= 0)
+				downstream = std::max(downstream, dst_downstream + arcs[idx].delay);
+		}
+
+		if (downstream == n.downstream)
+			return false;
+		n.downstream = downstream;
+		return true;
+	}
+
+	void propagate()
+	{
+		// arrival times: lowest level first, so that every node is visited once
+		std::priority_queue<std::pair<int, RTLIL::SigBit>, std::vector<std::pair<int, RTLIL::SigBit>>,
+				std::greater<std::pair<int, RTLIL::SigBit>>> arrival_queue;
+		for (auto &bit : arrival_seeds)
+			arrival_queue.emplace(nodes.at(bit).level, bit);
+		while (!arrival_queue.empty()) {
+			RTLIL::SigBit bit = arrival_queue.top().second;
+			arrival_queue.pop();
+			if (!arrival_seeds.count(bit))
+				continue;
+			arrival_seeds.erase(bit);
+			if (!update_arrival(bit))
+				continue;
+			for (int idx : nodes.at(bit).fanout)
+				if (arrival_seeds.insert(arcs[idx].to).second)
+					arrival_queue.emplace(nodes.at(arcs[idx].to).level, arcs[idx].to);
+		}
+
+		// downstream times: highest level first
+		std::priority_queue<std::pair<int, RTLIL::SigBit>> downstream_queue;
+		for (auto &bit : downstream_seeds)
+			downstream_queue.emplace(nodes.at(bit).level, bit);
+		while (!downstream_queue.empty()) {
+			RTLIL::SigBit bit = downstream_queue.top().second;
+			downstream_queue.pop();
+			if (!downstream_seeds.count(bit))
+				continue;
+			downstream_seeds.erase(bit);
+			if (!update_downstream(bit))
+				continue;
+			for (int idx : nodes.at(bit).fanin)
+				if (downstream_seeds.insert(arcs[idx].from).second)
+					downstream_queue.emplace(nodes.at(arcs[idx].from).level, arcs[idx].from);
+		}
+	}
+
+	void reload()
+	{
+		sigmap.clear();
+		sigmap.set(module);
+		nodes.clear();
+		arcs.clear();
+		free_arcs.clear();
+		cell_data.clear();
+		dirty_cells.clear();
+		arrival_seeds.clear();
+		downstream_seeds.clear();
+
+		reloading = true;
+		for (auto cell : module->cells())
+			add_cell(cell);
+		reloading = false;
+
+		for (auto port_name : module->ports) {
+			auto wire = module->wire(port_name);
+			for (auto &bit : sigmap(wire)) {
+				if (!bit.wire)
+					continue;
+				if (wire->port_input)
+					nodes[bit].primary_input = true;
+				if (wire->port_output)
+					nodes[bit].endpoints.push_back(Endpoint());
+			}
+		}
+
+		// levelize in topological order, then a single pass in each direction
+		dict<RTLIL::SigBit, int> pending_fanin;
+		std::vector<RTLIL::SigBit> order;
+		for (auto &it : nodes) {
+			it.second.level = 0;
+			if (it.second.fanin.empty())
+				order.push_back(it.first);
+			else
+				pending_fanin[it.first] = GetSize(it.second.fanin);
+		}
+		for (int i = 0; i < GetSize(order); i++) {
+			const Node &n = nodes.at(order[i]);
+			for (int idx : n.fanout) {
+				Node &m = nodes.at(arcs[idx].to);
+				m.level = std::max(m.level, n.level + 1);
+				if (--pending_fanin.at(arcs[idx].to) == 0)
+					order.push_back(arcs[idx].to);
+			}
+		}
+		if (GetSize(order) != GetSize(nodes))
+			log_error("Module '%s' contains combinational loops through timing arcs.\n", log_id(module));
+
+		for (auto &bit : order)
+			update_arrival(bit);
+		for (int i = GetSize(order) - 1; i >= 0; i--)
+			update_downstream(order[i]);
+
+		arrival_seeds.clear();
+		downstream_seeds.clear();
+		reload_pending = false;
+	}
+
+public:
+	TimingGraph(RTLIL::Module *module) : module(module), reload_pending(true), reloading(false)
+	{
+		module->monitors.insert(this);
+	}
+
+	~TimingGraph()
+	{
+		module->monitors.erase(this);
+	}
+
+	void notify_connect(RTLIL::Cell *cell, const RTLIL::IdString &port, const RTLIL::SigSpec&, const RTLIL::SigSpec &sig) override
+	{
+		log_assert(module == cell->module);
+
+		if (reload_pending)
+			return;
+
+		// Removing the last connection happens before Module::remove() deletes
+		// the cell, so forget about it now instead of on the next query.
+		if (sig.empty() && GetSize(cell->connections()) == 1 && cell->hasPort(port)) {
+			drop_cell(cell);
+			dirty_cells.erase(cell);
+			return;
+		}
+
+		dirty_cells.insert(cell);
+	}
+
+	void notify_connect(RTLIL::Module *mod, const RTLIL::SigSig&) override
+	{
+		log_assert(module == mod);
+		reload_pending = true;
+	}
+
+	void notify_connect(RTLIL::Module *mod, const std::vector<RTLIL::SigSig>&) override
+	{
+		log_assert(module == mod);
+		reload_pending = true;
+	}
+
+	void notify_blackout(RTLIL::Module *mod) override
+	{
+		log_assert(module == mod);
+		reload_pending = true;
+	}
+
+	void invalidate(RTLIL::Cell *cell)
+	{
+		if (!reload_pending)
+			dirty_cells.insert(cell);
+	}
+
+	void invalidate()
+	{
+		reload_pending = true;
+	}
+
+	// Bring the graph up to date with the module. All queries below do this
+	// implicitly; call it before accessing `nodes` or `arcs` directly.
+	void update()
+	{
+		if (reload_pending) {
+			reload();
+			return;
+		}
+
+		for (auto cell : dirty_cells) {
+			drop_cell(cell);
+			add_cell(cell);
+		}
+		dirty_cells.clear();
+
+		propagate();
+	}
+
+	const Node *node(RTLIL::SigBit bit)
+	{
+		update();
+		auto it = nodes.find(sigmap(bit));
+		return it == nodes.end() ? nullptr : &it->second;
+	}
+
+	// latest arrival time over all clock domains, or -1 if unreachable
+	int arrival(RTLIL::SigBit bit)
+	{
+		const Node *n = node(bit);
+		return n ? n->max_arrival() : -1;
+	}
+
+	int arrival(RTLIL::SigBit bit, RTLIL::SigBit launch_clock)
+	{
+		const Node *n = node(bit);
+		if (!n)
+			return -1;
+		auto it = n->arrival.find(sigmap(launch_clock));
+		return it == n->arrival.end() ? -1 : it->second.time;
+	}
+
+	int downstream(RTLIL::SigBit bit)
+	{
+		const Node *n = node(bit);
+		return n ? n->downstream : -1;
+	}
+
+	bool is_driven(RTLIL::SigBit bit)
+	{
+		const Node *n = node(bit);
+		return n && (n->primary_input || n->drivers > 0);
+	}
+
+	pool<RTLIL::SigBit> clock_domains()
+	{
+		update();
+		pool<RTLIL::SigBit> domains;
+		for (auto &it : nodes)
+			for (auto &a : it.second.arrival)
+				domains.insert(a.first);
+		return domains;
+	}
+
+	Path trace(RTLIL::SigBit bit, RTLIL::SigBit launch_clock)
+	{
+		update();
+		Path path;
+		path.launch_clock = launch_clock;
+
+		bit = sigmap(bit);
+		const Node &end = nodes.at(bit);
+		if (const Endpoint *ep = end.worst_endpoint()) {
+			path.has_endpoint = true;
+			path.endpoint = *ep;
+		}
+		path.arrival = end.arrival.at(launch_clock).time + path.endpoint.required;
+
+		RTLIL::SigBit domain = launch_clock;
+		while (1) {
+			const Arrival &a = nodes.at(bit).arrival.at(domain);
+			path.steps.push_back(PathStep{bit, a.time, a.arc});
+			if (a.arc < 0)
+				break;
+			const Arc &arc = arcs[a.arc];
+			bit = arc.from;
+			if (arc.launch)
+				nodes.at(bit).max_arrival(&domain);
+		}
+
+		std::reverse(path.steps.begin(), path.steps.end());
+		return path;
+	}
+
+	// The `k` latest paths, at most one per end bit and clock domain. Paths end
+	// at endpoints and at bits without fanout (which may not be endpoints).
+	std::vector<Path> critical_paths(int k, std::optional<RTLIL::SigBit> launch_clock = {})
+	{
+		update();
+
+		std::vector<std::tuple<int, RTLIL::SigBit, RTLIL::SigBit>> candidates;
+		for (auto &it : nodes) {
+			const Node &n = it.second;
+			if (n.endpoints.empty() && !n.fanout.empty())
+				continue;
+			const Endpoint *ep = n.worst_endpoint();
+			for (auto &a : n.arrival) {
+				if (a.second.arc < 0)
+					continue;
+				if (launch_clock && *launch_clock != a.first)
+					continue;
+				candidates.emplace_back(a.second.time + (ep ? ep->required : 0), it.first, a.first);
+			}
+		}
+
+		k = std::min(k, GetSize(candidates));
+		std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(),
+				[](const std::tuple<int, RTLIL::SigBit, RTLIL::SigBit> &a, const std::tuple<int, RTLIL::SigBit, RTLIL::SigBit> &b) {
+					if (std::get<0>(a) != std::get<0>(b))
+						return std::get<0>(a) > std::get<0>(b);
+					return std::make_pair(std::get<1>(a), std::get<2>(a)) < std::make_pair(std::get<1>(b), std::get<2>(b));
+				});
+
+		std::vector<Path> paths;
+		for (int i = 0; i < k; i++)
+			paths.push_back(trace(std::get<1>(candidates[i]), std::get<2>(candidates[i])));
+		return paths;
+	}
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
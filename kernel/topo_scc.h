@@ -78,6 +78,7 @@ private:
             edge_ranges.emplace_back(std::make_pair(range_begin, range_end));
             range_begin = range_end;
         }
+        computed = true;
     }
 
 public:
@@ -168,6 +169,7 @@ private:
             edge_ranges.emplace_back(std::make_pair(range_begin, range_end));
             range_begin = range_end;
         }
+        computed = true;
     }
 
 public:
@@ -82,6 +82,7 @@ YOSYS_NAMESPACE_BEGIN
 int autoidx = 1;
 int yosys_xtrace = 0;
 bool yosys_write_versions = true;
+bool yosys_module_arena = false;
 const char* yosys_maybe_version() {
 	if (yosys_write_versions)
 		return yosys_version_str;
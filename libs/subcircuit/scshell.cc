@@ -184,6 +184,11 @@ int main()
 				continue;
 			}
 
+			if (cmdBuffer[0] == "prune" && cmdBuffer.size() == 1) {
+				solver.setNeighbourhoodPruning();
+				continue;
+			}
+
 			if (cmdBuffer[0] == "expect" && cmdBuffer.size() == 2) {
 				int expected = atoi(cmdBuffer[1].c_str());
 				printf("\n-- Expected %d, Got %d --\n", expected, int(results.size()) + int(mineResults.size()));
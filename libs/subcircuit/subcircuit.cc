@@ -296,8 +296,18 @@ class SubCircuit::SolverWorker
 		Graph graph;
 		adjMatrix_t adjMatrix;
 		std::vector<bool> usedNodes;
+		// number of neighbours of each node by type, see matchNeighbourhood()
+		std::vector<std::map<std::string, int>> neighbourTypes;
 	};
 
+	static std::map<std::string, int> neighbourTypeHistogram(const GraphData &gd, int nodeIdx)
+	{
+		std::map<std::string, int> histogram;
+		for (const auto &it : gd.adjMatrix.at(nodeIdx))
+			histogram[gd.graph.nodes[it.first].typeId]++;
+		return histogram;
+	}
+
 	static void printAdjMatrix(const adjMatrix_t &matrix)
 	{
 		my_printf("%7s", "");
@@ -635,6 +645,13 @@ class SubCircuit::SolverWorker
 		static void findEdgesInGraph(const Graph &graph, std::map<std::pair<int, int>, DiEdge> &edges)
 		{
 			edges.clear();
+
+			// high-fanout edges (e.g. supply nets) create many node pairs, so only build each DiNode once
+			std::vector<DiNode> diNodes;
+			diNodes.reserve(graph.nodes.size());
+			for (int i = 0; i < int(graph.nodes.size()); i++)
+				diNodes.push_back(DiNode(graph, i));
+
 			for (const auto &edge : graph.edges) {
 				if (edge.constValue != 0)
 					continue;
@@ -642,10 +659,12 @@ class SubCircuit::SolverWorker
 				for (const auto &toBit : edge.portBits)
 					if (&fromBit != &toBit) {
 						DiEdge &de = edges[std::pair<int, int>(fromBit.nodeIdx, toBit.nodeIdx)];
-						de.fromNode = DiNode(graph, fromBit.nodeIdx);
-						de.toNode = DiNode(graph, toBit.nodeIdx);
-						std::string fromPortId = graph.nodes[fromBit.nodeIdx].ports[fromBit.portIdx].portId;
-						std::string toPortId = graph.nodes[toBit.nodeIdx].ports[toBit.portIdx].portId;
+						if (de.bits.empty()) {
+							de.fromNode = diNodes[fromBit.nodeIdx];
+							de.toNode = diNodes[toBit.nodeIdx];
+						}
+						const std::string &fromPortId = graph.nodes[fromBit.nodeIdx].ports[fromBit.portIdx].portId;
+						const std::string &toPortId = graph.nodes[toBit.nodeIdx].ports[toBit.portIdx].portId;
 						de.bits.insert(DiBit(fromPortId, fromBit.bitIdx, toPortId, toBit.bitIdx));
 					}
 			}
@@ -718,6 +737,7 @@ class SubCircuit::SolverWorker
 	std::map<std::string, std::set<std::map<std::string, std::string>>> swapPermutations;
 	DiCache diCache;
 	bool verbose;
+	bool neighbourhoodPruning;
 
 	// main solver functions
 
@@ -847,22 +867,61 @@ class SubCircuit::SolverWorker
 		return false;
 	}
 
+	bool matchNeighbourhood(const GraphData &needle, int needleNodeIdx, const std::map<std::string, int> &needleTypes, const GraphData &haystack, int haystackNodeIdx) const
+	{
+		// Necessary condition for mapping a needle node to a haystack node:
+		//
+		// Nodes are mapped one-to-one and every edge in the needle must have a
+		// matching edge between the mapped nodes in the haystack. So the haystack
+		// node needs at least as many neighbours as the needle node, and at least
+		// as many neighbours of each type, for types without compatible types.
+
+		if (haystack.adjMatrix.at(haystackNodeIdx).size() < needle.adjMatrix.at(needleNodeIdx).size())
+			return false;
+
+		std::map<std::string, int> haystackTypesBuffer;
+		const std::map<std::string, int> *haystackTypes = &haystackTypesBuffer;
+		if (haystack.neighbourTypes.size() == haystack.graph.nodes.size())
+			haystackTypes = &haystack.neighbourTypes[haystackNodeIdx];
+		else
+			haystackTypesBuffer = neighbourTypeHistogram(haystack, haystackNodeIdx);
+
+		for (const auto &it : needleTypes) {
+			if (compatibleTypes.count(it.first) > 0)
+				continue;
+			auto haystackIt = haystackTypes->find(it.first);
+			if (haystackIt == haystackTypes->end() || haystackIt->second < it.second)
+				return false;
+		}
+
+		return true;
+	}
+
 	void generateEnumerationMatrix(std::vector<std::set<int>> &enumerationMatrix, const GraphData &needle, const GraphData &haystack, const std::map<std::string, std::set<std::string>> &initialMappings) const
 	{
 		std::map<std::string, std::set<int>> haystackNodesByTypeId;
 		for (int i = 0; i < int(haystack.graph.nodes.size()); i++)
 			haystackNodesByTypeId[haystack.graph.nodes[i].typeId].insert(i);
 
+		int candidatesPruned = 0;
+
 		enumerationMatrix.clear();
 		enumerationMatrix.resize(needle.graph.nodes.size());
 		for (int i = 0; i < int(needle.graph.nodes.size()); i++)
 		{
 			const Graph::Node &nn = needle.graph.nodes[i];
+			std::map<std::string, int> needleTypes;
+			if (neighbourhoodPruning)
+				needleTypes = neighbourTypeHistogram(needle, i);
 
 			for (int j : haystackNodesByTypeId[nn.typeId]) {
 				const Graph::Node &hn = haystack.graph.nodes[j];
 				if (initialMappings.count(nn.nodeId) > 0 && initialMappings.at(nn.nodeId).count(hn.nodeId) == 0)
 					continue;
+				if (neighbourhoodPruning && !matchNeighbourhood(needle, i, needleTypes, haystack, j)) {
+					candidatesPruned++;
+					continue;
+				}
 				if (!matchNodes(needle, i, haystack, j))
 					continue;
 				enumerationMatrix[i].insert(j);
@@ -874,11 +933,18 @@ class SubCircuit::SolverWorker
 						const Graph::Node &hn = haystack.graph.nodes[j];
 						if (initialMappings.count(nn.nodeId) > 0 && initialMappings.at(nn.nodeId).count(hn.nodeId) == 0)
 							continue;
+						if (neighbourhoodPruning && !matchNeighbourhood(needle, i, needleTypes, haystack, j)) {
+							candidatesPruned++;
+							continue;
+						}
 						if (!matchNodes(needle, i, haystack, j))
 							continue;
 						enumerationMatrix[i].insert(j);
 					}
 		}
+
+		if (verbose && neighbourhoodPruning)
+			my_printf("\nPruned %d candidates by neighbourhood.\n", candidatesPruned);
 	}
 
 	bool checkEnumerationMatrix(std::vector<std::set<int>> &enumerationMatrix, int i, int j, const GraphData &needle, const GraphData &haystack)
@@ -1470,7 +1536,7 @@ class SubCircuit::SolverWorker
 	// interface to the public solver class
 
 protected:
-	SolverWorker(Solver *userSolver) : userSolver(userSolver), verbose(false)
+	SolverWorker(Solver *userSolver) : userSolver(userSolver), verbose(false), neighbourhoodPruning(false)
 	{
 	}
 
@@ -1479,6 +1545,11 @@ protected:
 		verbose = true;
 	}
 
+	void setNeighbourhoodPruning()
+	{
+		neighbourhoodPruning = true;
+	}
+
 	void addGraph(std::string graphId, const Graph &graph)
 	{
 		assert(graphData.count(graphId) == 0);
@@ -1487,6 +1558,9 @@ protected:
 		gd.graphId = graphId;
 		gd.graph = graph;
 		diCache.add(gd.graph, gd.adjMatrix, graphId, userSolver);
+		if (neighbourhoodPruning)
+			for (int i = 0; i < int(gd.graph.nodes.size()); i++)
+				gd.neighbourTypes.push_back(neighbourTypeHistogram(gd, i));
 	}
 
 	void addCompatibleTypes(std::string needleTypeId, std::string haystackTypeId)
@@ -1628,6 +1702,11 @@ void SubCircuit::Solver::setVerbose()
 	worker->setVerbose();
 }
 
+void SubCircuit::Solver::setNeighbourhoodPruning()
+{
+	worker->setNeighbourhoodPruning();
+}
+
 void SubCircuit::Solver::addGraph(std::string graphId, const Graph &graph)
 {
 	worker->addGraph(graphId, graph);
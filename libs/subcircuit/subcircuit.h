@@ -134,6 +134,7 @@ namespace SubCircuit
 		virtual ~Solver();
 
 		void setVerbose();
+		void setNeighbourhoodPruning();
 		void addGraph(std::string graphId, const Graph &graph);
 		void addCompatibleTypes(std::string needleTypeId, std::string haystackTypeId);
 		void addCompatibleConstants(int needleConstant, int haystackConstant);
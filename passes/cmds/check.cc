@@ -22,10 +22,67 @@
 #include "kernel/celledges.h"
 #include "kernel/celltypes.h"
 #include "kernel/utils.h"
+#include "kernel/topo_scc.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
+// Connectivity graph between wire bits (and helper nodes for cells with
+// coarse edges), searched for loops with the iterative SCC search from
+// kernel/topo_scc.h. One loop is reported for each SCC.
+struct LoopFinder
+{
+	typedef std::pair<RTLIL::IdString, int> node_t;
+
+	idict<node_t> nodes;
+	IntGraph graph;
+	std::vector<std::vector<node_t>> loops;
+
+	void edge(const node_t &from, const node_t &to)
+	{
+		graph.add_edge(nodes(from), nodes(to));
+	}
+
+	void find_loops()
+	{
+		std::vector<int> component(GetSize(nodes), -1), parent(GetSize(nodes), -1);
+		int component_counter = 0;
+
+		TopoSortedSccs(graph, [&](int *begin, int *end) {
+			int start = *std::min_element(begin, end);
+			for (auto it = begin; it != end; ++it)
+				component[*it] = component_counter;
+
+			// breadth-first search for a shortest loop through `start`
+			// that stays within the SCC
+			std::vector<int> queue = {start};
+			parent[start] = start;
+			for (int i = 0; i < GetSize(queue); i++) {
+				int node = queue[i];
+				auto successors = graph.enumerate_successors(node);
+				while (!successors.finished()) {
+					int next = successors.next();
+					if (next == start) {
+						std::vector<node_t> loop;
+						for (; node != start; node = parent[node])
+							loop.push_back(nodes[node]);
+						loop.push_back(nodes[start]);
+						std::reverse(loop.begin(), loop.end());
+						loops.push_back(loop);
+						goto found_loop;
+					}
+					if (component[next] != component_counter || parent[next] >= 0)
+						continue;
+					parent[next] = node;
+					queue.push_back(next);
+				}
+			}
+		found_loop:
+			component_counter++;
+		}).process_all();
+	}
+};
+
 struct CheckPass : public Pass {
 	CheckPass() : Pass("check", "check for obvious problems in the design") { }
 	void help() override
@@ -118,7 +175,7 @@ struct CheckPass : public Pass {
 			dict<SigBit, Cell *> driver_cells;
 			dict<SigBit, int> wire_drivers_count;
 			pool<SigBit> used_wires;
-			TopoSort<std::pair<RTLIL::IdString, int>> topo;
+			LoopFinder loop_finder;
 			for (auto &proc_it : module->processes)
 			{
 				std::vector<RTLIL::CaseRule*> all_cases = {&proc_it.second->root_case};
@@ -164,12 +221,12 @@ struct CheckPass : public Pass {
 			}
 
 			struct CircuitEdgesDatabase : AbstractCellEdgesDatabase {
-				TopoSort<std::pair<RTLIL::IdString, int>> &topo;
+				LoopFinder &loop_finder;
 				SigMap sigmap;
 				bool force_detail;
 
-				CircuitEdgesDatabase(TopoSort<std::pair<RTLIL::IdString, int>> &topo, SigMap &sigmap, bool force_detail)
-					: topo(topo), sigmap(sigmap), force_detail(force_detail) {}
+				CircuitEdgesDatabase(LoopFinder &loop_finder, SigMap &sigmap, bool force_detail)
+					: loop_finder(loop_finder), sigmap(sigmap), force_detail(force_detail) {}
 
 				void add_edge(RTLIL::Cell *cell, RTLIL::IdString from_port, int from_bit,
 							  RTLIL::IdString to_port, int to_bit, int) override {
@@ -181,7 +238,7 @@ struct CheckPass : public Pass {
 					SigBit to = sigmap(to_portsig[to_bit]);
 
 					if (from.wire && to.wire)
-						topo.edge(std::make_pair(from.wire->name, from.offset), std::make_pair(to.wire->name, to.offset));
+						loop_finder.edge(std::make_pair(from.wire->name, from.offset), std::make_pair(to.wire->name, to.offset));
 				}
 
 				bool detail_costly(Cell *cell) {
@@ -224,13 +281,13 @@ struct CheckPass : public Pass {
 						if (cell->input(conn.first))
 						for (auto bit : sigmap(conn.second))
 						if (bit.wire)
-							topo.edge(std::make_pair(bit.wire->name, bit.offset),
+							loop_finder.edge(std::make_pair(bit.wire->name, bit.offset),
 									  std::make_pair(cell->name, -1));
 
 						if (cell->output(conn.first))
 						for (auto bit : sigmap(conn.second))
 						if (bit.wire)
-							topo.edge(std::make_pair(cell->name, -1),
+							loop_finder.edge(std::make_pair(cell->name, -1),
 									  std::make_pair(bit.wire->name, bit.offset));
 					}
 
@@ -239,7 +296,7 @@ struct CheckPass : public Pass {
 				}
 			};
 
-			CircuitEdgesDatabase edges_db(topo, sigmap, force_detailed_loop_check);
+			CircuitEdgesDatabase edges_db(loop_finder, sigmap, force_detailed_loop_check);
 
 			pool<Cell *> coarsened_cells;
 			for (auto cell : module->cells())
@@ -329,8 +386,8 @@ struct CheckPass : public Pass {
 					counter++;
 				}
 
-			topo.sort();
-			for (auto &loop : topo.loops) {
+			loop_finder.find_loops();
+			for (auto &loop : loop_finder.loops) {
 				string message = stringf("found logic loop in module %s:\n", log_id(module));
 
 				// `loop` only contains wire bits, or an occasional special helper node for cells for
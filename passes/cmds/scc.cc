@@ -25,6 +25,7 @@
 #include "kernel/celltypes.h"
 #include "kernel/sigtools.h"
 #include "kernel/log.h"
+#include "kernel/topo_scc.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -38,63 +39,103 @@ struct SccWorker
 	SigMap sigmap;
 	CellTypes ct, specifyCells;
 
-	pool<RTLIL::Cell*> workQueue;
-	dict<RTLIL::Cell*, pool<RTLIL::Cell*>> cellToNextCell;
+	idict<RTLIL::Cell*> cellIds;
+	IntGraph graph;
 	dict<RTLIL::Cell*, RTLIL::SigSpec> cellToPrevSig, cellToNextSig;
 
-	dict<RTLIL::Cell*, std::pair<int, int>> cellLabels;
-	dict<RTLIL::Cell*, int> cellDepth;
-	pool<RTLIL::Cell*> cellsOnStack;
-	std::vector<RTLIL::Cell*> cellStack;
-	int labelCounter;
-
-	dict<RTLIL::Cell*, int> cell2scc;
 	std::vector<pool<RTLIL::Cell*>> sccList;
 
-	void run(RTLIL::Cell *cell, int depth, int maxDepth)
+	bool has_feedback(int node) const
 	{
-		log_assert(workQueue.count(cell) > 0);
+		auto successors = graph.enumerate_successors(node);
+		while (!successors.finished())
+			if (successors.next() == node)
+				return true;
+		return false;
+	}
 
-		workQueue.erase(cell);
-		cellLabels[cell] = std::pair<int, int>(labelCounter, labelCounter);
-		labelCounter++;
+	void add_scc(const int *begin, const int *end, bool nofeedbackMode)
+	{
+		if (end - begin == 1 && (nofeedbackMode || !has_feedback(*begin)))
+			return;
 
-		cellsOnStack.insert(cell);
-		cellStack.push_back(cell);
+		log("Found an SCC:");
+		pool<RTLIL::Cell*> scc;
+		for (auto it = begin; it != end; ++it) {
+			RTLIL::Cell *cell = cellIds[*it];
+			log(" %s", RTLIL::id2cstr(cell->name));
+			scc.insert(cell);
+		}
+		sccList.push_back(scc);
+		log("\n");
+	}
 
-		if (maxDepth >= 0)
-			cellDepth[cell] = depth;
-
-		for (auto nextCell : cellToNextCell[cell])
-			if (cellLabels.count(nextCell) == 0) {
-				run(nextCell, depth+1, maxDepth);
-				cellLabels[cell].second = min(cellLabels[cell].second, cellLabels[nextCell].second);
-			} else
-			if (cellsOnStack.count(nextCell) > 0 && (maxDepth < 0 || cellDepth[nextCell] + maxDepth > depth)) {
-					cellLabels[cell].second = min(cellLabels[cell].second, cellLabels[nextCell].second);
+	// Tarjan's algorithm, but only following back edges that close a loop of
+	// at most maxDepth cells. This does not find proper SCCs, so it can't use
+	// TopoSortedSccs. Iterative, so deep netlists can't overflow the stack.
+	void run_depth_limited(int maxDepth, bool nofeedbackMode)
+	{
+		struct Frame {
+			int node, depth;
+			IntGraph::successor_enumerator successors;
+		};
+
+		std::vector<int> index, lowlink, depth, nodeStack;
+		std::vector<bool> onStack;
+		std::vector<Frame> dfsStack;
+		int labelCounter = 0;
+
+		auto visit = [&](int node, int node_depth) {
+			if (node >= GetSize(index)) {
+				index.resize(node + 1, -1);
+				lowlink.resize(node + 1);
+				depth.resize(node + 1);
+				onStack.resize(node + 1);
 			}
-
-		if (cellLabels[cell].first == cellLabels[cell].second)
+			index[node] = lowlink[node] = labelCounter++;
+			depth[node] = node_depth;
+			onStack[node] = true;
+			nodeStack.push_back(node);
+			dfsStack.push_back(Frame{node, node_depth, graph.enumerate_successors(node)});
+		};
+
+		auto nodes = graph.enumerate_nodes();
+		while (!nodes.finished())
 		{
-			if (cellStack.back() == cell)
-			{
-				cellStack.pop_back();
-				cellsOnStack.erase(cell);
-			}
-			else
+			int root = nodes.next();
+			if (root < GetSize(index) && index[root] >= 0)
+				continue;
+
+			visit(root, 0);
+			while (!dfsStack.empty())
 			{
-				log("Found an SCC:");
-				pool<RTLIL::Cell*> scc;
-				while (cellsOnStack.count(cell) > 0) {
-					RTLIL::Cell *c = cellStack.back();
-					cellStack.pop_back();
-					cellsOnStack.erase(c);
-					log(" %s", RTLIL::id2cstr(c->name));
-					cell2scc[c] = sccList.size();
-					scc.insert(c);
+				Frame &frame = dfsStack.back();
+				if (!frame.successors.finished()) {
+					int next = frame.successors.next();
+					if (next >= GetSize(index) || index[next] < 0)
+						visit(next, frame.depth + 1);
+					else if (onStack[next] && depth[next] + maxDepth > frame.depth)
+						lowlink[frame.node] = min(lowlink[frame.node], lowlink[next]);
+					continue;
+				}
+
+				int node = frame.node;
+				dfsStack.pop_back();
+
+				if (lowlink[node] == index[node]) {
+					int current = GetSize(nodeStack);
+					do {
+						--current;
+						onStack[nodeStack[current]] = false;
+					} while (nodeStack[current] != node);
+					add_scc(nodeStack.data() + current, nodeStack.data() + nodeStack.size(), nofeedbackMode);
+					nodeStack.resize(current);
+				}
+
+				if (!dfsStack.empty()) {
+					int parent = dfsStack.back().node;
+					lowlink[parent] = min(lowlink[parent], lowlink[node]);
 				}
-				sccList.push_back(scc);
-				log("\n");
 			}
 		}
 	}
@@ -127,7 +168,7 @@ struct SccWorker
 		}
 
 		SigPool selectedSignals;
-		SigSet<RTLIL::Cell*> sigToNextCells;
+		dict<RTLIL::SigBit, std::vector<int>> sigToNextCells;
 
 		for (auto &it : module->wires_)
 			if (design->selected(module, it.second))
@@ -143,7 +184,7 @@ struct SccWorker
 			if (!allCellTypes && !ct.cell_known(cell->type) && !specifyCells.cell_known(cell->type))
 				continue;
 
-			workQueue.insert(cell);
+			int cellId = cellIds(cell);
 
 			RTLIL::SigSpec inputSignals, outputSignals;
 
@@ -193,35 +234,27 @@ struct SccWorker
 
 			cellToPrevSig[cell] = inputSignals;
 			cellToNextSig[cell] = outputSignals;
-			sigToNextCells.insert(inputSignals, cell);
+			for (auto bit : inputSignals)
+				sigToNextCells[bit].push_back(cellId);
 		}
 
-		for (auto cell : workQueue)
-		{
-			sigToNextCells.find(cellToNextSig[cell], cellToNextCell[cell]);
-
-			if (!nofeedbackMode && cellToNextCell[cell].count(cell)) {
-				log("Found an SCC:");
-				pool<RTLIL::Cell*> scc;
-				log(" %s", RTLIL::id2cstr(cell->name));
-				cell2scc[cell] = sccList.size();
-				scc.insert(cell);
-				sccList.push_back(scc);
-				log("\n");
+		// compact (CSR) cell-to-cell adjacency, built once for the module
+		for (auto &it : cellToNextSig) {
+			int cellId = cellIds.at(it.first);
+			for (auto bit : it.second) {
+				auto found = sigToNextCells.find(bit);
+				if (found != sigToNextCells.end())
+					for (int nextId : found->second)
+						graph.add_edge(cellId, nextId);
 			}
 		}
 
-		labelCounter = 0;
-		cellLabels.clear();
-
-		while (!workQueue.empty())
-		{
-			RTLIL::Cell *cell = *workQueue.begin();
-			log_assert(cellStack.size() == 0);
-			cellDepth.clear();
-
-			run(cell, 0, maxDepth);
-		}
+		if (maxDepth >= 0)
+			run_depth_limited(maxDepth, nofeedbackMode);
+		else
+			TopoSortedSccs(graph, [&](int *begin, int *end) {
+				add_scc(begin, end, nofeedbackMode);
+			}).process_all();
 
 		log("Found %d SCCs in module %s.\n", int(sccList.size()), RTLIL::id2cstr(module->name));
 	}
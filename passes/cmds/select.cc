@@ -30,12 +30,11 @@ using RTLIL::id2cstr;
 
 static std::vector<RTLIL::Selection> work_stack;
 
-static bool match_ids(RTLIL::IdString id, const std::string &pattern)
+static bool match_ids(const char *id_c, const std::string &pattern)
 {
-	if (id == pattern)
+	if (pattern == id_c)
 		return true;
 
-	const char *id_c = id.c_str();
 	const char *pat_c = pattern.c_str();
 	size_t id_size = strlen(id_c);
 	size_t pat_size = pattern.size();
@@ -54,6 +53,11 @@ static bool match_ids(RTLIL::IdString id, const std::string &pattern)
 	return false;
 }
 
+static bool match_ids(RTLIL::IdString id, const std::string &pattern)
+{
+	return match_ids(id.c_str(), pattern);
+}
+
 static bool match_attr_val(const RTLIL::Const &value, const std::string &pattern, char match_op)
 {
 	if (match_op == 0)
@@ -141,6 +145,199 @@ static bool match_attr(const dict<RTLIL::IdString, RTLIL::Const> &attributes, co
 	return match_attr(attributes, match_expr, std::string(), 0);
 }
 
+// Lookup structures for a single module that allow select expressions to visit only
+// candidate objects instead of scanning the whole module. They are built on demand and
+// shared by the select expressions of a single selection command (see SelectIndex).
+
+struct SelectNameIndex
+{
+	// Keyed by string, so that looking up a pattern doesn't add it to the global IdString table.
+	dict<std::string, std::vector<RTLIL::IdString>> entries;
+	std::vector<std::string> sorted_keys;
+	dict<std::string, std::vector<std::string>> dollar_tails;
+
+	void add(RTLIL::IdString key, RTLIL::IdString member)
+	{
+		entries[key.str()].push_back(member);
+	}
+
+	void finalize()
+	{
+		sorted_keys.reserve(entries.size());
+		for (auto &it : entries) {
+			sorted_keys.push_back(it.first);
+			if (it.first[0] == '$')
+				dollar_tails[it.first.substr(it.first.rfind('$'))].push_back(it.first);
+		}
+		std::sort(sorted_keys.begin(), sorted_keys.end());
+	}
+
+	// Call f() for the members of all keys matched by the given pattern, with the same
+	// semantics as match_ids(). Only keys that share the literal prefix of the pattern
+	// (or the same '$' suffix) are checked, unless the pattern starts with a wildcard.
+	template<typename F>
+	void lookup(const std::string &pattern, F f) const
+	{
+		auto visit = [&](const std::string &key) {
+			auto it = entries.find(key);
+			if (it != entries.end())
+				for (auto member : it->second)
+					f(member);
+		};
+
+		if (pattern.empty())
+			return;
+
+		if (pattern[0] == '$') {
+			auto it = dollar_tails.find(pattern);
+			if (it != dollar_tails.end())
+				for (auto &key : it->second)
+					visit(key);
+		}
+
+		size_t special = pattern.find_first_of("*?[\\", pattern[0] == '\\' ? 1 : 0);
+		if (special == std::string::npos) {
+			if (pattern[0] == '\\' || pattern[0] == '$')
+				visit(pattern);
+			visit("\\" + pattern);
+			return;
+		}
+
+		if (special == 0 || pattern[0] == '\\') {
+			for (auto &key : sorted_keys)
+				if (match_ids(key.c_str(), pattern))
+					visit(key);
+			return;
+		}
+
+		auto visit_prefix = [&](const std::string &prefix) {
+			auto it = std::lower_bound(sorted_keys.begin(), sorted_keys.end(), prefix);
+			for (; it != sorted_keys.end() && it->compare(0, prefix.size(), prefix) == 0; ++it)
+				if (match_ids(it->c_str(), pattern))
+					visit(*it);
+		};
+
+		std::string prefix = pattern.substr(0, special);
+		visit_prefix(prefix);
+		if (prefix[0] != '$')
+			visit_prefix("\\" + prefix);
+	}
+};
+
+struct SelectModuleIndex
+{
+	bool has_names = false;
+	SelectNameIndex wires, memories, cells, processes, cell_types;
+
+	bool has_attrs = false;
+	dict<std::string, std::vector<RTLIL::IdString>> attr_objects;
+
+	bool has_conns = false;
+	dict<RTLIL::Wire*, std::vector<RTLIL::Cell*>> wire_cells;
+	dict<RTLIL::Wire*, std::vector<RTLIL::Wire*>> conn_fanout, conn_fanin;
+
+	void setup_names(RTLIL::Module *mod)
+	{
+		if (has_names)
+			return;
+		for (auto wire : mod->wires())
+			wires.add(wire->name, wire->name);
+		for (auto &it : mod->memories)
+			memories.add(it.first, it.first);
+		for (auto cell : mod->cells()) {
+			cells.add(cell->name, cell->name);
+			cell_types.add(cell->type, cell->name);
+		}
+		for (auto &it : mod->processes)
+			processes.add(it.first, it.first);
+		wires.finalize();
+		memories.finalize();
+		cells.finalize();
+		processes.finalize();
+		cell_types.finalize();
+		has_names = true;
+	}
+
+	void setup_attrs(RTLIL::Module *mod)
+	{
+		if (has_attrs)
+			return;
+		for (auto wire : mod->wires())
+			for (auto &it : wire->attributes)
+				attr_objects[it.first.str()].push_back(wire->name);
+		for (auto &mem : mod->memories)
+			for (auto &it : mem.second->attributes)
+				attr_objects[it.first.str()].push_back(mem.first);
+		for (auto cell : mod->cells())
+			for (auto &it : cell->attributes)
+				attr_objects[it.first.str()].push_back(cell->name);
+		for (auto &proc : mod->processes)
+			for (auto &it : proc.second->attributes)
+				attr_objects[it.first.str()].push_back(proc.first);
+		has_attrs = true;
+	}
+
+	void setup_conns(RTLIL::Module *mod)
+	{
+		if (has_conns)
+			return;
+		for (auto &conn : mod->connections()) {
+			std::vector<RTLIL::SigBit> conn_lhs = conn.first.to_sigbit_vector();
+			std::vector<RTLIL::SigBit> conn_rhs = conn.second.to_sigbit_vector();
+			for (size_t i = 0; i < conn_lhs.size(); i++) {
+				if (conn_lhs[i].wire == nullptr || conn_rhs[i].wire == nullptr)
+					continue;
+				conn_fanout[conn_rhs[i].wire].push_back(conn_lhs[i].wire);
+				conn_fanin[conn_lhs[i].wire].push_back(conn_rhs[i].wire);
+			}
+		}
+		for (auto cell : mod->cells())
+			for (auto &conn : cell->connections())
+				for (auto &chunk : conn.second.chunks())
+					if (chunk.wire != nullptr) {
+						auto &users = wire_cells[chunk.wire];
+						if (users.empty() || users.back() != cell)
+							users.push_back(cell);
+					}
+		has_conns = true;
+	}
+};
+
+// SelectModuleIndex objects for the modules visited by one selection command, i.e. one
+// call of select, ls or cd, or the selection arguments of any other command. Nothing
+// changes the netlist while these are evaluated, so the index never has to be updated.
+// It is dropped at the end of the command and can't see edits made in between.
+struct SelectIndex
+{
+	dict<RTLIL::Module*, SelectModuleIndex> modules;
+
+	SelectModuleIndex &get(RTLIL::Module *mod)
+	{
+		return modules[mod];
+	}
+};
+
+static SelectIndex *select_index = nullptr;
+
+// Makes a SelectIndex available for as long as the outermost scope is alive.
+struct SelectIndexScope
+{
+	SelectIndex index;
+	bool owner;
+
+	SelectIndexScope() : owner(select_index == nullptr)
+	{
+		if (owner)
+			select_index = &index;
+	}
+
+	~SelectIndexScope()
+	{
+		if (owner)
+			select_index = nullptr;
+	}
+};
+
 static void select_all(RTLIL::Design *design, RTLIL::Selection &lhs)
 {
 	if (!lhs.selects_all())
@@ -489,6 +686,85 @@ static int parse_comma_list(std::set<RTLIL::IdString> &tokens, const std::string
 	}
 }
 
+static bool select_expand_rules_match(RTLIL::Cell *cell, RTLIL::IdString port, std::vector<expand_rule_t> &rules, bool eval_only)
+{
+	char last_mode = '-';
+	if (eval_only && !yosys_celltypes.cell_evaluable(cell->type))
+		return false;
+	for (auto &rule : rules) {
+		last_mode = rule.mode;
+		if (rule.cell_types.size() > 0 && rule.cell_types.count(cell->type) == 0)
+			continue;
+		if (rule.port_names.size() > 0 && rule.port_names.count(port) == 0)
+			continue;
+		return rule.mode == '+';
+	}
+	return last_mode != '+';
+}
+
+// Same as select_op_expand() below for the case without an object limit, where the order
+// in which objects are added does not matter. Instead of scanning all connections of the
+// module, only the neighbours of the currently selected objects are visited.
+static int select_op_expand_indexed(RTLIL::Module *mod, RTLIL::Selection &lhs, std::vector<expand_rule_t> &rules, std::set<RTLIL::IdString> &limits, char mode, CellTypes &ct, bool eval_only)
+{
+	int sel_objects = 0;
+	SelectModuleIndex &index = select_index->get(mod);
+	index.setup_conns(mod);
+
+	auto selected_members = lhs.selected_members[mod->name];
+	auto &new_members = lhs.selected_members[mod->name];
+	auto select_member = [&](RTLIL::IdString name) {
+		if (selected_members.count(name) == 0 && new_members.insert(name).second)
+			sel_objects++;
+	};
+
+	pool<RTLIL::Wire*> selected_wires;
+	pool<RTLIL::Cell*> candidate_cells;
+	for (auto name : selected_members) {
+		RTLIL::Wire *wire = mod->wire(name);
+		if (wire != nullptr) {
+			if (limits.count(name) == 0)
+				selected_wires.insert(wire);
+			continue;
+		}
+		RTLIL::Cell *cell = mod->cell(name);
+		if (cell != nullptr)
+			candidate_cells.insert(cell);
+	}
+
+	for (auto wire : selected_wires) {
+		if (mode != 'i' && index.conn_fanout.count(wire))
+			for (auto other : index.conn_fanout.at(wire))
+				select_member(other->name);
+		if (mode != 'o' && index.conn_fanin.count(wire))
+			for (auto other : index.conn_fanin.at(wire))
+				select_member(other->name);
+		if (index.wire_cells.count(wire))
+			for (auto cell : index.wire_cells.at(wire))
+				candidate_cells.insert(cell);
+	}
+
+	for (auto cell : candidate_cells)
+	for (auto &conn : cell->connections())
+	{
+		if (!select_expand_rules_match(cell, conn.first, rules, eval_only))
+			continue;
+		bool is_input = mode == 'x' || ct.cell_input(cell->type, conn.first);
+		bool is_output = mode == 'x' || ct.cell_output(cell->type, conn.first);
+		for (auto &chunk : conn.second.chunks())
+			if (chunk.wire != nullptr) {
+				if (selected_wires.count(chunk.wire) > 0 && selected_members.count(cell->name) == 0)
+					if (mode == 'x' || (mode == 'i' && is_output) || (mode == 'o' && is_input))
+						select_member(cell->name);
+				if (selected_members.count(cell->name) > 0 && limits.count(cell->name) == 0 && selected_members.count(chunk.wire->name) == 0)
+					if (mode == 'x' || (mode == 'i' && is_input) || (mode == 'o' && is_output))
+						select_member(chunk.wire->name);
+			}
+	}
+
+	return sel_objects;
+}
+
 static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::vector<expand_rule_t> &rules, std::set<RTLIL::IdString> &limits, int max_objects, char mode, CellTypes &ct, bool eval_only)
 {
 	int sel_objects = 0;
@@ -498,6 +774,11 @@ static int select_op_expand(RTLIL::Design *design, RTLIL::Selection &lhs, std::v
 		if (lhs.selected_whole_module(mod->name) || !lhs.selected_module(mod->name))
 			continue;
 
+		if (max_objects < 0) {
+			sel_objects += select_op_expand_indexed(mod, lhs, rules, limits, mode, ct, eval_only);
+			continue;
+		}
+
 		std::set<RTLIL::Wire*> selected_wires;
 		auto selected_members = lhs.selected_members[mod->name];
 
@@ -699,6 +980,8 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 	if (arg.size() == 0)
 		return;
 
+	SelectIndexScope index_scope;
+
 	if (arg[0] == '%') {
 		if (arg == "%") {
 			work_stack.push_back(design->selection());
@@ -884,25 +1167,37 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			continue;
 		}
 
+		SelectModuleIndex &index = select_index->get(mod);
+
 		if (arg_memb.compare(0, 2, "w:") == 0) {
-			for (auto wire : mod->wires())
-				if (match_ids(wire->name, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(wire->name);
+			index.setup_names(mod);
+			index.wires.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "i:") == 0) {
-			for (auto wire : mod->wires())
-				if (wire->port_input && match_ids(wire->name, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(wire->name);
+			index.setup_names(mod);
+			index.wires.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				RTLIL::Wire *wire = mod->wire(name);
+				if (wire != nullptr && wire->port_input)
+					sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "o:") == 0) {
-			for (auto wire : mod->wires())
-				if (wire->port_output && match_ids(wire->name, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(wire->name);
+			index.setup_names(mod);
+			index.wires.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				RTLIL::Wire *wire = mod->wire(name);
+				if (wire != nullptr && wire->port_output)
+					sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "x:") == 0) {
-			for (auto wire : mod->wires())
-				if ((wire->port_input || wire->port_output) && match_ids(wire->name, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(wire->name);
+			index.setup_names(mod);
+			index.wires.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				RTLIL::Wire *wire = mod->wire(name);
+				if (wire != nullptr && (wire->port_input || wire->port_output))
+					sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "s:") == 0) {
 			size_t delim = arg_memb.substr(2).find(':');
@@ -922,14 +1217,16 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			}
 		} else
 		if (arg_memb.compare(0, 2, "m:") == 0) {
-			for (auto &it : mod->memories)
-				if (match_ids(it.first, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(it.first);
+			index.setup_names(mod);
+			index.memories.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "c:") == 0) {
-			for (auto cell : mod->cells())
-				if (match_ids(cell->name, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(cell->name);
+			index.setup_names(mod);
+			index.cells.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "t:") == 0) {
 			if (arg_memb.compare(2, 1, "@") == 0) {
@@ -942,29 +1239,58 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 					if (muster.selected_modules.count(cell->type))
 						sel.selected_members[mod->name].insert(cell->name);
 			} else {
-				for (auto cell : mod->cells())
-					if (match_ids(cell->type, arg_memb.substr(2)))
-						sel.selected_members[mod->name].insert(cell->name);
+				index.setup_names(mod);
+				index.cell_types.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+					sel.selected_members[mod->name].insert(name);
+				});
 			}
 		} else
 		if (arg_memb.compare(0, 2, "p:") == 0) {
-			for (auto &it : mod->processes)
-				if (match_ids(it.first, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(it.first);
+			index.setup_names(mod);
+			index.processes.lookup(arg_memb.substr(2), [&](RTLIL::IdString name) {
+				sel.selected_members[mod->name].insert(name);
+			});
 		} else
 		if (arg_memb.compare(0, 2, "a:") == 0) {
-			for (auto wire : mod->wires())
-				if (match_attr(wire->attributes, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(wire->name);
-			for (auto &it : mod->memories)
-				if (match_attr(it.second->attributes, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(it.first);
-			for (auto cell : mod->cells())
-				if (match_attr(cell->attributes, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(cell->name);
-			for (auto &it : mod->processes)
-				if (match_attr(it.second->attributes, arg_memb.substr(2)))
-					sel.selected_members[mod->name].insert(it.first);
+			std::string attr_name = arg_memb.substr(2, arg_memb.find_first_of("<!=>", 2) - 2);
+			if (attr_name.find_first_of("*?[") == std::string::npos) {
+				// Only objects carrying an attribute of that name can match.
+				index.setup_attrs(mod);
+				auto check = [&](const std::string &attr) {
+					auto it = index.attr_objects.find(attr);
+					if (it == index.attr_objects.end())
+						return;
+					for (auto name : it->second) {
+						const dict<RTLIL::IdString, RTLIL::Const> *attributes = nullptr;
+						if (mod->wire(name) != nullptr)
+							attributes = &mod->wire(name)->attributes;
+						else if (mod->cell(name) != nullptr)
+							attributes = &mod->cell(name)->attributes;
+						else if (mod->memories.count(name))
+							attributes = &mod->memories.at(name)->attributes;
+						else
+							attributes = &mod->processes.at(name)->attributes;
+						if (match_attr(*attributes, arg_memb.substr(2)))
+							sel.selected_members[mod->name].insert(name);
+					}
+				};
+				if (!attr_name.empty() && (attr_name[0] == '\\' || attr_name[0] == '$'))
+					check(attr_name);
+				check("\\" + attr_name);
+			} else {
+				for (auto wire : mod->wires())
+					if (match_attr(wire->attributes, arg_memb.substr(2)))
+						sel.selected_members[mod->name].insert(wire->name);
+				for (auto &it : mod->memories)
+					if (match_attr(it.second->attributes, arg_memb.substr(2)))
+						sel.selected_members[mod->name].insert(it.first);
+				for (auto cell : mod->cells())
+					if (match_attr(cell->attributes, arg_memb.substr(2)))
+						sel.selected_members[mod->name].insert(cell->name);
+				for (auto &it : mod->processes)
+					if (match_attr(it.second->attributes, arg_memb.substr(2)))
+						sel.selected_members[mod->name].insert(it.first);
+			}
 		} else
 		if (arg_memb.compare(0, 2, "r:") == 0) {
 			for (auto cell : mod->cells())
@@ -974,26 +1300,15 @@ static void select_stmt(RTLIL::Design *design, std::string arg, bool disable_emp
 			std::string orig_arg_memb = arg_memb;
 			if (arg_memb.compare(0, 2, "n:") == 0)
 				arg_memb = arg_memb.substr(2);
-			for (auto wire : mod->wires())
-				if (match_ids(wire->name, arg_memb)) {
-					sel.selected_members[mod->name].insert(wire->name);
-					arg_memb_found[orig_arg_memb] = true;
-				}
-			for (auto &it : mod->memories)
-				if (match_ids(it.first, arg_memb)) {
-					sel.selected_members[mod->name].insert(it.first);
-					arg_memb_found[orig_arg_memb] = true;
-				}
-			for (auto cell : mod->cells())
-				if (match_ids(cell->name, arg_memb)) {
-					sel.selected_members[mod->name].insert(cell->name);
-					arg_memb_found[orig_arg_memb] = true;
-				}
-			for (auto &it : mod->processes)
-				if (match_ids(it.first, arg_memb)) {
-					sel.selected_members[mod->name].insert(it.first);
-					arg_memb_found[orig_arg_memb] = true;
-				}
+			auto select_name = [&](RTLIL::IdString name) {
+				sel.selected_members[mod->name].insert(name);
+				arg_memb_found[orig_arg_memb] = true;
+			};
+			index.setup_names(mod);
+			index.wires.lookup(arg_memb, select_name);
+			index.memories.lookup(arg_memb, select_name);
+			index.cells.lookup(arg_memb, select_name);
+			index.processes.lookup(arg_memb, select_name);
 		}
 	}
 
@@ -1037,6 +1352,7 @@ YOSYS_NAMESPACE_BEGIN
 // used in kernel/register.cc and maybe other locations, extern decl. in register.h
 void handle_extra_select_args(Pass *pass, const vector<string> &args, size_t argidx, size_t args_size, RTLIL::Design *design)
 {
+	SelectIndexScope index_scope;
 	work_stack.clear();
 	for (; argidx < args_size; argidx++) {
 		if (args[argidx].compare(0, 1, "-") == 0) {
@@ -1060,6 +1376,7 @@ void handle_extra_select_args(Pass *pass, const vector<string> &args, size_t arg
 // extern decl. in register.h
 RTLIL::Selection eval_select_args(const vector<string> &args, RTLIL::Design *design)
 {
+	SelectIndexScope index_scope;
 	work_stack.clear();
 	for (auto &arg : args)
 		select_stmt(design, arg);
@@ -1339,6 +1656,7 @@ struct SelectPass : public Pass {
 		int assert_min = -1;
 		std::string write_file, read_file;
 		std::string set_name, unset_name, sel_str;
+		SelectIndexScope index_scope;
 
 		work_stack.clear();
 
@@ -20,229 +20,103 @@
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
-#include "kernel/timinginfo.h"
-#include <deque>
+#include "kernel/timinggraph.h"
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
 struct StaWorker
 {
-	Design *design;
 	Module *module;
-	SigMap sigmap;
+	TimingGraph graph;
+	int num_paths;
 
-	struct t_data {
-		Cell* driver;
-		IdString dst_port, src_port;
-		vector<tuple<SigBit,int,IdString>> fanouts;
-		SigBit backtrack;
-		t_data() : driver(nullptr) {}
-	};
-	dict<SigBit, t_data> data;
-	std::deque<SigBit> queue;
-	struct t_endpoint {
-		Cell *sink;
-		IdString port;
-		int required;
-		t_endpoint() : sink(nullptr), required(0) {}
-	};
-	dict<SigBit, t_endpoint> endpoints;
-
-	int maxarrival;
-	SigBit maxbit;
-
-	pool<SigBit> driven;
-
-	StaWorker(RTLIL::Module *module) : design(module->design), module(module), sigmap(module), maxarrival(0)
+	StaWorker(RTLIL::Module *module, int num_paths) : module(module), graph(module), num_paths(num_paths)
 	{
-		TimingInfo timing;
-
-		pool<IdString> unrecognised_cells;
-
-		for (auto cell : module->cells())
-		{
-			Module *inst_module = design->module(cell->type);
-			if (!inst_module) {
-				if (unrecognised_cells.insert(cell->type).second)
-					log_warning("Cell type '%s' not recognised! Ignoring.\n", log_id(cell->type));
-				continue;
-			}
-
-			if (!inst_module->get_blackbox_attribute()) {
-				log_warning("Cell type '%s' is not a black- nor white-box! Ignoring.\n", log_id(cell->type));
-				continue;
-			}
+	}
 
-			IdString derived_type = inst_module->derive(design, cell->parameters);
-			inst_module = design->module(derived_type);
-			log_assert(inst_module);
+	void annotate()
+	{
+		dict<Wire*, std::vector<int>> arrivals;
 
-			if (!timing.count(derived_type)) {
-				auto &t = timing.setup_module(inst_module);
-				if (t.has_inputs && t.comb.empty() && t.arrival.empty() && t.required.empty())
-					log_warning("Module '%s' has no timing arcs!\n", log_id(cell->type));
-			}
+		// All primary inputs to arrive at time zero
+		for (auto port_name : module->ports) {
+			auto wire = module->wire(port_name);
+			if (wire->port_input)
+				arrivals[wire] = std::vector<int>(GetSize(wire), 0);
+		}
 
-			auto &t = timing.at(derived_type);
-			if (t.comb.empty() && t.arrival.empty() && t.required.empty())
+		for (auto &it : graph.nodes) {
+			int arrival = it.second.max_arrival();
+			if (arrival < 0)
 				continue;
+			auto &v = arrivals[it.first.wire];
+			if (v.empty())
+				v = std::vector<int>(GetSize(it.first.wire), -1);
+			v[it.first.offset] = arrival;
+		}
 
-			pool<std::pair<SigBit,TimingInfo::NameBit>> src_bits, dst_bits;
-
-			for (auto &conn : cell->connections()) {
-				auto rhs = sigmap(conn.second);
-				for (auto i = 0; i < GetSize(rhs); i++) {
-					const auto &bit = rhs[i];
-					if (!bit.wire)
-						continue;
-					TimingInfo::NameBit namebit(conn.first,i);
-					if (cell->input(conn.first)) {
-						src_bits.insert(std::make_pair(bit,namebit));
-
-						auto it = t.required.find(namebit);
-						if (it == t.required.end())
-							continue;
-						auto r = endpoints.insert(bit);
-						if (r.second || r.first->second.required < it->second.first) {
-							r.first->second.sink = cell;
-							r.first->second.port = conn.first;
-							r.first->second.required = it->second.first;
-						}
-					}
-					if (cell->output(conn.first)) {
-						dst_bits.insert(std::make_pair(bit,namebit));
-						auto &d = data[bit];
-						d.driver = cell;
-						d.dst_port = conn.first;
-						driven.insert(bit);
-
-						auto it = t.arrival.find(namebit);
-						if (it == t.arrival.end())
-							continue;
-						const auto &s = it->second.second;
-						if (cell->hasPort(s.name)) {
-							auto s_bit = sigmap(cell->getPort(s.name)[s.offset]);
-							if (s_bit.wire)
-								data[s_bit].fanouts.emplace_back(bit,it->second.first,s.name);
-						}
-					}
-				}
-			}
+		for (auto &it : arrivals)
+			it.first->set_intvec_attribute(ID::sta_arrival, it.second);
+	}
 
-			for (const auto &s : src_bits)
-				for (const auto &d : dst_bits) {
-					auto it = t.comb.find(TimingInfo::BitBit(s.second,d.second));
-					if (it == t.comb.end())
-						continue;
-					data[s.first].fanouts.emplace_back(d.first,it->second,s.second.name);
-				}
+	void log_path(const TimingGraph::Path &path)
+	{
+		auto b = path.steps.back().bit;
+		if (path.has_endpoint && path.endpoint.sink)
+			log("  %6d %s (%s.%s)\n", path.arrival, log_id(path.endpoint.sink), log_id(path.endpoint.sink->type), log_id(path.endpoint.port));
+		else {
+			log("  %6d (%s)\n", path.arrival, b.wire->port_output ? "<primary output>" : "<unknown>");
+			if (!b.wire->port_output)
+				log_warning("Critical-path does not terminate in a recognised endpoint.\n");
 		}
-
-		for (auto port_name : module->ports) {
-			auto wire = module->wire(port_name);
-			if (wire->port_input) {
-				for (const auto &b : sigmap(wire)) {
-					queue.emplace_back(b);
-					driven.insert(b);
-				}
-				// All primary inputs to arrive at time zero
-				wire->set_intvec_attribute(ID::sta_arrival, std::vector<int>(GetSize(wire), 0));
+		for (int i = GetSize(path.steps) - 1; i >= 0; i--) {
+			const auto &step = path.steps[i];
+			if (step.arc >= 0) {
+				const auto &arc = graph.arcs[step.arc];
+				log("           %s\n", log_signal(step.bit));
+				log("  %6d %s (%s.%s->%s)\n", step.arrival, log_id(arc.cell), log_id(arc.cell->type), log_id(arc.from_port), log_id(arc.to_port));
 			}
-			if (wire->port_output)
-				for (const auto &b : sigmap(wire))
-					if (b.wire)
-						endpoints.insert(b);
+			else if (step.bit.wire->port_input)
+				log("  %6d   %s (%s)\n", step.arrival, log_signal(step.bit), "<primary input>");
+			else
+				log_abort();
 		}
 	}
 
 	void run()
 	{
-		while (!queue.empty()) {
-			auto b = queue.front();
-			queue.pop_front();
-			auto it = data.find(b);
-			if (it == data.end())
-				continue;
-			const auto& src_arrivals = b.wire->get_intvec_attribute(ID::sta_arrival);
-			log_assert(GetSize(src_arrivals) == GetSize(b.wire));
-			auto src_arrival = src_arrivals[b.offset];
-			for (const auto &d : it->second.fanouts) {
-				const auto &dst_bit = std::get<0>(d);
-				auto dst_arrivals = dst_bit.wire->get_intvec_attribute(ID::sta_arrival);
-				if (dst_arrivals.empty())
-					dst_arrivals = std::vector<int>(GetSize(dst_bit.wire), -1);
-				else
-					log_assert(GetSize(dst_arrivals) == GetSize(dst_bit.wire));
-				auto &dst_arrival = dst_arrivals[dst_bit.offset];
-				auto new_arrival = src_arrival + std::get<1>(d);
-				if (dst_arrival < new_arrival) {
-					auto dst_wire = dst_bit.wire;
-					dst_arrival = std::max(dst_arrival, new_arrival);
-					dst_wire->set_intvec_attribute(ID::sta_arrival, dst_arrivals);
-					queue.emplace_back(dst_bit);
+		graph.update();
+		annotate();
 
-					data[dst_bit].backtrack = b;
-					data[dst_bit].src_port = std::get<2>(d);
-
-					auto it = endpoints.find(dst_bit);
-					if (it != endpoints.end())
-						new_arrival += it->second.required;
-					if (new_arrival > maxarrival && driven.count(b)) {
-						maxarrival = new_arrival;
-						maxbit = dst_bit;
-					}
-				}
-			}
-		}
-
-		auto b = maxbit;
-		if (b == SigBit()) {
+		auto paths = graph.critical_paths(num_paths);
+		if (paths.empty()) {
 			log("No timing paths found.\n");
 			return;
 		}
 
-		log("Latest arrival time in '%s' is %d:\n", log_id(module), maxarrival);
-		auto it = endpoints.find(maxbit);
-		if (it != endpoints.end() && it->second.sink)
-			log("  %6d %s (%s.%s)\n", maxarrival, log_id(it->second.sink), log_id(it->second.sink->type), log_id(it->second.port));
-		else {
-			log("  %6d (%s)\n", maxarrival, b.wire->port_output ? "<primary output>" : "<unknown>");
-			if (!b.wire->port_output)
-				log_warning("Critical-path does not terminate in a recognised endpoint.\n");
-		}
-		auto jt = data.find(b);
-		while (jt != data.end()) {
-			int arrival = b.wire->get_intvec_attribute(ID::sta_arrival)[b.offset];
-			if (jt->second.driver) {
-				log("           %s\n", log_signal(b));
-				log("  %6d %s (%s.%s->%s)\n", arrival, log_id(jt->second.driver), log_id(jt->second.driver->type), log_id(jt->second.src_port), log_id(jt->second.dst_port));
+		log("Latest arrival time in '%s' is %d:\n", log_id(module), paths.front().arrival);
+		for (int i = 0; i < GetSize(paths); i++) {
+			if (num_paths > 1) {
+				const auto &clock = paths[i].launch_clock;
+				log("\nPath %d, launched by %s:\n", i + 1, clock == SigBit() ? "primary inputs" : log_signal(clock));
 			}
-			else if (b.wire->port_input)
-				log("  %6d   %s (%s)\n", arrival, log_signal(b), "<primary input>");
-			else
-				log_abort();
-			b = jt->second.backtrack;
-			jt = data.find(b);
+			log_path(paths[i]);
 		}
 
 		std::map<int, unsigned> arrival_histogram;
-		for (const auto &i : endpoints) {
+		for (const auto &i : graph.nodes) {
 			const auto &b = i.first;
-			if (!driven.count(b))
-				continue;
-
-			if (!b.wire->attributes.count(ID::sta_arrival)) {
-				log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
+			const auto *endpoint = i.second.worst_endpoint();
+			if (!endpoint || !graph.is_driven(b))
 				continue;
-			}
 
-			auto arrival = b.wire->get_intvec_attribute(ID::sta_arrival)[b.offset];
+			auto arrival = i.second.max_arrival();
 			if (arrival < 0) {
 				log_warning("Endpoint %s.%s has no (* sta_arrival *) value.\n", log_id(module), log_signal(b));
 				continue;
 			}
-			arrival += i.second.required;
+			arrival += endpoint->required;
 			arrival_histogram[arrival]++;
 		}
 		// Adapted from https://github.com/YosysHQ/nextpnr/blob/affb12cc27ebf409eade062c4c59bb98569d8147/common/timing.cc#L946-L969
@@ -284,29 +158,36 @@ struct StaPass : public Pass {
 		log("This command performs static timing analysis on the design. (Only considers\n");
 		log("paths within a single module, so the design must be flattened.)\n");
 		log("\n");
+		log("Arrival times are tracked separately for each launching clock, and the\n");
+		log("arrival time of each net is stored in the (* sta_arrival *) wire attribute.\n");
+		log("\n");
+		log("    -paths <N>\n");
+		log("        report the N latest paths, at most one for each end point and\n");
+		log("        launching clock (default: 1)\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		log_header(design, "Executing STA pass (static timing analysis).\n");
 
-		/*
+		int num_paths = 1;
+
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
-			if (args[argidx] == "-TODO") {
+			if (args[argidx] == "-paths" && argidx+1 < args.size()) {
+				num_paths = std::max(1, atoi(args[++argidx].c_str()));
 				continue;
 			}
 			break;
 		}
-		*/
-
-		extra_args(args, 1, design);
+		extra_args(args, argidx, design);
 
 		for (Module *module : design->selected_modules())
 		{
 			if (module->has_processes_warn())
 				continue;
 
-			StaWorker worker(module);
+			StaWorker worker(module, num_paths);
 			worker.run();
 		}
 	}
@@ -170,7 +170,7 @@ struct MemQueryCache
 	// sel signal is constant under the assumption that this read port
 	// is active and a given other mux sel signal is true.
 	bool walk_up_mux_cond(SigBit sel, bool neg_sel, SigBit &bit) {
-		auto &drivers = qcsat.modwalker.signal_drivers[qcsat.modwalker.sigmap(bit)];
+		auto &drivers = qcsat.modwalker->signal_drivers[qcsat.sigmap(bit)];
 		if (GetSize(drivers) != 1)
 			return false;
 		auto driver = *drivers.begin();
@@ -206,11 +206,11 @@ struct MemQueryCache
 	// The walk_up_mux_cond part is necessary because write ports in yosys
 	// tend to be connected to things like (wen ? wdata : 'x).
 	bool data_eq(SigBit sel, bool neg_sel, SigBit dbit, SigBit odbit) {
-		if (qcsat.modwalker.sigmap(dbit) == qcsat.modwalker.sigmap(odbit))
+		if (qcsat.sigmap(dbit) == qcsat.sigmap(odbit))
 			return true;
 		while (walk_up_mux_cond(sel, neg_sel, dbit));
 		while (walk_up_mux_cond(sel, neg_sel, odbit));
-		return qcsat.modwalker.sigmap(dbit) == qcsat.modwalker.sigmap(odbit);
+		return qcsat.sigmap(dbit) == qcsat.sigmap(odbit);
 	}
 };
 
@@ -131,12 +131,12 @@ typedef std::vector<MemConfig> MemConfigs;
 
 struct MapWorker {
 	Module *module;
-	ModWalker modwalker;
+	ModConnIndex connindex;
 	SigMap sigmap;
 	SigMap sigmap_xmux;
 	FfInitVals initvals;
 
-	MapWorker(Module *module) : module(module), modwalker(module->design, module), sigmap(module), sigmap_xmux(module), initvals(&sigmap, module) {
+	MapWorker(Module *module) : module(module), connindex(module), sigmap(module), sigmap_xmux(module), initvals(&sigmap, module) {
 		for (auto cell : module->cells())
 		{
 			if (cell->type == ID($mux))
@@ -184,14 +184,20 @@ struct MemMapping {
 	dict<std::pair<int, int>, bool> wr_excludes_rd_cache;
 	dict<std::pair<int, int>, bool> wr_excludes_srst_cache;
 	std::string rejected_cfg_debug_msgs;
+	// Distinct clock signals of the ports, in the order they were first seen by signature().
+	std::vector<SigBit> clock_classes;
 
-	MemMapping(MapWorker &worker, Mem &mem, const Library &lib, const PassOptions &opts) : worker(worker), qcsat(worker.modwalker), mem(mem), lib(lib), opts(opts) {
+	MemMapping(MapWorker &worker, Mem &mem, const Library &lib, const PassOptions &opts) : worker(worker), qcsat(worker.connindex), mem(mem), lib(lib), opts(opts) {
 		determine_style();
 		logic_ok = determine_logic_ok();
 		if (GetSize(mem.wr_ports) == 0)
 			logic_cost = mem.width * mem.size * opts.logic_cost_rom;
 		else
 			logic_cost = mem.width * mem.size * opts.logic_cost_ram;
+	}
+
+	// Enumerate and score all candidate configs.
+	void run() {
 		if (kind == RamKind::Logic)
 			return;
 		for (int i = 0; i < GetSize(lib.rams); i++) {
@@ -295,6 +301,7 @@ struct MemMapping {
 		return res;
 	}
 
+	std::string signature();
 	void dump_configs(int stage);
 	void dump_config(MemConfig &cfg);
 	void determine_style();
@@ -367,6 +374,65 @@ struct MemMapping {
 	}
 };
 
+// Describes everything about the memory that run() looks at, except for the SAT
+// queries on enable and reset signals, which MemMappingCache checks separately.
+// Signals are only described by how they relate to each other.
+std::string MemMapping::signature() {
+	auto clock_class = [&](SigBit clk) {
+		for (int i = 0; i < GetSize(clock_classes); i++)
+			if (clock_classes[i] == clk)
+				return i;
+		clock_classes.push_back(clk);
+		return GetSize(clock_classes) - 1;
+	};
+	auto sig_pattern = [](const SigSpec &sig) {
+		std::string res;
+		dict<SigBit, int> seen;
+		for (auto bit : sig) {
+			if (bit.wire == nullptr)
+				res += stringf("c%d,", bit.data);
+			else
+				res += stringf("%d,", seen.insert(std::make_pair(bit, GetSize(seen))).first->second);
+		}
+		return res;
+	};
+	auto mask_str = [](const std::vector<bool> &mask) {
+		std::string res;
+		for (bool b : mask)
+			res += b ? '1' : '0';
+		return res;
+	};
+
+	bool has_nonx = false, has_one = false;
+	for (auto &init: mem.inits) {
+		if (init.data.is_fully_undef())
+			continue;
+		has_nonx = true;
+		for (auto bit: init.data)
+			if (bit == State::S1)
+				has_one = true;
+	}
+
+	std::string res = stringf("%d %d %d %d %s %d %d|", mem.width, mem.size, mem.start_offset,
+			int(kind), style.c_str(), has_nonx, has_one);
+	for (auto &port: mem.wr_ports)
+		res += stringf("W %d %d %d %d %s %s|", port.clk_enable, port.clk_polarity, clock_class(port.clk),
+				port.wide_log2, sig_pattern(port.en).c_str(), mask_str(port.priority_mask).c_str());
+	for (auto &port: mem.rd_ports) {
+		res += stringf("R %d %d %d %d %d %d ", port.clk_enable, port.clk_polarity,
+				clock_class(port.clk), port.wide_log2, port.ce_over_srst, GetSize(port.data));
+		res += stringf("%s %s %s ", sig_pattern(port.en).c_str(), sig_pattern(port.arst).c_str(),
+				sig_pattern(port.srst).c_str());
+		res += stringf("%s %s %s ", port.init_value.as_string().c_str(), port.arst_value.as_string().c_str(),
+				port.srst_value.as_string().c_str());
+		res += stringf("%s %s|", mask_str(port.transparency_mask).c_str(), mask_str(port.collision_x_mask).c_str());
+	}
+	for (int i = 0; i < GetSize(mem.wr_ports); i++)
+		for (int j = 0; j < GetSize(mem.rd_ports); j++)
+			res += addr_compatible(i, j) ? '1' : '0';
+	return res;
+}
+
 void MemMapping::dump_configs(int stage) {
 	const char *stage_name;
 	switch (stage) {
@@ -2148,6 +2214,92 @@ void MemMapping::emit(const MemConfig &cfg) {
 	mem.remove();
 }
 
+// Mapping decisions for the memories already processed by this pass invocation,
+// keyed by MemMapping::signature().  The config search only depends on the
+// signature and on the answers to its SAT queries, so a previous result can be
+// reused if the same queries give the same answers on the new memory.
+struct MemMappingCache {
+	struct Entry {
+		IdString module, memid;
+		dict<std::pair<int, int>, bool> wr_implies_rd;
+		dict<std::pair<int, int>, bool> wr_excludes_rd;
+		dict<std::pair<int, int>, bool> wr_excludes_srst;
+		std::vector<MemConfig> cfgs;
+		// Index into MemMapping::clock_classes of each used shared clock, or -1.
+		std::vector<std::vector<int>> clock_class;
+		std::string rejected_cfg_debug_msgs;
+	};
+
+	// Bounds the number of replays for signatures that keep missing.
+	static const int max_entries = 4;
+
+	dict<std::string, std::vector<Entry>> entries;
+	int lookups = 0, hits = 0;
+
+	bool lookup(const std::string &sig, MemMapping &map) {
+		lookups++;
+		auto it = entries.find(sig);
+		if (it == entries.end())
+			return false;
+		for (auto &entry : it->second) {
+			bool match = true;
+			for (auto &q : entry.wr_implies_rd)
+				if (match && map.get_wr_implies_rd(q.first.first, q.first.second) != q.second)
+					match = false;
+			for (auto &q : entry.wr_excludes_rd)
+				if (match && map.get_wr_excludes_rd(q.first.first, q.first.second) != q.second)
+					match = false;
+			for (auto &q : entry.wr_excludes_srst)
+				if (match && map.get_wr_excludes_srst(q.first.first, q.first.second) != q.second)
+					match = false;
+			if (!match)
+				continue;
+			log_debug("memory %s.%s: reusing mapping candidates of memory %s.%s\n", log_id(map.mem.module->name),
+					log_id(map.mem.memid), log_id(entry.module), log_id(entry.memid));
+			map.cfgs = entry.cfgs;
+			for (int i = 0; i < GetSize(map.cfgs); i++)
+				for (int j = 0; j < GetSize(map.cfgs[i].shared_clocks); j++) {
+					int cls = entry.clock_class[i][j];
+					map.cfgs[i].shared_clocks[j].clk = cls < 0 ? SigBit() : map.clock_classes[cls];
+				}
+			map.rejected_cfg_debug_msgs = entry.rejected_cfg_debug_msgs;
+			hits++;
+			return true;
+		}
+		return false;
+	}
+
+	void insert(const std::string &sig, MemMapping &map) {
+		auto &list = entries[sig];
+		if (GetSize(list) >= max_entries)
+			return;
+		Entry entry;
+		entry.module = map.mem.module->name;
+		entry.memid = map.mem.memid;
+		entry.wr_implies_rd = map.wr_implies_rd_cache;
+		entry.wr_excludes_rd = map.wr_excludes_rd_cache;
+		entry.wr_excludes_srst = map.wr_excludes_srst_cache;
+		entry.cfgs = map.cfgs;
+		for (auto &cfg : map.cfgs) {
+			std::vector<int> classes;
+			for (auto &clk : cfg.shared_clocks) {
+				int cls = -1;
+				if (clk.used)
+					for (int i = 0; i < GetSize(map.clock_classes); i++)
+						if (map.clock_classes[i] == clk.clk) {
+							cls = i;
+							break;
+						}
+				log_assert(!clk.used || cls != -1);
+				classes.push_back(cls);
+			}
+			entry.clock_class.push_back(classes);
+		}
+		entry.rejected_cfg_debug_msgs = map.rejected_cfg_debug_msgs;
+		list.push_back(entry);
+	}
+};
+
 struct MemoryLibMapPass : public Pass {
 	MemoryLibMapPass() : Pass("memory_libmap", "map memories to cells") { }
 	void help() override
@@ -2179,6 +2331,11 @@ struct MemoryLibMapPass : public Pass {
 		log("    Disables automatic mapping of given kind of RAMs.  Manual mapping\n");
 		log("    (using ram_style or other attributes) is still supported.\n");
 		log("\n");
+		log("  -no-cache\n");
+		log("    By default, the mapping candidates found for a memory are reused for\n");
+		log("    later memories with the same ports, geometry and enable relations.\n");
+		log("    This option disables the reuse and searches every memory from scratch.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -2190,6 +2347,7 @@ struct MemoryLibMapPass : public Pass {
 		opts.no_auto_huge = false;
 		opts.logic_cost_ram = 1.0;
 		opts.logic_cost_rom = 1.0/16.0;
+		bool use_cache = true;
 		log_header(design, "Executing MEMORY_LIBMAP pass (mapping memories to cells).\n");
 
 		size_t argidx;
@@ -2214,6 +2372,10 @@ struct MemoryLibMapPass : public Pass {
 				opts.no_auto_huge = true;
 				continue;
 			}
+			if (args[argidx] == "-no-cache") {
+				use_cache = false;
+				continue;
+			}
 			if (args[argidx] == "-logic-cost-rom" && argidx+1 < args.size()) {
 				opts.logic_cost_rom = strtod(args[++argidx].c_str(), nullptr);
 				continue;
@@ -2227,6 +2389,7 @@ struct MemoryLibMapPass : public Pass {
 		extra_args(args, argidx, design);
 
 		Library lib = parse_library(lib_files, defines);
+		MemMappingCache cache;
 
 		for (auto module : design->selected_modules()) {
 			if (module->has_processes_warn())
@@ -2237,6 +2400,15 @@ struct MemoryLibMapPass : public Pass {
 			for (auto &mem : mems)
 			{
 				MemMapping map(*worker, mem, lib, opts);
+				if (use_cache && map.kind != RamKind::Logic) {
+					std::string sig = map.signature();
+					if (!cache.lookup(sig, map)) {
+						map.run();
+						cache.insert(sig, map);
+					}
+				} else {
+					map.run();
+				}
 				int idx = -1;
 				int best = map.logic_cost;
 				if (!map.logic_ok) {
@@ -2263,6 +2435,10 @@ struct MemoryLibMapPass : public Pass {
 				}
 			}
 		}
+
+		if (cache.hits > 0)
+			log("Reused mapping candidates for %d out of %d memories (%d distinct signatures).\n",
+					cache.hits, cache.lookups, GetSize(cache.entries));
 	}
 } MemoryLibMapPass;
 
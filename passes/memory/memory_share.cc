@@ -32,7 +32,7 @@ struct MemoryShareWorker
 	RTLIL::Design *design;
 	RTLIL::Module *module;
 	SigMap sigmap, sigmap_xmux;
-	ModWalker modwalker;
+	ModConnIndex connindex;
 	FfInitVals initvals;
 	bool flag_widen;
 	bool flag_sat;
@@ -304,7 +304,7 @@ struct MemoryShareWorker
 
 		for (int i = 0; i < GetSize(mem.wr_ports); i++) {
 			auto &port = mem.wr_ports[i];
-			std::vector<RTLIL::SigBit> bits = modwalker.sigmap(port.en);
+			std::vector<RTLIL::SigBit> bits = connindex.sigmap(port.en);
 			for (auto bit : bits)
 				if (bit == RTLIL::State::S1)
 					goto port_is_always_active;
@@ -378,7 +378,7 @@ struct MemoryShareWorker
 
 			// Okay, time to actually run the SAT solver.
 
-			QuickConeSat qcsat(modwalker);
+			QuickConeSat qcsat(connindex);
 
 			// create SAT representation of common input cone of all considered EN signals
 
@@ -417,11 +417,11 @@ struct MemoryShareWorker
 
 					RTLIL::SigSpec last_addr = port1.addr;
 					RTLIL::SigSpec last_data = port1.data;
-					std::vector<RTLIL::SigBit> last_en = modwalker.sigmap(port1.en);
+					std::vector<RTLIL::SigBit> last_en = connindex.sigmap(port1.en);
 
 					RTLIL::SigSpec this_addr = port2.addr;
 					RTLIL::SigSpec this_data = port2.data;
-					std::vector<RTLIL::SigBit> this_en = modwalker.sigmap(port2.en);
+					std::vector<RTLIL::SigBit> this_en = connindex.sigmap(port2.en);
 
 					RTLIL::SigBit this_en_active = module->ReduceOr(NEW_ID, this_en);
 
@@ -468,7 +468,7 @@ struct MemoryShareWorker
 	// Setup and run
 	// -------------
 
-	MemoryShareWorker(RTLIL::Design *design, bool flag_widen, bool flag_sat) : design(design), modwalker(design), flag_widen(flag_widen), flag_sat(flag_sat) {}
+	MemoryShareWorker(RTLIL::Design *design, bool flag_widen, bool flag_sat) : design(design), connindex(design), flag_widen(flag_widen), flag_sat(flag_sat) {}
 
 	void operator()(RTLIL::Module* module)
 	{
@@ -501,7 +501,7 @@ struct MemoryShareWorker
 		if (!flag_sat)
 			return;
 
-		modwalker.setup(module);
+		connindex.build(module);
 
 		for (auto &mem : memories)
 			consolidate_wr_using_sat(mem);
@@ -623,6 +623,10 @@ void rmunused_module(RTLIL::Module *module, bool purge_mode, bool verbose, bool
 
 	if (rminit && rmunused_module_init(module, verbose))
 		while (rmunused_module_signals(module, purge_mode, verbose)) { }
+
+	int freed_slabs = module->compact_arena();
+	if (verbose && freed_slabs > 0)
+		log_debug("  released %d empty arena slabs.\n", freed_slabs);
 }
 
 struct OptCleanPass : public Pass {
@@ -735,11 +735,11 @@ struct OptDffWorker
 	}
 
 	bool run_constbits() {
-		ModWalker modwalker(module->design, module);
-		QuickConeSat qcsat(modwalker);
+		ModConnIndex connindex(module);
+		QuickConeSat qcsat(connindex);
 
 		// Defer mutating cells by removing them/emiting new flip flops so that
-		// cell references in modwalker are not invalidated
+		// cell references in connindex are not invalidated
 		std::vector<RTLIL::Cell*> cells_to_remove;
 		std::vector<FfData> ffs_to_emit;
 
@@ -774,7 +774,7 @@ struct OptDffWorker
 						if (!opt.sat)
 							continue;
 						// For each register bit, try to prove that it cannot change from the initial value. If so, remove it
-						if (!modwalker.has_drivers(ff.sig_d.extract(i)))
+						if (!connindex.has_drivers(ff.sig_d.extract(i)))
 							continue;
 						if (val != State::S0 && val != State::S1)
 							continue;
@@ -802,7 +802,7 @@ struct OptDffWorker
 						if (!opt.sat)
 							continue;
 						// For each register bit, try to prove that it cannot change from the initial value. If so, remove it
-						if (!modwalker.has_drivers(ff.sig_ad.extract(i)))
+						if (!connindex.has_drivers(ff.sig_ad.extract(i)))
 							continue;
 						if (val != State::S0 && val != State::S1)
 							continue;
@@ -44,14 +44,14 @@ struct OptMemPriorityPass : public Pass {
 		log_header(design, "Executing OPT_MEM_PRIORITY pass (removing unnecessary memory write priority relations).\n");
 		extra_args(args, 1, design);
 
-		ModWalker modwalker(design);
+		ModConnIndex connindex(design);
 
 		int total_count = 0;
 		for (auto module : design->selected_modules()) {
-			modwalker.setup(module);
+			connindex.build(module);
 			for (auto &mem : Mem::get_selected_memories(module)) {
 				bool mem_changed = false;
-				QuickConeSat qcsat(modwalker);
+				QuickConeSat qcsat(connindex);
 				for (int i = 0; i < GetSize(mem.wr_ports); i++) {
 					auto &wport1 = mem.wr_ports[i];
 					for (int j = 0; j < GetSize(mem.wr_ports); j++) {
@@ -359,9 +359,46 @@ with open(outfile, "w") as f:
         print("YOSYS_NAMESPACE_BEGIN", file=f)
         print("", file=f)
 
-    print("struct {}_pm {{".format(prefix), file=f)
+    print("#ifndef PMGEN_MODULE_INDEX", file=f)
+    print("#define PMGEN_MODULE_INDEX", file=f)
+    print("// Pattern independent data about a module, can be shared by several matchers", file=f)
+    print("// as long as the module is not modified in between.", file=f)
+    print("struct pmgen_module_index {", file=f)
     print("  Module *module;", file=f)
     print("  SigMap sigmap;", file=f)
+    print("  dict<SigBit, pool<Cell*>> sigusers;", file=f)
+    print("  bool sigusers_done;", file=f)
+    print("", file=f)
+    print("  pmgen_module_index(Module *module) : module(module), sigmap(module), sigusers_done(false) {", file=f)
+    print("  }", file=f)
+    print("", file=f)
+    print("  void add_siguser(const SigSpec &sig, Cell *cell) {", file=f)
+    print("    for (auto bit : sigmap(sig)) {", file=f)
+    print("      if (bit.wire == nullptr) continue;", file=f)
+    print("      sigusers[bit].insert(cell);", file=f)
+    print("    }", file=f)
+    print("  }", file=f)
+    print("", file=f)
+    print("  void setup_sigusers() {", file=f)
+    print("    if (sigusers_done)", file=f)
+    print("      return;", file=f)
+    print("    sigusers_done = true;", file=f)
+    print("    for (auto port : module->ports)", file=f)
+    print("      add_siguser(module->wire(port), nullptr);", file=f)
+    print("    for (auto cell : module->cells())", file=f)
+    print("      for (auto &conn : cell->connections())", file=f)
+    print("        add_siguser(conn.second, cell);", file=f)
+    print("  }", file=f)
+    print("};", file=f)
+    print("#endif", file=f)
+    print("", file=f)
+
+    print("struct {}_pm {{".format(prefix), file=f)
+    print("  std::unique_ptr<pmgen_module_index> own_modindex;", file=f)
+    print("  pmgen_module_index &modindex;", file=f)
+    print("  Module *module;", file=f)
+    print("  SigMap &sigmap;", file=f)
+    print("  dict<SigBit, pool<Cell*>> &sigusers;", file=f)
     print("  std::function<void()> on_accept;", file=f)
     print("  bool setup_done;", file=f)
     print("  bool generate_mode;", file=f)
@@ -394,7 +431,6 @@ with open(outfile, "w") as f:
             print("  typedef std::tuple<{}> index_{}_key_type;".format(", ".join(index_types), index), file=f)
             print("  typedef std::tuple<{}> index_{}_value_type;".format(", ".join(value_types), index), file=f)
             print("  dict<index_{}_key_type, vector<index_{}_value_type>> index_{};".format(index, index, index), file=f)
-    print("  dict<SigBit, pool<Cell*>> sigusers;", file=f)
     print("  pool<Cell*> blacklist_cells;", file=f)
     print("  pool<Cell*> autoremove_cells;", file=f)
     print("  dict<Cell*,int> rollback_cache;", file=f)
@@ -423,10 +459,7 @@ with open(outfile, "w") as f:
     print("", file=f)
 
     print("  void add_siguser(const SigSpec &sig, Cell *cell) {", file=f)
-    print("    for (auto bit : sigmap(sig)) {", file=f)
-    print("      if (bit.wire == nullptr) continue;", file=f)
-    print("      sigusers[bit].insert(cell);", file=f)
-    print("    }", file=f)
+    print("    modindex.add_siguser(sig, cell);", file=f)
     print("  }", file=f)
     print("", file=f)
 
@@ -483,13 +516,26 @@ with open(outfile, "w") as f:
     print("", file=f)
 
     print("  {}_pm(Module *module, const vector<Cell*> &cells) :".format(prefix), file=f)
-    print("      module(module), sigmap(module), setup_done(false), generate_mode(false), rngseed(12345678) {", file=f)
+    print("      {}_pm(module) {{".format(prefix), file=f)
     print("    setup(cells);", file=f)
     print("  }", file=f)
     print("", file=f)
 
     print("  {}_pm(Module *module) :".format(prefix), file=f)
-    print("      module(module), sigmap(module), setup_done(false), generate_mode(false), rngseed(12345678) {", file=f)
+    print("      own_modindex(new pmgen_module_index(module)), modindex(*own_modindex), module(module), sigmap(modindex.sigmap),", file=f)
+    print("      sigusers(modindex.sigusers), setup_done(false), generate_mode(false), rngseed(12345678) {", file=f)
+    print("  }", file=f)
+    print("", file=f)
+
+    print("  {}_pm(pmgen_module_index &modindex, const vector<Cell*> &cells) :".format(prefix), file=f)
+    print("      {}_pm(modindex) {{".format(prefix), file=f)
+    print("    setup(cells);", file=f)
+    print("  }", file=f)
+    print("", file=f)
+
+    print("  {}_pm(pmgen_module_index &modindex) :".format(prefix), file=f)
+    print("      modindex(modindex), module(modindex.module), sigmap(modindex.sigmap),", file=f)
+    print("      sigusers(modindex.sigusers), setup_done(false), generate_mode(false), rngseed(12345678) {", file=f)
     print("  }", file=f)
     print("", file=f)
 
@@ -503,11 +549,7 @@ with open(outfile, "w") as f:
     current_pattern = None
     print("    log_assert(!setup_done);", file=f)
     print("    setup_done = true;", file=f)
-    print("    for (auto port : module->ports)", file=f)
-    print("      add_siguser(module->wire(port), nullptr);", file=f)
-    print("    for (auto cell : module->cells())", file=f)
-    print("      for (auto &conn : cell->connections())", file=f)
-    print("        add_siguser(conn.second, cell);", file=f)
+    print("    modindex.setup_sigusers();", file=f)
     print("    for (auto cell : cells) {", file=f)
 
     for index in range(len(blocks)):
@@ -20,6 +20,8 @@
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 
+#include <chrono>
+
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
@@ -144,6 +146,16 @@ struct TestPmgenPass : public Pass {
 		log("\n");
 		log("Create modules that match the specified pattern.\n");
 		log("\n");
+
+		log("\n");
+		log("    test_pmgen -benchmark [-iter <N>] [selection]\n");
+		log("\n");
+		log("Run the reduce, eqpmux, ice40_dsp and xilinx_srl matchers on the selected\n");
+		log("modules without modifying them, once with a separate module index per\n");
+		log("matcher and once with a single pmgen_module_index shared by all matchers,\n");
+		log("and report the number of matches and the time taken for both. With -iter,\n");
+		log("every measurement is repeated N times.\n");
+		log("\n");
 	}
 
 	void execute_reduce_chain(std::vector<std::string> args, RTLIL::Design *design)
@@ -239,6 +251,65 @@ struct TestPmgenPass : public Pass {
 		log_cmd_error("Unknown pattern: %s\n", pattern.c_str());
 	}
 
+	// Runs all matchers once in search-only mode and returns the total number of matches.
+	template<typename F>
+	static int benchmark_matchers(F make_pm_args)
+	{
+		int matches = 0;
+		matches += make_pm_args([](auto &&...pm_args) { return test_pmgen_pm(pm_args...).run_reduce(); });
+		matches += make_pm_args([](auto &&...pm_args) { return test_pmgen_pm(pm_args...).run_eqpmux(); });
+		matches += make_pm_args([](auto &&...pm_args) { return ice40_dsp_pm(pm_args...).run_ice40_dsp(); });
+		matches += make_pm_args([](auto &&...pm_args) { return xilinx_srl_pm(pm_args...).run_fixed(); });
+		matches += make_pm_args([](auto &&...pm_args) { return xilinx_srl_pm(pm_args...).run_variable(); });
+		return matches;
+	}
+
+	void execute_benchmark(std::vector<std::string> args, RTLIL::Design *design)
+	{
+		log_header(design, "Executing TEST_PMGEN pass (-benchmark).\n");
+
+		int iterations = 1;
+
+		size_t argidx;
+		for (argidx = 2; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-iter" && argidx+1 < args.size()) {
+				iterations = std::max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		for (auto module : design->selected_modules())
+		{
+			vector<Cell*> cells = module->selected_cells();
+			int separate_matches = 0, shared_matches = 0;
+
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+				separate_matches = benchmark_matchers([&](auto run) { return run(module, cells); });
+			double separate_time = seconds_since(start);
+
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				pmgen_module_index modindex(module);
+				shared_matches = benchmark_matchers([&](auto run) { return run(modindex, cells); });
+			}
+			double shared_time = seconds_since(start);
+
+			if (separate_matches != shared_matches)
+				log_error("Module %s: %d matches with separate indices, but %d with a shared index.\n",
+						log_id(module), separate_matches, shared_matches);
+			log("Module %s: %d cells, %d matches, separate indices %.3f s, shared index %.3f s.\n",
+					log_id(module), GetSize(cells), shared_matches, separate_time / iterations, shared_time / iterations);
+		}
+	}
+
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		if (GetSize(args) > 1)
@@ -251,6 +322,8 @@ struct TestPmgenPass : public Pass {
 				return execute_eqpmux(args, design);
 			if (args[1] == "-generate")
 				return execute_generate(args, design);
+			if (args[1] == "-benchmark")
+				return execute_benchmark(args, design);
 		}
 		help();
 		log_cmd_error("Missing or unsupported mode parameter.\n");
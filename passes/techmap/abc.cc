@@ -65,9 +65,19 @@
 #include "frontends/blif/blifparse.h"
 
 #ifdef YOSYS_LINK_ABC
+#include "base/abc/abc.h"
+#include "base/main/main.h"
+#include "base/cmd/cmd.h"
+#include "map/mio/mio.h"
+#include "map/if/if.h"
 namespace abc {
 	int Abc_RealMain(int argc, char *argv[]);
 }
+#if defined(__wasm)
+#define fd_renumber(from, to) (void)__wasi_fd_renumber(from, to)
+#else
+#define fd_renumber(from, to) dup2(from, to)
+#endif
 #endif
 
 USING_YOSYS_NAMESPACE
@@ -113,6 +123,7 @@ bool map_mux8;
 bool map_mux16;
 
 bool markgroups;
+bool in_memory_abc;
 int map_autoidx;
 SigMap assign_map;
 RTLIL::Module *module;
@@ -578,6 +589,32 @@ void handle_loops()
 		fclose(dot_f);
 }
 
+// Covers (in BLIF .names notation) of the combinational gates extracted by
+// extract_cell(). Shared by the input.blif writer and the in-memory network
+// builder so that both hand the same functions to ABC.
+const char *gate_cover(gate_type_t type)
+{
+	switch (type) {
+		case G(BUF):    return "1 1\n";
+		case G(NOT):    return "0 1\n";
+		case G(AND):    return "11 1\n";
+		case G(NAND):   return "0- 1\n-0 1\n";
+		case G(OR):     return "-1 1\n1- 1\n";
+		case G(NOR):    return "00 1\n";
+		case G(XOR):    return "01 1\n10 1\n";
+		case G(XNOR):   return "00 1\n11 1\n";
+		case G(ANDNOT): return "10 1\n";
+		case G(ORNOT):  return "1- 1\n-0 1\n";
+		case G(MUX):    return "1-0 1\n-11 1\n";
+		case G(NMUX):   return "0-0 1\n-01 1\n";
+		case G(AOI3):   return "-00 1\n0-0 1\n";
+		case G(OAI3):   return "00- 1\n--0 1\n";
+		case G(AOI4):   return "-0-0 1\n-00- 1\n0--0 1\n0-0- 1\n";
+		case G(OAI4):   return "00-- 1\n--00 1\n";
+		default:        return nullptr;
+	}
+}
+
 std::string add_echos_to_abc_cmd(std::string str)
 {
 	std::string new_str, token;
@@ -624,7 +661,7 @@ std::string replace_tempdir(std::string text, std::string tempdir_name, bool sho
 	if (show_tempdir)
 		return text;
 
-	while (1) {
+	while (!tempdir_name.empty()) {
 		size_t pos = text.find(tempdir_name);
 		if (pos == std::string::npos)
 			break;
@@ -703,6 +740,279 @@ struct abc_output_filter
 	}
 };
 
+#ifdef YOSYS_LINK_ABC
+// Builds the same logic network that `read_blif` would construct from the
+// input.blif written by abc_module(), directly from signal_list.
+abc::Abc_Ntk_t *abc_build_network()
+{
+	using namespace abc;
+
+	Abc_Ntk_t *ntk = Abc_NtkAlloc(ABC_NTK_LOGIC, ABC_FUNC_SOP, 1);
+	ntk->pName = Abc_UtilStrsav((char*)"netlist");
+
+	std::vector<Abc_Obj_t*> objs(GetSize(signal_list)), latch_inputs(GetSize(signal_list));
+	char name[32];
+
+	int count_input = 0;
+	for (auto &si : signal_list) {
+		if (!si.is_port || si.type != G(NONE))
+			continue;
+		snprintf(name, sizeof(name), "ys__n%d", si.id);
+		objs[si.id] = Abc_NtkCreatePi(ntk);
+		Abc_ObjAssignName(objs[si.id], name, nullptr);
+		count_input++;
+	}
+	if (count_input == 0)
+		Abc_ObjAssignName(Abc_NtkCreatePi(ntk), (char*)"dummy_input", nullptr);
+
+	for (auto &si : signal_list) {
+		if (si.type == G(NONE)) {
+			if (objs[si.id] == nullptr)
+				objs[si.id] = si.bit == RTLIL::State::S1 ? Abc_NtkCreateNodeConst1(ntk) : Abc_NtkCreateNodeConst0(ntk);
+		} else if (si.type == G(FF) || si.type == G(FF0) || si.type == G(FF1)) {
+			Abc_Obj_t *latch = Abc_NtkCreateLatch(ntk);
+			latch_inputs[si.id] = Abc_NtkCreateBi(ntk);
+			objs[si.id] = Abc_NtkCreateBo(ntk);
+			Abc_ObjAddFanin(latch, latch_inputs[si.id]);
+			Abc_ObjAddFanin(objs[si.id], latch);
+			if (si.type == G(FF0))
+				Abc_LatchSetInit0(latch);
+			else if (si.type == G(FF1))
+				Abc_LatchSetInit1(latch);
+			else
+				Abc_LatchSetInitDc(latch);
+			snprintf(name, sizeof(name), "ys__n%d", si.id);
+			Abc_ObjAssignName(objs[si.id], name, nullptr);
+			Abc_ObjAssignName(latch_inputs[si.id], name, (char*)"_in");
+		} else
+			objs[si.id] = Abc_NtkCreateNode(ntk);
+	}
+
+	for (auto &si : signal_list) {
+		if (si.type == G(NONE))
+			continue;
+		if (latch_inputs[si.id] != nullptr) {
+			Abc_ObjAddFanin(latch_inputs[si.id], objs[si.in1]);
+			continue;
+		}
+		const char *cover = gate_cover(si.type);
+		log_assert(cover != nullptr);
+		int inputs[4] = {si.in1, si.in2, si.in3, si.in4};
+		for (int i = 0; i < int(strchr(cover, ' ') - cover); i++)
+			Abc_ObjAddFanin(objs[si.id], objs[inputs[i]]);
+		objs[si.id]->pData = Abc_SopRegister((Mem_Flex_t*)ntk->pManFunc, (char*)cover);
+	}
+
+	for (auto &si : signal_list) {
+		if (!si.is_port || si.type == G(NONE))
+			continue;
+		snprintf(name, sizeof(name), "ys__n%d", si.id);
+		Abc_Obj_t *po = Abc_NtkCreatePo(ntk);
+		Abc_ObjAddFanin(po, objs[si.id]);
+		Abc_ObjAssignName(po, name, nullptr);
+	}
+
+	if (!Abc_NtkCheck(ntk))
+		log_error("ABC: the extracted network failed the consistency check.\n");
+	return ntk;
+}
+
+// Converts the mapped network to the module `parse_blif` would have created
+// from the output.blif written by ABC.
+RTLIL::Design *abc_read_network(abc::Abc_Ntk_t *ntk, RTLIL::IdString dff_name, bool sop_mode)
+{
+	using namespace abc;
+
+	Abc_Ntk_t *netlist = Abc_NtkToNetlist(ntk);
+	if (netlist == nullptr)
+		log_error("ABC: converting the mapped network to a netlist failed.\n");
+	if (!Abc_NtkHasMapping(netlist) && !Abc_NtkHasSop(netlist))
+		Abc_NtkToSop(netlist, -1, ABC_INFINITY);
+
+	RTLIL::Design *mapped_design = new RTLIL::Design;
+	RTLIL::Module *mapped_mod = mapped_design->addModule(ID(netlist));
+
+	auto net_wire = [&](Abc_Obj_t *net) -> RTLIL::Wire* {
+		RTLIL::IdString wire_name = RTLIL::escape_id(Abc_ObjName(net));
+		RTLIL::Wire *wire = mapped_mod->wire(wire_name);
+		return wire ? wire : mapped_mod->addWire(wire_name);
+	};
+
+	Abc_Obj_t *obj;
+	int i;
+
+	Abc_NtkForEachPi(netlist, obj, i)
+		net_wire(Abc_ObjFanout0(obj))->port_input = true;
+	Abc_NtkForEachPo(netlist, obj, i)
+		net_wire(Abc_ObjFanin0(obj))->port_output = true;
+
+	Abc_NtkForEachLatch(netlist, obj, i) {
+		RTLIL::Wire *d = net_wire(Abc_ObjFanin0(Abc_ObjFanin0(obj)));
+		RTLIL::Wire *q = net_wire(Abc_ObjFanout0(Abc_ObjFanout0(obj)));
+		if (Abc_LatchIsInit0(obj) || Abc_LatchIsInit1(obj))
+			q->attributes[ID::init] = RTLIL::Const(Abc_LatchIsInit1(obj) ? 1 : 0, 1);
+		RTLIL::Cell *cell = mapped_mod->addCell(NEW_ID, dff_name);
+		cell->setPort(ID::D, d);
+		cell->setPort(ID::Q, q);
+	}
+
+	bool has_mapping = Abc_NtkHasMapping(netlist);
+	Abc_NtkForEachNode(netlist, obj, i)
+	{
+		RTLIL::Wire *y = net_wire(Abc_ObjFanout0(obj));
+
+		if (has_mapping) {
+			Mio_Gate_t *gate = (Mio_Gate_t*)obj->pData;
+			RTLIL::Cell *cell = mapped_mod->addCell(NEW_ID, RTLIL::escape_id(Mio_GateReadName(gate)));
+			int k = 0;
+			for (Mio_Pin_t *pin = Mio_GateReadPins(gate); pin != nullptr; pin = Mio_PinReadNext(pin))
+				cell->setPort(RTLIL::escape_id(Mio_PinReadName(pin)), net_wire(Abc_ObjFanin(obj, k++)));
+			cell->setPort(RTLIL::escape_id(Mio_GateReadOutName(gate)), y);
+			continue;
+		}
+
+		RTLIL::SigSpec input_sig;
+		for (int k = 0; k < Abc_ObjFaninNum(obj); k++)
+			input_sig.append(net_wire(Abc_ObjFanin(obj, k)));
+		int width = GetSize(input_sig);
+
+		// Each cube is `width` input literals, a space, the output value and a newline.
+		const char *sop = (const char*)obj->pData;
+
+		if (width == 0) {
+			mapped_mod->connect(y, strchr(sop, '1') ? RTLIL::State::S1 : RTLIL::State::S0);
+			continue;
+		}
+
+		if (sop_mode) {
+			RTLIL::Const table;
+			int depth = 0;
+			for (const char *cube = sop; *cube; cube += width + 3, depth++)
+				for (int k = 0; k < width; k++) {
+					table.bits().push_back(cube[k] == '0' ? RTLIL::State::S1 : RTLIL::State::S0);
+					table.bits().push_back(cube[k] == '1' ? RTLIL::State::S1 : RTLIL::State::S0);
+				}
+			RTLIL::Cell *cell = mapped_mod->addCell(NEW_ID, ID($sop));
+			cell->parameters[ID::WIDTH] = RTLIL::Const(width);
+			cell->parameters[ID::DEPTH] = RTLIL::Const(depth);
+			cell->parameters[ID::TABLE] = table;
+			cell->setPort(ID::A, input_sig);
+			if (sop[width + 1] == '1')
+				cell->setPort(ID::Y, y);
+			else {
+				RTLIL::Wire *tempnet = mapped_mod->addWire(NEW_ID);
+				mapped_mod->addNotGate(NEW_ID, tempnet, y);
+				cell->setPort(ID::Y, tempnet);
+			}
+			continue;
+		}
+
+		if (width > 12)
+			log_error("ABC: mapped node `%s' has more than 12 inputs.\n", Abc_ObjName(Abc_ObjFanout0(obj)));
+
+		RTLIL::State onset = sop[width + 1] == '1' ? RTLIL::State::S1 : RTLIL::State::S0;
+		RTLIL::Const lut(onset == RTLIL::State::S1 ? RTLIL::State::S0 : RTLIL::State::S1, 1 << width);
+		for (const char *cube = sop; *cube; cube += width + 3)
+			for (int j = 0; j < (1 << width); j++) {
+				bool match = true;
+				for (int k = 0; k < width && match; k++)
+					if (cube[k] != '-' && (cube[k] == '1') != ((j & (1 << k)) != 0))
+						match = false;
+				if (match)
+					lut.bits().at(j) = onset;
+			}
+
+		RTLIL::Cell *cell = mapped_mod->addCell(NEW_ID, ID($lut));
+		cell->parameters[ID::WIDTH] = RTLIL::Const(width);
+		cell->parameters[ID::LUT] = lut;
+		cell->setPort(ID::A, input_sig);
+		cell->setPort(ID::Y, y);
+	}
+
+	Abc_NtkDelete(netlist);
+	return mapped_design;
+}
+
+// Runs `abc_script` in the linked ABC on the network built from signal_list,
+// installing the generated gate and LUT libraries from memory. ABC's console
+// output is passed through `filt`.
+RTLIL::Design *abc_run_in_memory(const std::string &abc_script, const std::string &genlib, const std::string &lutdefs,
+		RTLIL::IdString dff_name, bool sop_mode, abc_output_filter &filt, int &ret)
+{
+	using namespace abc;
+
+	fflush(stdout);
+	fflush(stderr);
+	FILE *temp_stdouterr = tmpfile();
+	FILE *old_stdout = tmpfile(); // need any fd for renumbering
+	FILE *old_stderr = tmpfile(); // need any fd for renumbering
+	if (temp_stdouterr == nullptr || old_stdout == nullptr || old_stderr == nullptr)
+		log_error("ABC: cannot open a temporary file for output redirection");
+	fd_renumber(fileno(stdout), fileno(old_stdout));
+	fd_renumber(fileno(stderr), fileno(old_stderr));
+	fd_renumber(fileno(temp_stdouterr), fileno(stdout));
+	fd_renumber(fileno(temp_stdouterr), fileno(stderr));
+
+	Abc_Start();
+	Abc_Frame_t *abc_frame = Abc_FrameGetGlobalFrame();
+	ret = 0;
+
+	if (!genlib.empty()) {
+		std::vector<char> buffer(genlib.begin(), genlib.end());
+		buffer.push_back(0);
+		Mio_Library_t *lib = Mio_LibraryReadBuffer(buffer.data(), 0, nullptr, 0, 0);
+		if (lib != nullptr)
+			Mio_UpdateGenlib(lib);
+		else
+			ret = 1;
+	}
+
+	if (!lutdefs.empty()) {
+		std::vector<char> buffer(lutdefs.begin(), lutdefs.end());
+		buffer.push_back(0);
+		If_LibLut_t *lib = If_LibLutReadString(buffer.data());
+		if (lib != nullptr) {
+			If_LibLutFree((If_LibLut_t*)Abc_FrameReadLibLut());
+			Abc_FrameSetLibLut(lib);
+		} else
+			ret = 1;
+	}
+
+	if (ret == 0) {
+		Abc_FrameReplaceCurrentNetwork(abc_frame, abc_build_network());
+		std::vector<char> buffer(abc_script.begin(), abc_script.end());
+		buffer.push_back(0);
+		ret = Cmd_CommandExecute(abc_frame, buffer.data());
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	fd_renumber(fileno(old_stdout), fileno(stdout));
+	fd_renumber(fileno(old_stderr), fileno(stderr));
+	fclose(old_stdout);
+	fclose(old_stderr);
+
+	rewind(temp_stdouterr);
+	std::string line;
+	for (int ch; (ch = fgetc(temp_stdouterr)) != EOF; )
+		if (line += ch, ch == '\n')
+			filt.next_line(line), line.clear();
+	if (!line.empty())
+		filt.next_line(line + "\n");
+	fclose(temp_stdouterr);
+
+	RTLIL::Design *mapped_design = nullptr;
+	if (ret == 0) {
+		if (Abc_FrameReadNtk(abc_frame) == nullptr)
+			log_error("ABC: the script did not leave a network to read back.\n");
+		mapped_design = abc_read_network(Abc_FrameReadNtk(abc_frame), dff_name, sop_mode);
+	}
+
+	Abc_Stop();
+	return mapped_design;
+}
+#endif
+
 void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::string script_file, std::string exe_file,
 		std::vector<std::string> &liberty_files, std::vector<std::string> &genlib_files, std::string constr_file,
 		bool cleanup, vector<int> lut_costs, bool dff_mode, std::string clk_str, bool keepff, std::string delay_target,
@@ -787,17 +1097,30 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 	if (dff_mode && clk_sig.empty())
 		log_cmd_error("Clock domain %s not found.\n", clk_str.c_str());
 
-	std::string tempdir_name;
-	if (cleanup) 
-		tempdir_name = get_base_tmpdir() + "/";
-	else
-		tempdir_name = "_tmp_";
-	tempdir_name += proc_program_prefix() + "yosys-abc-XXXXXX";
-	tempdir_name = make_temp_dir(tempdir_name);
-	log_header(design, "Extracting gate netlist of module `%s' to `%s/input.blif'..\n",
-			module->name.c_str(), replace_tempdir(tempdir_name, tempdir_name, show_tempdir).c_str());
+	// With -in_memory and a linked ABC the netlist, libraries and script are
+	// handed over in memory. Temp files are still used when they were asked for,
+	// or when the script needs to re-read input.blif.
+#ifdef YOSYS_LINK_ABC
+	bool in_memory = in_memory_abc && cleanup && !show_tempdir && !abc_dress;
+#else
+	bool in_memory = false;
+#endif
 
-	std::string abc_script = stringf("read_blif \"%s/input.blif\"; ", tempdir_name.c_str());
+	std::string tempdir_name;
+	std::string abc_script;
+	if (in_memory) {
+		log_header(design, "Extracting gate netlist of module `%s' to an in-memory ABC network..\n", module->name.c_str());
+	} else {
+		if (cleanup)
+			tempdir_name = get_base_tmpdir() + "/";
+		else
+			tempdir_name = "_tmp_";
+		tempdir_name += proc_program_prefix() + "yosys-abc-XXXXXX";
+		tempdir_name = make_temp_dir(tempdir_name);
+		log_header(design, "Extracting gate netlist of module `%s' to `%s/input.blif'..\n",
+				module->name.c_str(), replace_tempdir(tempdir_name, tempdir_name, show_tempdir).c_str());
+		abc_script = stringf("read_blif \"%s/input.blif\"; ", tempdir_name.c_str());
+	}
 
 	if (!liberty_files.empty() || !genlib_files.empty()) {
 		std::string dont_use_args;
@@ -814,7 +1137,9 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 		if (!constr_file.empty())
 			abc_script += stringf("read_constr -v \"%s\"; ", constr_file.c_str());
 	} else
-	if (!lut_costs.empty())
+	if (in_memory)
+		; // the generated LUT or gate library is installed by abc_run_in_memory()
+	else if (!lut_costs.empty())
 		abc_script += stringf("read_lut %s/lutdefs.txt; ", tempdir_name.c_str());
 	else
 		abc_script += stringf("read_library %s/stdcells.genlib; ", tempdir_name.c_str());
@@ -862,19 +1187,24 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 		abc_script = abc_script.substr(0, pos) + lutin_shared + abc_script.substr(pos+3);
 	if (abc_dress)
 		abc_script += stringf("; dress \"%s/input.blif\"", tempdir_name.c_str());
-	abc_script += stringf("; write_blif %s/output.blif", tempdir_name.c_str());
+	if (!in_memory)
+		abc_script += stringf("; write_blif %s/output.blif", tempdir_name.c_str());
 	abc_script = add_echos_to_abc_cmd(abc_script);
 
-	for (size_t i = 0; i+1 < abc_script.size(); i++)
-		if (abc_script[i] == ';' && abc_script[i+1] == ' ')
-			abc_script[i+1] = '\n';
+	std::string buffer;
+	FILE *f = nullptr;
+	if (!in_memory) {
+		for (size_t i = 0; i+1 < abc_script.size(); i++)
+			if (abc_script[i] == ';' && abc_script[i+1] == ' ')
+				abc_script[i+1] = '\n';
 
-	std::string buffer = stringf("%s/abc.script", tempdir_name.c_str());
-	FILE *f = fopen(buffer.c_str(), "wt");
-	if (f == nullptr)
-		log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
-	fprintf(f, "%s\n", abc_script.c_str());
-	fclose(f);
+		buffer = stringf("%s/abc.script", tempdir_name.c_str());
+		f = fopen(buffer.c_str(), "wt");
+		if (f == nullptr)
+			log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
+		fprintf(f, "%s\n", abc_script.c_str());
+		fclose(f);
+	}
 
 	if (dff_mode || !clk_str.empty())
 	{
@@ -924,123 +1254,72 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 
 	handle_loops();
 
-	buffer = stringf("%s/input.blif", tempdir_name.c_str());
-	f = fopen(buffer.c_str(), "wt");
-	if (f == nullptr)
-		log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
-
-	fprintf(f, ".model netlist\n");
-
-	int count_input = 0;
-	fprintf(f, ".inputs");
+	int count_input = 0, count_output = 0, count_gates = 0;
 	for (auto &si : signal_list) {
-		if (!si.is_port || si.type != G(NONE))
-			continue;
-		fprintf(f, " ys__n%d", si.id);
-		pi_map[count_input++] = log_signal(si.bit);
+		if (si.is_port && si.type == G(NONE))
+			pi_map[count_input++] = log_signal(si.bit);
+		if (si.is_port && si.type != G(NONE))
+			po_map[count_output++] = log_signal(si.bit);
+		if (si.type != G(NONE))
+			count_gates++;
 	}
-	if (count_input == 0)
-		fprintf(f, " dummy_input\n");
-	fprintf(f, "\n");
 
-	int count_output = 0;
-	fprintf(f, ".outputs");
-	for (auto &si : signal_list) {
-		if (!si.is_port || si.type == G(NONE))
-			continue;
-		fprintf(f, " ys__n%d", si.id);
-		po_map[count_output++] = log_signal(si.bit);
-	}
-	fprintf(f, "\n");
+	if (!in_memory)
+	{
+		buffer = stringf("%s/input.blif", tempdir_name.c_str());
+		f = fopen(buffer.c_str(), "wt");
+		if (f == nullptr)
+			log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
 
-	for (auto &si : signal_list)
-		fprintf(f, "# ys__n%-5d %s\n", si.id, log_signal(si.bit));
+		fprintf(f, ".model netlist\n");
 
-	for (auto &si : signal_list) {
-		if (si.bit.wire == nullptr) {
-			fprintf(f, ".names ys__n%d\n", si.id);
-			if (si.bit == RTLIL::State::S1)
-				fprintf(f, "1\n");
+		fprintf(f, ".inputs");
+		for (auto &si : signal_list)
+			if (si.is_port && si.type == G(NONE))
+				fprintf(f, " ys__n%d", si.id);
+		if (count_input == 0)
+			fprintf(f, " dummy_input\n");
+		fprintf(f, "\n");
+
+		fprintf(f, ".outputs");
+		for (auto &si : signal_list)
+			if (si.is_port && si.type != G(NONE))
+				fprintf(f, " ys__n%d", si.id);
+		fprintf(f, "\n");
+
+		for (auto &si : signal_list)
+			fprintf(f, "# ys__n%-5d %s\n", si.id, log_signal(si.bit));
+
+		for (auto &si : signal_list) {
+			if (si.bit.wire == nullptr) {
+				fprintf(f, ".names ys__n%d\n", si.id);
+				if (si.bit == RTLIL::State::S1)
+					fprintf(f, "1\n");
+			}
 		}
-	}
 
-	int count_gates = 0;
-	for (auto &si : signal_list) {
-		if (si.type == G(BUF)) {
-			fprintf(f, ".names ys__n%d ys__n%d\n", si.in1, si.id);
-			fprintf(f, "1 1\n");
-		} else if (si.type == G(NOT)) {
-			fprintf(f, ".names ys__n%d ys__n%d\n", si.in1, si.id);
-			fprintf(f, "0 1\n");
-		} else if (si.type == G(AND)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "11 1\n");
-		} else if (si.type == G(NAND)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "0- 1\n");
-			fprintf(f, "-0 1\n");
-		} else if (si.type == G(OR)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "-1 1\n");
-			fprintf(f, "1- 1\n");
-		} else if (si.type == G(NOR)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "00 1\n");
-		} else if (si.type == G(XOR)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "01 1\n");
-			fprintf(f, "10 1\n");
-		} else if (si.type == G(XNOR)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "00 1\n");
-			fprintf(f, "11 1\n");
-		} else if (si.type == G(ANDNOT)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "10 1\n");
-		} else if (si.type == G(ORNOT)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.id);
-			fprintf(f, "1- 1\n");
-			fprintf(f, "-0 1\n");
-		} else if (si.type == G(MUX)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.in3, si.id);
-			fprintf(f, "1-0 1\n");
-			fprintf(f, "-11 1\n");
-		} else if (si.type == G(NMUX)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.in3, si.id);
-			fprintf(f, "0-0 1\n");
-			fprintf(f, "-01 1\n");
-		} else if (si.type == G(AOI3)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.in3, si.id);
-			fprintf(f, "-00 1\n");
-			fprintf(f, "0-0 1\n");
-		} else if (si.type == G(OAI3)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.in3, si.id);
-			fprintf(f, "00- 1\n");
-			fprintf(f, "--0 1\n");
-		} else if (si.type == G(AOI4)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.in3, si.in4, si.id);
-			fprintf(f, "-0-0 1\n");
-			fprintf(f, "-00- 1\n");
-			fprintf(f, "0--0 1\n");
-			fprintf(f, "0-0- 1\n");
-		} else if (si.type == G(OAI4)) {
-			fprintf(f, ".names ys__n%d ys__n%d ys__n%d ys__n%d ys__n%d\n", si.in1, si.in2, si.in3, si.in4, si.id);
-			fprintf(f, "00-- 1\n");
-			fprintf(f, "--00 1\n");
-		} else if (si.type == G(FF)) {
-			fprintf(f, ".latch ys__n%d ys__n%d 2\n", si.in1, si.id);
-		} else if (si.type == G(FF0)) {
-			fprintf(f, ".latch ys__n%d ys__n%d 0\n", si.in1, si.id);
-		} else if (si.type == G(FF1)) {
-			fprintf(f, ".latch ys__n%d ys__n%d 1\n", si.in1, si.id);
-		} else if (si.type != G(NONE))
-			log_abort();
-		if (si.type != G(NONE))
-			count_gates++;
-	}
+		for (auto &si : signal_list) {
+			if (si.type == G(FF)) {
+				fprintf(f, ".latch ys__n%d ys__n%d 2\n", si.in1, si.id);
+			} else if (si.type == G(FF0)) {
+				fprintf(f, ".latch ys__n%d ys__n%d 0\n", si.in1, si.id);
+			} else if (si.type == G(FF1)) {
+				fprintf(f, ".latch ys__n%d ys__n%d 1\n", si.in1, si.id);
+			} else if (si.type != G(NONE)) {
+				const char *cover = gate_cover(si.type);
+				if (cover == nullptr)
+					log_abort();
+				int inputs[4] = {si.in1, si.in2, si.in3, si.in4};
+				fprintf(f, ".names");
+				for (int i = 0; i < int(strchr(cover, ' ') - cover); i++)
+					fprintf(f, " ys__n%d", inputs[i]);
+				fprintf(f, " ys__n%d\n%s", si.id, cover);
+			}
+		}
 
-	fprintf(f, ".end\n");
-	fclose(f);
+		fprintf(f, ".end\n");
+		fclose(f);
+	}
 
 	log("Extracted %d gates and %d wires to a netlist network with %d inputs and %d outputs.\n",
 			count_gates, GetSize(signal_list), count_input, count_output);
@@ -1051,124 +1330,141 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 
 		auto &cell_cost = cmos_cost ? CellCosts::cmos_gate_cost() : CellCosts::default_gate_cost();
 
-		buffer = stringf("%s/stdcells.genlib", tempdir_name.c_str());
-		f = fopen(buffer.c_str(), "wt");
-		if (f == nullptr)
-			log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
-		fprintf(f, "GATE ZERO    1 Y=CONST0;\n");
-		fprintf(f, "GATE ONE     1 Y=CONST1;\n");
-		fprintf(f, "GATE BUF    %d Y=A;                  PIN * NONINV  1 999 1 0 1 0\n", cell_cost.at(ID($_BUF_)));
-		fprintf(f, "GATE NOT    %d Y=!A;                 PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_NOT_)));
+		std::string genlib, lutdefs;
+		genlib += stringf("GATE ZERO    1 Y=CONST0;\n");
+		genlib += stringf("GATE ONE     1 Y=CONST1;\n");
+		genlib += stringf("GATE BUF    %d Y=A;                  PIN * NONINV  1 999 1 0 1 0\n", cell_cost.at(ID($_BUF_)));
+		genlib += stringf("GATE NOT    %d Y=!A;                 PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_NOT_)));
 		if (enabled_gates.count("AND"))
-			fprintf(f, "GATE AND    %d Y=A*B;                PIN * NONINV  1 999 1 0 1 0\n", cell_cost.at(ID($_AND_)));
+			genlib += stringf("GATE AND    %d Y=A*B;                PIN * NONINV  1 999 1 0 1 0\n", cell_cost.at(ID($_AND_)));
 		if (enabled_gates.count("NAND"))
-			fprintf(f, "GATE NAND   %d Y=!(A*B);             PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_NAND_)));
+			genlib += stringf("GATE NAND   %d Y=!(A*B);             PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_NAND_)));
 		if (enabled_gates.count("OR"))
-			fprintf(f, "GATE OR     %d Y=A+B;                PIN * NONINV  1 999 1 0 1 0\n", cell_cost.at(ID($_OR_)));
+			genlib += stringf("GATE OR     %d Y=A+B;                PIN * NONINV  1 999 1 0 1 0\n", cell_cost.at(ID($_OR_)));
 		if (enabled_gates.count("NOR"))
-			fprintf(f, "GATE NOR    %d Y=!(A+B);             PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_NOR_)));
+			genlib += stringf("GATE NOR    %d Y=!(A+B);             PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_NOR_)));
 		if (enabled_gates.count("XOR"))
-			fprintf(f, "GATE XOR    %d Y=(A*!B)+(!A*B);      PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_XOR_)));
+			genlib += stringf("GATE XOR    %d Y=(A*!B)+(!A*B);      PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_XOR_)));
 		if (enabled_gates.count("XNOR"))
-			fprintf(f, "GATE XNOR   %d Y=(A*B)+(!A*!B);      PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_XNOR_)));
+			genlib += stringf("GATE XNOR   %d Y=(A*B)+(!A*!B);      PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_XNOR_)));
 		if (enabled_gates.count("ANDNOT"))
-			fprintf(f, "GATE ANDNOT %d Y=A*!B;               PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_ANDNOT_)));
+			genlib += stringf("GATE ANDNOT %d Y=A*!B;               PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_ANDNOT_)));
 		if (enabled_gates.count("ORNOT"))
-			fprintf(f, "GATE ORNOT  %d Y=A+!B;               PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_ORNOT_)));
+			genlib += stringf("GATE ORNOT  %d Y=A+!B;               PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_ORNOT_)));
 		if (enabled_gates.count("AOI3"))
-			fprintf(f, "GATE AOI3   %d Y=!((A*B)+C);         PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_AOI3_)));
+			genlib += stringf("GATE AOI3   %d Y=!((A*B)+C);         PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_AOI3_)));
 		if (enabled_gates.count("OAI3"))
-			fprintf(f, "GATE OAI3   %d Y=!((A+B)*C);         PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_OAI3_)));
+			genlib += stringf("GATE OAI3   %d Y=!((A+B)*C);         PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_OAI3_)));
 		if (enabled_gates.count("AOI4"))
-			fprintf(f, "GATE AOI4   %d Y=!((A*B)+(C*D));     PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_AOI4_)));
+			genlib += stringf("GATE AOI4   %d Y=!((A*B)+(C*D));     PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_AOI4_)));
 		if (enabled_gates.count("OAI4"))
-			fprintf(f, "GATE OAI4   %d Y=!((A+B)*(C+D));     PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_OAI4_)));
+			genlib += stringf("GATE OAI4   %d Y=!((A+B)*(C+D));     PIN * INV     1 999 1 0 1 0\n", cell_cost.at(ID($_OAI4_)));
 		if (enabled_gates.count("MUX"))
-			fprintf(f, "GATE MUX    %d Y=(A*B)+(S*B)+(!S*A); PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_MUX_)));
+			genlib += stringf("GATE MUX    %d Y=(A*B)+(S*B)+(!S*A); PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_MUX_)));
 		if (enabled_gates.count("NMUX"))
-			fprintf(f, "GATE NMUX   %d Y=!((A*B)+(S*B)+(!S*A)); PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_NMUX_)));
+			genlib += stringf("GATE NMUX   %d Y=!((A*B)+(S*B)+(!S*A)); PIN * UNKNOWN 1 999 1 0 1 0\n", cell_cost.at(ID($_NMUX_)));
 		if (map_mux4)
-			fprintf(f, "GATE MUX4   %d Y=(!S*!T*A)+(S*!T*B)+(!S*T*C)+(S*T*D); PIN * UNKNOWN 1 999 1 0 1 0\n", 2*cell_cost.at(ID($_MUX_)));
+			genlib += stringf("GATE MUX4   %d Y=(!S*!T*A)+(S*!T*B)+(!S*T*C)+(S*T*D); PIN * UNKNOWN 1 999 1 0 1 0\n", 2*cell_cost.at(ID($_MUX_)));
 		if (map_mux8)
-			fprintf(f, "GATE MUX8   %d Y=(!S*!T*!U*A)+(S*!T*!U*B)+(!S*T*!U*C)+(S*T*!U*D)+(!S*!T*U*E)+(S*!T*U*F)+(!S*T*U*G)+(S*T*U*H); PIN * UNKNOWN 1 999 1 0 1 0\n", 4*cell_cost.at(ID($_MUX_)));
+			genlib += stringf("GATE MUX8   %d Y=(!S*!T*!U*A)+(S*!T*!U*B)+(!S*T*!U*C)+(S*T*!U*D)+(!S*!T*U*E)+(S*!T*U*F)+(!S*T*U*G)+(S*T*U*H); PIN * UNKNOWN 1 999 1 0 1 0\n", 4*cell_cost.at(ID($_MUX_)));
 		if (map_mux16)
-			fprintf(f, "GATE MUX16  %d Y=(!S*!T*!U*!V*A)+(S*!T*!U*!V*B)+(!S*T*!U*!V*C)+(S*T*!U*!V*D)+(!S*!T*U*!V*E)+(S*!T*U*!V*F)+(!S*T*U*!V*G)+(S*T*U*!V*H)+(!S*!T*!U*V*I)+(S*!T*!U*V*J)+(!S*T*!U*V*K)+(S*T*!U*V*L)+(!S*!T*U*V*M)+(S*!T*U*V*N)+(!S*T*U*V*O)+(S*T*U*V*P); PIN * UNKNOWN 1 999 1 0 1 0\n", 8*cell_cost.at(ID($_MUX_)));
-		fclose(f);
+			genlib += stringf("GATE MUX16  %d Y=(!S*!T*!U*!V*A)+(S*!T*!U*!V*B)+(!S*T*!U*!V*C)+(S*T*!U*!V*D)+(!S*!T*U*!V*E)+(S*!T*U*!V*F)+(!S*T*U*!V*G)+(S*T*U*!V*H)+(!S*!T*!U*V*I)+(S*!T*!U*V*J)+(!S*T*!U*V*K)+(S*T*!U*V*L)+(!S*!T*U*V*M)+(S*!T*U*V*N)+(!S*T*U*V*O)+(S*T*U*V*P); PIN * UNKNOWN 1 999 1 0 1 0\n", 8*cell_cost.at(ID($_MUX_)));
+		for (int i = 0; i < GetSize(lut_costs); i++)
+			lutdefs += stringf("%d %d.00 1.00\n", i+1, lut_costs.at(i));
 
-		if (!lut_costs.empty()) {
-			buffer = stringf("%s/lutdefs.txt", tempdir_name.c_str());
+		bool builtin_lib = liberty_files.empty() && genlib_files.empty();
+		RTLIL::Design *mapped_design = nullptr;
+		int ret = 0;
+
+		if (in_memory)
+		{
+#ifdef YOSYS_LINK_ABC
+			log("Running linked ABC on the in-memory network.\n");
+			buffer = abc_script;
+			abc_output_filter filt(tempdir_name, show_tempdir);
+			mapped_design = abc_run_in_memory(abc_script, builtin_lib && lut_costs.empty() ? genlib : std::string(),
+					builtin_lib ? lutdefs : std::string(), builtin_lib ? ID(DFF) : ID(_dff_), sop_mode, filt, ret);
+#endif
+			if (ret != 0)
+				log_error("ABC: execution of script \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
+		}
+		else
+		{
+			buffer = stringf("%s/stdcells.genlib", tempdir_name.c_str());
 			f = fopen(buffer.c_str(), "wt");
 			if (f == nullptr)
 				log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
-			for (int i = 0; i < GetSize(lut_costs); i++)
-				fprintf(f, "%d %d.00 1.00\n", i+1, lut_costs.at(i));
+			fprintf(f, "%s", genlib.c_str());
 			fclose(f);
-		}
 
-		buffer = stringf("\"%s\" -s -f %s/abc.script 2>&1", exe_file.c_str(), tempdir_name.c_str());
-		log("Running ABC command: %s\n", replace_tempdir(buffer, tempdir_name, show_tempdir).c_str());
+			if (!lut_costs.empty()) {
+				buffer = stringf("%s/lutdefs.txt", tempdir_name.c_str());
+				f = fopen(buffer.c_str(), "wt");
+				if (f == nullptr)
+					log_error("Opening %s for writing failed: %s\n", buffer.c_str(), strerror(errno));
+				fprintf(f, "%s", lutdefs.c_str());
+				fclose(f);
+			}
+
+			buffer = stringf("\"%s\" -s -f %s/abc.script 2>&1", exe_file.c_str(), tempdir_name.c_str());
+			log("Running ABC command: %s\n", replace_tempdir(buffer, tempdir_name, show_tempdir).c_str());
 
 #ifndef YOSYS_LINK_ABC
-		abc_output_filter filt(tempdir_name, show_tempdir);
-		int ret = run_command(buffer, std::bind(&abc_output_filter::next_line, filt, std::placeholders::_1));
+			abc_output_filter filt(tempdir_name, show_tempdir);
+			ret = run_command(buffer, std::bind(&abc_output_filter::next_line, filt, std::placeholders::_1));
 #else
-		string temp_stdouterr_name = stringf("%s/stdouterr.txt", tempdir_name.c_str());
-		FILE *temp_stdouterr_w = fopen(temp_stdouterr_name.c_str(), "w");
-		if (temp_stdouterr_w == NULL)
-			log_error("ABC: cannot open a temporary file for output redirection");
-		fflush(stdout);
-		fflush(stderr);
-		FILE *old_stdout = fopen(temp_stdouterr_name.c_str(), "r"); // need any fd for renumbering
-		FILE *old_stderr = fopen(temp_stdouterr_name.c_str(), "r"); // need any fd for renumbering
-#if defined(__wasm)
-#define fd_renumber(from, to) (void)__wasi_fd_renumber(from, to)
-#else
-#define fd_renumber(from, to) dup2(from, to)
+			string temp_stdouterr_name = stringf("%s/stdouterr.txt", tempdir_name.c_str());
+			FILE *temp_stdouterr_w = fopen(temp_stdouterr_name.c_str(), "w");
+			if (temp_stdouterr_w == NULL)
+				log_error("ABC: cannot open a temporary file for output redirection");
+			fflush(stdout);
+			fflush(stderr);
+			FILE *old_stdout = fopen(temp_stdouterr_name.c_str(), "r"); // need any fd for renumbering
+			FILE *old_stderr = fopen(temp_stdouterr_name.c_str(), "r"); // need any fd for renumbering
+			fd_renumber(fileno(stdout), fileno(old_stdout));
+			fd_renumber(fileno(stderr), fileno(old_stderr));
+			fd_renumber(fileno(temp_stdouterr_w), fileno(stdout));
+			fd_renumber(fileno(temp_stdouterr_w), fileno(stderr));
+			fclose(temp_stdouterr_w);
+			// These needs to be mutable, supposedly due to getopt
+			char *abc_argv[5];
+			string tmp_script_name = stringf("%s/abc.script", tempdir_name.c_str());
+			abc_argv[0] = strdup(exe_file.c_str());
+			abc_argv[1] = strdup("-s");
+			abc_argv[2] = strdup("-f");
+			abc_argv[3] = strdup(tmp_script_name.c_str());
+			abc_argv[4] = 0;
+			ret = abc::Abc_RealMain(4, abc_argv);
+			free(abc_argv[0]);
+			free(abc_argv[1]);
+			free(abc_argv[2]);
+			free(abc_argv[3]);
+			fflush(stdout);
+			fflush(stderr);
+			fd_renumber(fileno(old_stdout), fileno(stdout));
+			fd_renumber(fileno(old_stderr), fileno(stderr));
+			fclose(old_stdout);
+			fclose(old_stderr);
+			std::ifstream temp_stdouterr_r(temp_stdouterr_name);
+			abc_output_filter filt(tempdir_name, show_tempdir);
+			for (std::string line; std::getline(temp_stdouterr_r, line); )
+				filt.next_line(line + "\n");
+			temp_stdouterr_r.close();
 #endif
-		fd_renumber(fileno(stdout), fileno(old_stdout));
-		fd_renumber(fileno(stderr), fileno(old_stderr));
-		fd_renumber(fileno(temp_stdouterr_w), fileno(stdout));
-		fd_renumber(fileno(temp_stdouterr_w), fileno(stderr));
-		fclose(temp_stdouterr_w);
-		// These needs to be mutable, supposedly due to getopt
-		char *abc_argv[5];
-		string tmp_script_name = stringf("%s/abc.script", tempdir_name.c_str());
-		abc_argv[0] = strdup(exe_file.c_str());
-		abc_argv[1] = strdup("-s");
-		abc_argv[2] = strdup("-f");
-		abc_argv[3] = strdup(tmp_script_name.c_str());
-		abc_argv[4] = 0;
-		int ret = abc::Abc_RealMain(4, abc_argv);
-		free(abc_argv[0]);
-		free(abc_argv[1]);
-		free(abc_argv[2]);
-		free(abc_argv[3]);
-		fflush(stdout);
-		fflush(stderr);
-		fd_renumber(fileno(old_stdout), fileno(stdout));
-		fd_renumber(fileno(old_stderr), fileno(stderr));
-		fclose(old_stdout);
-		fclose(old_stderr);
-		std::ifstream temp_stdouterr_r(temp_stdouterr_name);
-		abc_output_filter filt(tempdir_name, show_tempdir);
-		for (std::string line; std::getline(temp_stdouterr_r, line); )
-			filt.next_line(line + "\n");
-		temp_stdouterr_r.close();
-#endif
-		if (ret != 0)
-			log_error("ABC: execution of command \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
+			if (ret != 0)
+				log_error("ABC: execution of command \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
 
-		buffer = stringf("%s/%s", tempdir_name.c_str(), "output.blif");
-		std::ifstream ifs;
-		ifs.open(buffer);
-		if (ifs.fail())
-			log_error("Can't open ABC output file `%s'.\n", buffer.c_str());
+			buffer = stringf("%s/%s", tempdir_name.c_str(), "output.blif");
+			std::ifstream ifs;
+			ifs.open(buffer);
+			if (ifs.fail())
+				log_error("Can't open ABC output file `%s'.\n", buffer.c_str());
 
-		bool builtin_lib = liberty_files.empty() && genlib_files.empty();
-		RTLIL::Design *mapped_design = new RTLIL::Design;
-		parse_blif(mapped_design, ifs, builtin_lib ? ID(DFF) : ID(_dff_), false, sop_mode);
+			mapped_design = new RTLIL::Design;
+			parse_blif(mapped_design, ifs, builtin_lib ? ID(DFF) : ID(_dff_), false, sop_mode);
 
-		ifs.close();
+			ifs.close();
+		}
 
 		log_header(design, "Re-integrating ABC results.\n");
 		RTLIL::Module *mapped_mod = mapped_design->module(ID(netlist));
@@ -1442,7 +1738,8 @@ void abc_module(RTLIL::Design *design, RTLIL::Module *current_module, std::strin
 		log("Don't call ABC as there is nothing to map.\n");
 	}
 
-	if (cleanup)
+	// The in-memory flow never creates a temp directory.
+	if (cleanup && !in_memory)
 	{
 		log("Removing temp directory.\n");
 		remove_directory(tempdir_name);
@@ -1634,6 +1931,12 @@ struct AbcPass : public Pass {
 		log("        preserve naming by an equivalence check between the original and\n");
 		log("        post-ABC netlists (experimental).\n");
 		log("\n");
+		log("    -in_memory\n");
+		log("        exchange the netlist, libraries and script with ABC in memory instead\n");
+		log("        of through temporary files. this requires yosys to be built with a\n");
+		log("        linked ABC and is ignored when -nocleanup, -showtmp or -dress is used\n");
+		log("        (experimental).\n");
+		log("\n");
 		log("When no target cell library is specified the Yosys standard cell library is\n");
 		log("loaded into ABC before the ABC script is executed.\n");
 		log("\n");
@@ -1668,6 +1971,7 @@ struct AbcPass : public Pass {
 		bool abc_dress = false;
 		vector<int> lut_costs;
 		markgroups = false;
+		in_memory_abc = false;
 
 		map_mux4 = false;
 		map_mux8 = false;
@@ -1713,6 +2017,7 @@ struct AbcPass : public Pass {
 		keepff = design->scratchpad_get_bool("abc.keepff", keepff);
 		show_tempdir = design->scratchpad_get_bool("abc.showtmp", show_tempdir);
 		markgroups = design->scratchpad_get_bool("abc.markgroups", markgroups);
+		in_memory_abc = design->scratchpad_get_bool("abc.in_memory", in_memory_abc);
 
 		if (design->scratchpad_get_bool("abc.debug")) {
 			cleanup = false;
@@ -1837,10 +2142,19 @@ struct AbcPass : public Pass {
 				markgroups = true;
 				continue;
 			}
+			if (arg == "-in_memory") {
+				in_memory_abc = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
 
+#ifndef YOSYS_LINK_ABC
+		if (in_memory_abc)
+			log_cmd_error("abc '-in_memory' requires yosys to be built with a linked ABC.\n");
+#endif
+
 		if (genlib_files.empty() && liberty_files.empty() && !default_liberty_file.empty())
 			liberty_files.push_back(default_liberty_file);
 
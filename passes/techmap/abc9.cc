@@ -27,8 +27,13 @@
 #include "kernel/rtlil.h"
 #include "kernel/log.h"
 
+#include <chrono>
+#include <deque>
+
 // abc9_exe.cc
 std::string fold_abc9_cmd(std::string str);
+void abc9_exe_finish(const std::string &tempdir_name, bool show_tempdir, const std::string &command,
+		const std::vector<std::string> &output, int ret);
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -171,6 +176,19 @@ struct Abc9Pass : public ScriptPass
 		log("    -box <file>\n");
 		log("        pass this file with box library to ABC.\n");
 		log("\n");
+		log("    -in_memory\n");
+		log("        passed to abc9_exe, see 'help abc9_exe'. this requires yosys to be\n");
+		log("        built with a linked ABC (experimental).\n");
+		log("\n");
+		log("    -j <N>\n");
+		log("        run up to <N> ABC processes at the same time, one per selected module.\n");
+		log("        the netlists are still extracted and re-integrated one module at a\n");
+		log("        time and in the same order as without this option, so the result is\n");
+		log("        the same. the output of each ABC process is logged when its module\n");
+		log("        is re-integrated, followed by a per-module timing summary at the\n");
+		log("        end. the default can also be set with the scratchpad variable\n");
+		log("        'abc9.jobs', e.g. 'scratchpad -set abc9.jobs 4'. (default: 1)\n");
+		log("\n");
 		log("Note that this is a logic optimization pass within Yosys that is calling ABC\n");
 		log("internally. This is not going to \"run ABC on your design\". It will instead run\n");
 		log("ABC on logic snippets extracted from your design. You will not get any useful\n");
@@ -185,9 +203,9 @@ struct Abc9Pass : public ScriptPass
 	}
 
 	std::stringstream exe_cmd;
-	bool dff_mode, cleanup;
+	bool dff_mode, cleanup, show_tempdir;
 	bool lut_mode;
-	int maxlut;
+	int maxlut, jobs;
 	std::string box_file;
 
 	void clear_flags() override
@@ -196,8 +214,10 @@ struct Abc9Pass : public ScriptPass
 		exe_cmd << "abc9_exe";
 		dff_mode = false;
 		cleanup = true;
+		show_tempdir = false;
 		lut_mode = false;
 		maxlut = 0;
+		jobs = 1;
 		box_file = "";
 	}
 
@@ -209,9 +229,12 @@ struct Abc9Pass : public ScriptPass
 		// get arguments from scratchpad first, then override by command arguments
 		dff_mode = design->scratchpad_get_bool("abc9.dff", dff_mode);
 		cleanup = !design->scratchpad_get_bool("abc9.nocleanup", !cleanup);
+		show_tempdir = design->scratchpad_get_bool("abc9.showtmp", show_tempdir);
+		jobs = design->scratchpad_get_int("abc9.jobs", jobs);
 
 		if (design->scratchpad_get_bool("abc9.debug")) {
 			cleanup = false;
+			show_tempdir = true;
 			exe_cmd << " -showtmp";
 		}
 
@@ -229,7 +252,9 @@ struct Abc9Pass : public ScriptPass
 				continue;
 			}
 			if (arg == "-fast" || /* arg == "-dff" || */
-					/* arg == "-nocleanup" || */ arg == "-showtmp") {
+					/* arg == "-nocleanup" || */ arg == "-showtmp" || arg == "-in_memory") {
+				if (arg == "-showtmp")
+					show_tempdir = true;
 				exe_cmd << " " << arg;
 				continue;
 			}
@@ -250,6 +275,10 @@ struct Abc9Pass : public ScriptPass
 				maxlut = atoi(args[++argidx].c_str());
 				continue;
 			}
+			if (arg == "-j" && argidx+1 < args.size()) {
+				jobs = atoi(args[++argidx].c_str());
+				continue;
+			}
 			if (arg == "-run" && argidx+1 < args.size()) {
 				size_t pos = args[argidx+1].find(':');
 				if (pos == std::string::npos)
@@ -264,6 +293,14 @@ struct Abc9Pass : public ScriptPass
 
 		if (maxlut && lut_mode)
 			log_cmd_error("abc9 '-maxlut' option only applicable without '-lut' nor '-luts'.\n");
+		if (jobs < 1)
+			log_cmd_error("abc9 '-j' option requires a positive number of jobs.\n");
+#if defined(YOSYS_LINK_ABC) || defined(YOSYS_DISABLE_SPAWN)
+		if (jobs > 1) {
+			log_warning("abc9 '-j' needs to start ABC as separate processes, which this build does not do. Mapping one module at a time.\n");
+			jobs = 1;
+		}
+#endif
 
 		log_assert(design);
 		if (design->selected_modules().empty()) {
@@ -279,6 +316,200 @@ struct Abc9Pass : public ScriptPass
 		log_pop();
 	}
 
+	std::string make_tempdir()
+	{
+		std::string tempdir_name;
+		if (cleanup)
+			tempdir_name = get_base_tmpdir() + "/";
+		else
+			tempdir_name = "_tmp_";
+		tempdir_name += proc_program_prefix() + "yosys-abc-XXXXXX";
+		return make_temp_dir(tempdir_name);
+	}
+
+	// Writes the ABC inputs for the (selected) module `mod` into `tempdir_name`
+	// and returns the abc9_exe command to map it, or an empty string if there
+	// is nothing to map.
+	std::string prep_module(RTLIL::Module *mod, const std::string &tempdir_name)
+	{
+		// this check does nothing because the caller adds the whole module to the selection
+		if (!active_design->selected_whole_module(mod))
+			log_error("Can't handle partially selected module %s!\n", log_id(mod));
+
+		if (!lut_mode)
+			run_nocheck(stringf("abc9_ops -write_lut %s/input.lut", tempdir_name.c_str()));
+		if (box_file.empty())
+			run_nocheck(stringf("abc9_ops -write_box %s/input.box", tempdir_name.c_str()));
+		run_nocheck(stringf("write_xaiger -map %s/input.sym %s %s/input.xaig", tempdir_name.c_str(), dff_mode ? "-dff" : "", tempdir_name.c_str()));
+
+		int num_outputs = active_design->scratchpad_get_int("write_xaiger.num_outputs");
+
+		log("Extracted %d AND gates and %d wires from module `%s' to a netlist network with %d inputs and %d outputs.\n",
+				active_design->scratchpad_get_int("write_xaiger.num_ands"),
+				active_design->scratchpad_get_int("write_xaiger.num_wires"),
+				log_id(mod),
+				active_design->scratchpad_get_int("write_xaiger.num_inputs"),
+				num_outputs);
+		if (!num_outputs)
+			return std::string();
+
+		std::string abc9_exe_cmd;
+		abc9_exe_cmd += stringf("%s -cwd %s", exe_cmd.str().c_str(), tempdir_name.c_str());
+		if (!lut_mode)
+			abc9_exe_cmd += stringf(" -lut %s/input.lut", tempdir_name.c_str());
+		if (box_file.empty())
+			abc9_exe_cmd += stringf(" -box %s/input.box", tempdir_name.c_str());
+		else
+			abc9_exe_cmd += stringf(" -box %s", box_file.c_str());
+		return abc9_exe_cmd;
+	}
+
+	void map_modules(const std::vector<RTLIL::Module*> &modules)
+	{
+		for (auto mod : modules) {
+			if (mod->processes.size() > 0) {
+				log("Skipping module %s as it contains processes.\n", log_id(mod));
+				continue;
+			}
+
+			log_push();
+			active_design->select(mod);
+
+			std::string tempdir_name = make_tempdir();
+			std::string abc9_exe_cmd = prep_module(mod, tempdir_name);
+			if (!abc9_exe_cmd.empty()) {
+				run_nocheck(abc9_exe_cmd);
+				run_nocheck(stringf("read_aiger -xaiger -wideports -module_name %s$abc9 -map %s/input.sym %s/output.aig", log_id(mod), tempdir_name.c_str(), tempdir_name.c_str()));
+				run_nocheck(stringf("abc9_ops -reintegrate %s", dff_mode ? "-dff" : ""));
+			}
+			else
+				log("Don't call ABC as there is nothing to map.\n");
+
+			if (cleanup) {
+				log("Removing temp directory.\n");
+				remove_directory(tempdir_name);
+			}
+			mod->check();
+			active_design->selection().selected_modules.clear();
+			log_pop();
+		}
+	}
+
+	struct ModuleJob
+	{
+		RTLIL::Module *mod;
+		std::string tempdir_name, command;
+		FILE *process = nullptr;
+		std::chrono::steady_clock::time_point started;
+		double prep_time = 0, exe_time = 0, reintegrate_time = 0;
+	};
+
+	static double seconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Like the serial loop in script(), but the ABC processes of up to `jobs`
+	// modules run at the same time. Processes are collected and their modules
+	// re-integrated in the order they were started, so the log and the
+	// resulting netlist do not depend on which process finishes first.
+	void map_modules_parallel(const std::vector<RTLIL::Module*> &modules)
+	{
+		std::vector<ModuleJob> module_jobs;
+		std::deque<int> running;
+
+		log("Running up to %d ABC processes at the same time.\n", jobs);
+
+		auto collect = [&](ModuleJob &job) {
+			int ret = pclose(job.process);
+#ifndef _WIN32
+			if (ret >= 0)
+				ret = WEXITSTATUS(ret);
+#endif
+			job.exe_time = seconds_since(job.started);
+
+			auto start = std::chrono::steady_clock::now();
+			log_push();
+			log("Collecting ABC results for module `%s'.\n", log_id(job.mod));
+			active_design->select(job.mod);
+
+			std::vector<std::string> output;
+			std::ifstream ifs(job.tempdir_name + "/output.log");
+			for (std::string line; std::getline(ifs, line); )
+				output.push_back(line + "\n");
+			ifs.close();
+			abc9_exe_finish(job.tempdir_name, show_tempdir, job.command, output, ret);
+
+			run_nocheck(stringf("read_aiger -xaiger -wideports -module_name %s$abc9 -map %s/input.sym %s/output.aig", log_id(job.mod), job.tempdir_name.c_str(), job.tempdir_name.c_str()));
+			run_nocheck(stringf("abc9_ops -reintegrate %s", dff_mode ? "-dff" : ""));
+
+			if (cleanup) {
+				log("Removing temp directory.\n");
+				remove_directory(job.tempdir_name);
+			}
+			job.mod->check();
+			active_design->selection().selected_modules.clear();
+			log_pop();
+			job.reintegrate_time = seconds_since(start);
+		};
+
+		for (auto mod : modules) {
+			if (mod->processes.size() > 0) {
+				log("Skipping module %s as it contains processes.\n", log_id(mod));
+				continue;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			log_push();
+			active_design->select(mod);
+
+			ModuleJob job;
+			job.mod = mod;
+			job.tempdir_name = make_tempdir();
+			std::string abc9_exe_cmd = prep_module(mod, job.tempdir_name);
+			if (!abc9_exe_cmd.empty()) {
+				run_nocheck(abc9_exe_cmd + " -prep_only");
+				job.command = active_design->scratchpad_get_string("abc9_exe.command");
+				std::string command = stringf("%s > \"%s/output.log\" 2>&1", job.command.c_str(), job.tempdir_name.c_str());
+				fflush(stdout);
+				job.process = popen(command.c_str(), "r");
+				if (job.process == nullptr)
+					log_error("ABC: starting command \"%s\" failed: %s\n", job.command.c_str(), strerror(errno));
+				job.started = std::chrono::steady_clock::now();
+			} else {
+				log("Don't call ABC as there is nothing to map.\n");
+				if (cleanup) {
+					log("Removing temp directory.\n");
+					remove_directory(job.tempdir_name);
+				}
+				mod->check();
+			}
+
+			active_design->selection().selected_modules.clear();
+			log_pop();
+			job.prep_time = seconds_since(start);
+
+			module_jobs.push_back(job);
+			if (job.process != nullptr)
+				running.push_back(GetSize(module_jobs) - 1);
+
+			while (GetSize(running) >= jobs) {
+				collect(module_jobs[running.front()]);
+				running.pop_front();
+			}
+		}
+
+		while (!running.empty()) {
+			collect(module_jobs[running.front()]);
+			running.pop_front();
+		}
+
+		log("\nABC9 wall-clock time per module (ABC time is measured until the results were collected):\n");
+		for (auto &job : module_jobs)
+			log("  %-40s  extract %8.2fs  abc %8.2fs  reintegrate %8.2fs\n", log_id(job.mod),
+					job.prep_time, job.exe_time, job.reintegrate_time);
+	}
+
 	void script() override
 	{
 		if (check_label("check")) {
@@ -396,65 +627,10 @@ struct Abc9Pass : public ScriptPass
 				auto selected_modules = active_design->selected_modules();
 				active_design->push_empty_selection();
 
-				for (auto mod : selected_modules) {
-					if (mod->processes.size() > 0) {
-						log("Skipping module %s as it contains processes.\n", log_id(mod));
-						continue;
-					}
-
-					log_push();
-					active_design->select(mod);
-
-					// this check does nothing because the above line adds the whole module to the selection
-					if (!active_design->selected_whole_module(mod))
-						log_error("Can't handle partially selected module %s!\n", log_id(mod));
-
-					std::string tempdir_name;
-					if (cleanup) 
-						tempdir_name = get_base_tmpdir() + "/";
-					else
-						tempdir_name = "_tmp_";
-					tempdir_name += proc_program_prefix() + "yosys-abc-XXXXXX";
-					tempdir_name = make_temp_dir(tempdir_name);
-
-					if (!lut_mode)
-						run_nocheck(stringf("abc9_ops -write_lut %s/input.lut", tempdir_name.c_str()));
-					if (box_file.empty())
-						run_nocheck(stringf("abc9_ops -write_box %s/input.box", tempdir_name.c_str()));
-					run_nocheck(stringf("write_xaiger -map %s/input.sym %s %s/input.xaig", tempdir_name.c_str(), dff_mode ? "-dff" : "", tempdir_name.c_str()));
-
-					int num_outputs = active_design->scratchpad_get_int("write_xaiger.num_outputs");
-
-					log("Extracted %d AND gates and %d wires from module `%s' to a netlist network with %d inputs and %d outputs.\n",
-							active_design->scratchpad_get_int("write_xaiger.num_ands"),
-							active_design->scratchpad_get_int("write_xaiger.num_wires"),
-							log_id(mod),
-							active_design->scratchpad_get_int("write_xaiger.num_inputs"),
-							num_outputs);
-					if (num_outputs) {
-						std::string abc9_exe_cmd;
-						abc9_exe_cmd += stringf("%s -cwd %s", exe_cmd.str().c_str(), tempdir_name.c_str());
-						if (!lut_mode)
-							abc9_exe_cmd += stringf(" -lut %s/input.lut", tempdir_name.c_str());
-						if (box_file.empty())
-							abc9_exe_cmd += stringf(" -box %s/input.box", tempdir_name.c_str());
-						else
-							abc9_exe_cmd += stringf(" -box %s", box_file.c_str());
-						run_nocheck(abc9_exe_cmd);
-						run_nocheck(stringf("read_aiger -xaiger -wideports -module_name %s$abc9 -map %s/input.sym %s/output.aig", log_id(mod), tempdir_name.c_str(), tempdir_name.c_str()));
-						run_nocheck(stringf("abc9_ops -reintegrate %s", dff_mode ? "-dff" : ""));
-					}
-					else
-						log("Don't call ABC as there is nothing to map.\n");
-
-					if (cleanup) {
-						log("Removing temp directory.\n");
-						remove_directory(tempdir_name);
-					}
-					mod->check();
-					active_design->selection().selected_modules.clear();
-					log_pop();
-				}
+				if (jobs > 1)
+					map_modules_parallel(selected_modules);
+				else
+					map_modules(selected_modules);
 
 				active_design->pop_selection();
 			}
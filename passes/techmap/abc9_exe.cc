@@ -31,6 +31,8 @@
 #endif
 
 #ifdef YOSYS_LINK_ABC
+#include "base/main/main.h"
+#include "base/cmd/cmd.h"
 namespace abc {
 	int Abc_RealMain(int argc, char *argv[]);
 }
@@ -164,11 +166,21 @@ struct abc9_output_filter
 	}
 };
 
+void abc9_check_result(const std::string &tempdir_name, const std::string &command, int ret)
+{
+	if (ret != 0) {
+		if (check_file_exists(stringf("%s/output.aig", tempdir_name.c_str())))
+			log_warning("ABC: execution of command \"%s\" failed: return code %d.\n", command.c_str(), ret);
+		else
+			log_error("ABC: execution of command \"%s\" failed: return code %d.\n", command.c_str(), ret);
+	}
+}
+
 void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe_file,
 		vector<int> lut_costs, bool dff_mode, std::string delay_target, std::string /*lutin_shared*/, bool fast_mode,
 		bool show_tempdir, std::string box_file, std::string lut_file,
 		std::vector<std::string> liberty_files, std::string wire_delay, std::string tempdir_name,
-		std::string constr_file, std::vector<std::string> dont_use_cells, std::vector<std::string> genlib_files)
+		std::string constr_file, std::vector<std::string> dont_use_cells, std::vector<std::string> genlib_files, bool prep_only, bool in_memory)
 {
 	std::string abc9_script;
 
@@ -254,6 +266,10 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 	}
 	abc9_script += "; time";
 	abc9_script = add_echos_to_abc9_cmd(abc9_script);
+#ifdef YOSYS_LINK_ABC
+	// Cmd_CommandExecute() takes the script as one ';'-separated line.
+	std::string abc9_inline_script = abc9_script;
+#endif
 
 	for (size_t i = 0; i+1 < abc9_script.size(); i++)
 		if (abc9_script[i] == ';' && abc9_script[i+1] == ' ')
@@ -277,13 +293,22 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 		fclose(f);
 	}
 
+#ifndef YOSYS_LINK_ABC
+	(void)in_memory;
+	if (prep_only) {
+		buffer = stringf("\"%s\" -s -f %s/abc.script", exe_file.c_str(), tempdir_name.c_str());
+		log("Prepared ABC command: %s\n", replace_tempdir(buffer, tempdir_name, show_tempdir).c_str());
+		design->scratchpad_set_string("abc9_exe.command", buffer);
+		return;
+	}
+
 	buffer = stringf("\"%s\" -s -f %s/abc.script 2>&1", exe_file.c_str(), tempdir_name.c_str());
 	log("Running ABC command: %s\n", replace_tempdir(buffer, tempdir_name, show_tempdir).c_str());
 
-#ifndef YOSYS_LINK_ABC
 	abc9_output_filter filt(tempdir_name, show_tempdir);
 	int ret = run_command(buffer, std::bind(&abc9_output_filter::next_line, filt, std::placeholders::_1));
 #else
+	(void)prep_only;
 	string temp_stdouterr_name = stringf("%s/stdouterr.txt", tempdir_name.c_str());
 	FILE *temp_stdouterr_w = fopen(temp_stdouterr_name.c_str(), "w");
 	if (temp_stdouterr_w == NULL)
@@ -302,19 +327,32 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 	fd_renumber(fileno(temp_stdouterr_w), fileno(stdout));
 	fd_renumber(fileno(temp_stdouterr_w), fileno(stderr));
 	fclose(temp_stdouterr_w);
-	// These needs to be mutable, supposedly due to getopt
-	char *abc9_argv[5];
-	string tmp_script_name = stringf("%s/abc.script", tempdir_name.c_str());
-	abc9_argv[0] = strdup(exe_file.c_str());
-	abc9_argv[1] = strdup("-s");
-	abc9_argv[2] = strdup("-f");
-	abc9_argv[3] = strdup(tmp_script_name.c_str());
-	abc9_argv[4] = 0;
-	int ret = abc::Abc_RealMain(4, abc9_argv);
-	free(abc9_argv[0]);
-	free(abc9_argv[1]);
-	free(abc9_argv[2]);
-	free(abc9_argv[3]);
+	int ret;
+	if (in_memory) {
+		buffer = abc9_inline_script;
+		log("Running linked ABC script: %s\n", replace_tempdir(buffer, tempdir_name, show_tempdir).c_str());
+		abc::Abc_Start();
+		std::vector<char> script_buffer(abc9_inline_script.begin(), abc9_inline_script.end());
+		script_buffer.push_back(0);
+		ret = abc::Cmd_CommandExecute(abc::Abc_FrameGetGlobalFrame(), script_buffer.data());
+		abc::Abc_Stop();
+	} else {
+		buffer = stringf("\"%s\" -s -f %s/abc.script 2>&1", exe_file.c_str(), tempdir_name.c_str());
+		log("Running ABC command: %s\n", replace_tempdir(buffer, tempdir_name, show_tempdir).c_str());
+		// These needs to be mutable, supposedly due to getopt
+		char *abc9_argv[5];
+		string tmp_script_name = stringf("%s/abc.script", tempdir_name.c_str());
+		abc9_argv[0] = strdup(exe_file.c_str());
+		abc9_argv[1] = strdup("-s");
+		abc9_argv[2] = strdup("-f");
+		abc9_argv[3] = strdup(tmp_script_name.c_str());
+		abc9_argv[4] = 0;
+		ret = abc::Abc_RealMain(4, abc9_argv);
+		free(abc9_argv[0]);
+		free(abc9_argv[1]);
+		free(abc9_argv[2]);
+		free(abc9_argv[3]);
+	}
 	fflush(stdout);
 	fflush(stderr);
 	fd_renumber(fileno(old_stdout), fileno(stdout));
@@ -327,12 +365,7 @@ void abc9_module(RTLIL::Design *design, std::string script_file, std::string exe
 		filt.next_line(line + "\n");
 	temp_stdouterr_r.close();
 #endif
-	if (ret != 0) {
-		if (check_file_exists(stringf("%s/output.aig", tempdir_name.c_str())))
-			log_warning("ABC: execution of command \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
-		else
-			log_error("ABC: execution of command \"%s\" failed: return code %d.\n", buffer.c_str(), ret);
-	}
+	abc9_check_result(tempdir_name, buffer, ret);
 }
 
 struct Abc9ExePass : public Pass {
@@ -434,6 +467,16 @@ struct Abc9ExePass : public Pass {
 		log("        file is expected. temporary files will be created in this directory, and\n");
 		log("        the mapped result will be written to 'output.aig'.\n");
 		log("\n");
+		log("    -prep_only\n");
+		log("        only write the ABC script (and LUT library) into the -cwd directory and\n");
+		log("        store the command that runs it in the scratchpad variable\n");
+		log("        'abc9_exe.command', without running ABC. this is used by 'abc9 -j'.\n");
+		log("\n");
+		log("    -in_memory\n");
+		log("        run the script with Cmd_CommandExecute() of the linked ABC instead of\n");
+		log("        through its command line entry point. this requires yosys to be built\n");
+		log("        with a linked ABC (experimental).\n");
+		log("\n");
 		log("Note that this is a logic optimization pass within Yosys that is calling ABC\n");
 		log("internally. This is not going to \"run ABC on your design\". It will instead run\n");
 		log("ABC on logic snippets extracted from your design. You will not get any useful\n");
@@ -454,7 +497,7 @@ struct Abc9ExePass : public Pass {
 		std::string delay_target, lutin_shared = "-S 1", wire_delay;
 		std::string tempdir_name;
 		bool fast_mode = false, dff_mode = false;
-		bool show_tempdir = false;
+		bool show_tempdir = false, prep_only = false, in_memory = false;
 		vector<int> lut_costs;
 
 #if 0
@@ -538,6 +581,14 @@ struct Abc9ExePass : public Pass {
 				tempdir_name = args[++argidx];
 				continue;
 			}
+			if (arg == "-prep_only") {
+				prep_only = true;
+				continue;
+			}
+			if (arg == "-in_memory") {
+				in_memory = true;
+				continue;
+			}
 			if (arg == "-liberty" && argidx+1 < args.size()) {
 				rewrite_filename(args[argidx+1]);
 				liberty_files.push_back(args[++argidx]);
@@ -619,11 +670,30 @@ struct Abc9ExePass : public Pass {
 		if (!genlib_files.empty() && !dont_use_cells.empty())
 			log_cmd_error("abc9_exe '-genlib' is incompatible with '-dont_use'.\n");
 
+#ifdef YOSYS_LINK_ABC
+		if (prep_only)
+			log_cmd_error("abc9_exe '-prep_only' is not supported with a linked ABC.\n");
+#else
+		if (in_memory)
+			log_cmd_error("abc9_exe '-in_memory' requires yosys to be built with a linked ABC.\n");
+#endif
+
 		abc9_module(design, script_file, exe_file, lut_costs, dff_mode,
 				delay_target, lutin_shared, fast_mode, show_tempdir,
 				box_file, lut_file, liberty_files, wire_delay, tempdir_name,
-				constr_file, dont_use_cells, genlib_files);
+				constr_file, dont_use_cells, genlib_files, prep_only, in_memory);
 	}
 } Abc9ExePass;
 
 PRIVATE_NAMESPACE_END
+
+// Used by `abc9 -j` for ABC processes that were started from a command prepared
+// with `abc9_exe -prep_only`, once their output has been collected.
+void abc9_exe_finish(const std::string &tempdir_name, bool show_tempdir, const std::string &command,
+		const std::vector<std::string> &output, int ret)
+{
+	abc9_output_filter filt(tempdir_name, show_tempdir);
+	for (auto &line : output)
+		filt.next_line(line);
+	abc9_check_result(tempdir_name, command, ret);
+}
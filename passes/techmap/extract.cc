@@ -368,6 +368,11 @@ struct ExtractPass : public Pass {
 		log("    -verbose\n");
 		log("        print debug output while analyzing\n");
 		log("\n");
+		log("    -prune\n");
+		log("        rule out candidate cells by the types of their neighbours before the\n");
+		log("        search. The matches are the same. This is experimental and has not\n");
+		log("        been found to be faster.\n");
+		log("\n");
 		log("    -constports\n");
 		log("        also find instances with constant drivers. this may be much\n");
 		log("        slower than the normal operation.\n");
@@ -495,6 +500,10 @@ struct ExtractPass : public Pass {
 				solver.setVerbose();
 				continue;
 			}
+			if (args[argidx] == "-prune") {
+				solver.setNeighbourhoodPruning();
+				continue;
+			}
 			if (args[argidx] == "-constports") {
 				constports = true;
 				continue;
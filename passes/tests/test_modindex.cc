@@ -0,0 +1,182 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+#include "kernel/modtools.h"
+#include <chrono>
+#include <fstream>
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+// Resident set size in bytes, or 0 where it can't be queried.
+static double resident_bytes()
+{
+#ifdef __linux__
+	std::ifstream statm("/proc/self/statm");
+	size_t total = 0, resident = 0;
+	if (statm >> total >> resident)
+		return double(resident) * sysconf(_SC_PAGESIZE);
+#endif
+	return 0;
+}
+
+static std::string portbit_str(RTLIL::Cell *cell, RTLIL::IdString port, int offset)
+{
+	return stringf("%s.%s[%d]", cell->name.c_str(), port.c_str(), offset);
+}
+
+template<typename T>
+static std::vector<std::string> sorted_portbits(const T &ports)
+{
+	std::vector<std::string> result;
+	for (auto &pbit : ports)
+		result.push_back(portbit_str(pbit.cell, pbit.port, pbit.offset));
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+template<typename T>
+static std::vector<RTLIL::SigBit> sorted_bits(const T &bits)
+{
+	std::vector<RTLIL::SigBit> result(bits.begin(), bits.end());
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+static void compare_with_modwalker(RTLIL::Module *module, const ModConnIndex &index)
+{
+	ModWalker walker(module->design, module);
+
+	auto empty_if_missing = [](const dict<RTLIL::SigBit, pool<ModWalker::PortBit>> &db, RTLIL::SigBit bit) {
+		auto it = db.find(bit);
+		return it == db.end() ? std::vector<std::string>() : sorted_portbits(it->second);
+	};
+
+	for (auto wire : module->wires())
+		for (auto bit : walker.sigmap(wire)) {
+			if (bit.wire == nullptr)
+				continue;
+			if (sorted_portbits(index.drivers(bit)) != empty_if_missing(walker.signal_drivers, bit))
+				log_error("Drivers of %s differ from ModWalker.\n", log_signal(bit));
+			if (sorted_portbits(index.consumers(bit)) != empty_if_missing(walker.signal_consumers, bit))
+				log_error("Consumers of %s differ from ModWalker.\n", log_signal(bit));
+			if (index.is_input(bit) != (walker.signal_inputs.count(bit) != 0) ||
+					index.is_output(bit) != (walker.signal_outputs.count(bit) != 0))
+				log_error("Port flags of %s differ from ModWalker.\n", log_signal(bit));
+		}
+
+	for (auto cell : module->cells()) {
+		auto in_it = walker.cell_inputs.find(cell);
+		auto out_it = walker.cell_outputs.find(cell);
+		std::vector<RTLIL::SigBit> none;
+		if (sorted_bits(index.cell_inputs(cell)) != (in_it == walker.cell_inputs.end() ? none : sorted_bits(in_it->second)))
+			log_error("Input bits of %s differ from ModWalker.\n", log_id(cell));
+		if (sorted_bits(index.cell_outputs(cell)) != (out_it == walker.cell_outputs.end() ? none : sorted_bits(out_it->second)))
+			log_error("Output bits of %s differ from ModWalker.\n", log_id(cell));
+	}
+}
+
+struct TestModIndexPass : public Pass {
+	TestModIndexPass() : Pass("test_modindex", "compare ModConnIndex with ModIndex and ModWalker") { }
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    test_modindex [-iter <N>] [selection]\n");
+		log("\n");
+		log("For each selected module, check that the connectivity reported by ModConnIndex\n");
+		log("matches ModWalker, then build ModIndex, ModWalker and ModConnIndex <N> times\n");
+		log("each (default 1) and report the build times and the memory held by each index.\n");
+		log("The memory figures are resident set size differences and only available on\n");
+		log("Linux.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		log_header(design, "Executing TEST_MODINDEX pass.\n");
+
+		int iterations = 1;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-iter" && argidx+1 < args.size()) {
+				iterations = std::max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		for (auto module : design->selected_whole_modules_warn())
+		{
+			// Measure memory first, while the heap has no freed blocks of
+			// the same shape left over, and keep all three indices alive
+			// so that one does not reuse memory released by another.
+			double rss_before = resident_bytes();
+			ModConnIndex connindex(module);
+			double rss_connindex = resident_bytes();
+			ModWalker walker(design, module);
+			double rss_walker = resident_bytes();
+			ModIndex index(module);
+			index.query(State::S0);
+			double rss_index = resident_bytes();
+
+			compare_with_modwalker(module, connindex);
+
+			// Bits of wires added after the snapshot are not known to it
+			RTLIL::Wire *late_wire = module->addWire(NEW_ID, 2);
+			RTLIL::SigSpec late_sig(late_wire);
+			if (connindex.bit_id(late_sig[0]) != -1 || connindex.has_drivers(late_sig) || connindex.has_consumers(late_sig) ||
+					connindex.has_inputs(late_sig) || connindex.has_outputs(late_sig))
+				log_error("Wire added after building ModConnIndex has connectivity.\n");
+			module->remove({late_wire});
+
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				ModIndex tmp(module);
+				tmp.query(State::S0);
+			}
+			double index_time = seconds_since(start);
+
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+				ModWalker tmp(design, module);
+			double walker_time = seconds_since(start);
+
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+				ModConnIndex tmp(module);
+			double connindex_time = seconds_since(start);
+
+			log("Module %s: %d bits, %d cells.\n", log_id(module), connindex.num_bits(), GetSize(module->cells()));
+			log("  ModIndex:     %8.3f ms per build, %8.1f KiB\n", 1e3 * index_time / iterations, (rss_index - rss_walker) / 1024.0);
+			log("  ModWalker:    %8.3f ms per build, %8.1f KiB\n", 1e3 * walker_time / iterations, (rss_walker - rss_connindex) / 1024.0);
+			log("  ModConnIndex: %8.3f ms per build, %8.1f KiB (%.1f KiB without SigMap)\n", 1e3 * connindex_time / iterations,
+					(rss_connindex - rss_before) / 1024.0, connindex.memory_usage() / 1024.0);
+		}
+	}
+} TestModIndexPass;
+
+PRIVATE_NAMESPACE_END
@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "cxxrtl/cxxrtl.h"
+#include "cxxrtl/cxxrtl_replay.h"
+
+// Measures the latency of seeking in a replay log depending on its length and on the checkpoint interval of
+// the recorder. This is not run by run-test.sh; build and run it by hand:
+//
+//   g++ -std=c++11 -O2 -I../../backends/cxxrtl/runtime -o bench_replay_seek bench_replay_seek.cc
+//   for n in 10000 100000 1000000; do ./bench_replay_seek $n 0; ./bench_replay_seek $n 1000; done
+
+struct design {
+    cxxrtl::value<32> in;
+    cxxrtl::wire<64> regs[16];
+
+    void debug_info(cxxrtl::debug_items &items) {
+        items.add("top in", cxxrtl::debug_item(in, 0, cxxrtl::debug_item::INPUT));
+        for (size_t n = 0; n < 16; n++)
+            items.add("top regs" + std::to_string(n), cxxrtl::debug_item(regs[n], 0, cxxrtl::debug_item::DRIVEN_SYNC));
+    }
+
+    template<class ObserverT>
+    bool commit(ObserverT &observer) {
+        bool changed = false;
+        for (auto &reg : regs)
+            changed |= reg.commit(observer);
+        return changed;
+    }
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <samples> <checkpoint-interval>\n", argv[0]);
+        return 1;
+    }
+
+    const size_t samples = atoll(argv[1]);
+    const size_t interval = atoll(argv[2]);
+    const char *filename = "bench_replay_seek.log";
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        design dut;
+        cxxrtl::debug_items items;
+        dut.debug_info(items);
+        cxxrtl::spool spool(filename);
+        cxxrtl::recorder recorder(spool);
+        recorder.set_checkpoint_interval(interval);
+        recorder.start(items);
+        recorder.record_complete();
+        for (size_t step = 0; step < samples; step++) {
+            recorder.advance_time(cxxrtl::time(0, 1000));
+            dut.in.set<uint32_t>(step * 2654435761u);
+            // Only a few registers change in each step, as in a typical design.
+            auto &reg = dut.regs[step % 16];
+            reg.next = reg.curr.add(dut.in.zext<64>());
+            recorder.record_incremental(dut);
+        }
+    }
+    double record_time = seconds_since(start);
+
+    design dut;
+    cxxrtl::debug_items items;
+    dut.debug_info(items);
+    cxxrtl::spool spool(filename);
+    cxxrtl::player player(spool);
+    player.start(items);
+
+    // The first seek to the end of the log also builds the index.
+    start = std::chrono::steady_clock::now();
+    player.rewind_to(samples, nullptr);
+    double first_seek_time = seconds_since(start);
+
+    const int seeks = 100;
+    std::mt19937 rng(1);
+    start = std::chrono::steady_clock::now();
+    for (int n = 0; n < seeks; n++)
+        player.rewind_to(rng() % (samples + 1), nullptr);
+    double seek_time = seconds_since(start);
+
+    printf("%zu samples, checkpoint interval %zu: recorded in %.3f s, first seek %.3f ms, random seek %.3f ms\n",
+           samples, interval, record_time, 1e3 * first_seek_time, 1e3 * seek_time / seeks);
+    return 0;
+}
@@ -5,13 +5,25 @@ set -ex
 run_subtest () {
     local subtest=$1; shift
 
-    ${CC:-gcc} -std=c++11 -O2 -o cxxrtl-test-${subtest} -I../../backends/cxxrtl/runtime test_${subtest}.cc -lstdc++
+    ${CC:-gcc} -std=c++11 -O2 -o cxxrtl-test-${subtest} -I../../backends/cxxrtl/runtime test_${subtest}.cc -lstdc++ -pthread
     ./cxxrtl-test-${subtest}
 }
 
 run_subtest value
 run_subtest value_fuzz
+run_subtest vcd_async
+run_subtest replay_checkpoint
+
+# C API of the asynchronous VCD writer.
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-test-capi_vcd_async -I../../backends/cxxrtl/runtime test_capi_vcd_async.cc \
+    ../../backends/cxxrtl/runtime/cxxrtl/capi/cxxrtl_capi.cc ../../backends/cxxrtl/runtime/cxxrtl/capi/cxxrtl_capi_vcd.cc -lstdc++ -pthread
+./cxxrtl-test-capi_vcd_async
 
 # Compile-only test.
 ../../yosys -p "read_verilog test_unconnected_output.v; select =*; proc; clean; write_cxxrtl cxxrtl-test-unconnected_output.cc"
 ${CC:-gcc} -std=c++11 -c -o cxxrtl-test-unconnected_output -I../../backends/cxxrtl/runtime cxxrtl-test-unconnected_output.cc
+
+# Activity tracking must not change the simulation results.
+../../yosys -p "read_verilog test_activity.v; write_cxxrtl -noflatten -namespace ref cxxrtl-test-activity-ref.cc; write_cxxrtl -noflatten -activity -namespace act cxxrtl-test-activity-act.cc"
+${CC:-gcc} -std=c++11 -O2 -o cxxrtl-test-activity -I../../backends/cxxrtl/runtime -I. test_activity.cc -lstdc++
+./cxxrtl-test-activity
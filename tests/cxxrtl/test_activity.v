@@ -0,0 +1,11 @@
+module counter(input clk, input en, input [7:0] din, output reg [15:0] q);
+	always @(posedge clk)
+		if (en)
+			q <= q + din;
+endmodule
+
+module top(input clk_a, input clk_b, input en, input [7:0] din, output [15:0] qa, output [15:0] qb, output [15:0] sum);
+	counter a(.clk(clk_a), .en(en), .din(din), .q(qa));
+	counter b(.clk(clk_b), .en(en), .din(din ^ 8'h5a), .q(qb));
+	assign sum = qa + qb;
+endmodule
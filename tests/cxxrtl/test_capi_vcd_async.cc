@@ -0,0 +1,71 @@
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "cxxrtl/cxxrtl.h"
+#include "cxxrtl/capi/cxxrtl_capi_vcd.h"
+
+struct signals {
+    cxxrtl::value<1> bit;
+    cxxrtl::value<8> byte;
+    cxxrtl::value<70> wide;
+    cxxrtl::debug_item bit_item { bit }, byte_item { byte }, wide_item { wide };
+
+    cxxrtl_vcd create_vcd() {
+        cxxrtl_vcd vcd = cxxrtl_vcd_create();
+        cxxrtl_vcd_timescale(vcd, 1, "ns");
+        cxxrtl_vcd_add(vcd, "top bit", &bit_item);
+        cxxrtl_vcd_add(vcd, "top byte", &byte_item);
+        cxxrtl_vcd_add(vcd, "top sub wide", &wide_item);
+        return vcd;
+    }
+};
+
+static void read_all(cxxrtl_vcd vcd, std::string &output) {
+    const char *data;
+    size_t size;
+    do {
+        cxxrtl_vcd_read(vcd, &data, &size);
+        output.append(data, size);
+    } while (size != 0);
+}
+
+static void append_to_string(void *data, const char *buf, size_t size) {
+    static_cast<std::string *>(data)->append(buf, size);
+}
+
+int main()
+{
+    signals sync_signals, async_signals;
+    cxxrtl_vcd sync_vcd = sync_signals.create_vcd();
+    cxxrtl_vcd async_vcd = async_signals.create_vcd();
+
+    std::string sync_output, async_output;
+    // A tiny ring buffer makes the simulation thread wait for the background thread.
+    cxxrtl_vcd_start_async(async_vcd, 64, &async_output, append_to_string);
+
+    std::mt19937 rng(1);
+    for (uint64_t step = 0; step < 5000; step++) {
+        if (rng() % 2)
+            sync_signals.bit.data[0] = async_signals.bit.data[0] = rng() % 2;
+        if (rng() % 3 == 0)
+            sync_signals.byte.data[0] = async_signals.byte.data[0] = rng() & 0xff;
+        if (rng() % 5 == 0)
+            for (size_t n = 0; n < sync_signals.wide.chunks; n++)
+                sync_signals.wide.data[n] = async_signals.wide.data[n] = rng() & (n == 2 ? 0x3f : ~0u);
+        cxxrtl_vcd_sample(sync_vcd, step);
+        read_all(sync_vcd, sync_output);
+        cxxrtl_vcd_sample(async_vcd, step);
+        if (step == 2500) {
+            cxxrtl_vcd_flush(async_vcd);
+            assert(async_output == sync_output);
+        }
+    }
+
+    // Destroying the writer flushes the remaining data.
+    cxxrtl_vcd_destroy(async_vcd);
+    cxxrtl_vcd_destroy(sync_vcd);
+    assert(async_output == sync_output);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "cxxrtl/cxxrtl.h"
+#include "cxxrtl/cxxrtl_replay.h"
+
+struct design {
+    cxxrtl::value<8> in;
+    cxxrtl::wire<40> acc;
+    cxxrtl::memory<8> mem { 4 };
+
+    void debug_info(cxxrtl::debug_items &items) {
+        items.add("top in", cxxrtl::debug_item(in, 0, cxxrtl::debug_item::INPUT));
+        items.add("top acc", cxxrtl::debug_item(acc, 0, cxxrtl::debug_item::DRIVEN_SYNC));
+        items.add("top mem", cxxrtl::debug_item(mem));
+    }
+
+    template<class ObserverT>
+    bool commit(ObserverT &observer) {
+        bool changed = false;
+        changed |= acc.commit(observer);
+        changed |= mem.commit(observer);
+        return changed;
+    }
+};
+
+struct sample {
+    uint64_t in, acc, mem;
+    cxxrtl::time timestamp;
+};
+
+uint64_t mem_value(const design &dut) {
+    uint64_t result = 0;
+    for (size_t index = 0; index < 4; index++)
+        result |= dut.mem[index].get<uint64_t>() << (8 * index);
+    return result;
+}
+
+std::vector<sample> record(const char *filename, size_t checkpoint_interval)
+{
+    design dut;
+    cxxrtl::debug_items items;
+    dut.debug_info(items);
+
+    std::vector<sample> samples;
+    cxxrtl::spool spool(filename);
+    cxxrtl::recorder recorder(spool);
+    recorder.set_checkpoint_interval(checkpoint_interval);
+    recorder.start(items);
+    recorder.record_complete();
+    samples.push_back({dut.in.get<uint64_t>(), dut.acc.curr.get<uint64_t>(), mem_value(dut), recorder.latest_time()});
+
+    std::mt19937 rng(1);
+    for (int step = 0; step < 3000; step++) {
+        // Several delta cycles per time step, and an occasional diagnostic.
+        if (step % 3 == 0)
+            recorder.advance_time(cxxrtl::time(0, 1000));
+        if (step % 100 == 50) {
+            recorder.record_diagnostic(cxxrtl::diagnostic(cxxrtl::diagnostic::PRINT, "hello", __FILE__, __LINE__));
+            samples.push_back({dut.in.get<uint64_t>(), dut.acc.curr.get<uint64_t>(), mem_value(dut), recorder.latest_time()});
+        }
+        dut.in.set<uint32_t>(rng() & 0xff);
+        dut.acc.next = dut.acc.curr.add(dut.in.zext<40>());
+        dut.mem.update(step % 4, dut.in, cxxrtl::value<8>(0xffu));
+        recorder.record_incremental(dut);
+        samples.push_back({dut.in.get<uint64_t>(), dut.acc.curr.get<uint64_t>(), mem_value(dut), recorder.latest_time()});
+    }
+    return samples;
+}
+
+void check(const char *filename, const std::vector<sample> &samples)
+{
+    design dut;
+    cxxrtl::debug_items items;
+    dut.debug_info(items);
+
+    cxxrtl::spool spool(filename);
+    cxxrtl::player player(spool);
+    player.start(items);
+
+    std::mt19937 rng(2);
+    for (int seek = 0; seek < 200; seek++) {
+        cxxrtl::spool::pointer_t pointer = rng() % samples.size();
+        assert(player.rewind_to(pointer, nullptr));
+        assert(player.current_pointer() == pointer);
+        assert(dut.in.get<uint64_t>() == samples[pointer].in);
+        assert(dut.acc.curr.get<uint64_t>() == samples[pointer].acc);
+        assert(mem_value(dut) == samples[pointer].mem);
+
+        // Rewinding to a time lands on the first sample with that time.
+        const cxxrtl::time &timestamp = samples[rng() % samples.size()].timestamp;
+        assert(player.rewind_to_or_before(timestamp, nullptr));
+        size_t first = 0;
+        while (samples[first].timestamp != timestamp)
+            first++;
+        assert(player.current_pointer() == first);
+        assert(dut.acc.curr.get<uint64_t>() == samples[first].acc);
+    }
+}
+
+int main()
+{
+    for (size_t interval : {0, 1, 16}) {
+        std::vector<sample> samples = record("cxxrtl-test-replay_checkpoint.log", interval);
+        check("cxxrtl-test-replay_checkpoint.log", samples);
+    }
+    return 0;
+}
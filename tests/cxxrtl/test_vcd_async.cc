@@ -0,0 +1,55 @@
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "cxxrtl/cxxrtl.h"
+#include "cxxrtl/cxxrtl_vcd.h"
+
+struct signals {
+    cxxrtl::value<1> bit;
+    cxxrtl::value<8> byte;
+    cxxrtl::value<70> wide;
+
+    void add_to(cxxrtl::vcd_writer &writer) {
+        writer.timescale(1, "ns");
+        writer.add("top bit", cxxrtl::debug_item(bit));
+        writer.add("top byte", cxxrtl::debug_item(byte));
+        writer.add("top sub wide", cxxrtl::debug_item(wide));
+    }
+};
+
+int main()
+{
+    signals sync_signals, async_signals;
+    cxxrtl::vcd_writer sync_writer, async_writer;
+    sync_signals.add_to(sync_writer);
+    async_signals.add_to(async_writer);
+
+    std::string async_output;
+    {
+        // A tiny ring buffer makes the simulation thread wait for the background thread.
+        cxxrtl::vcd_async_writer writer(async_writer, [&](const char *data, size_t size) {
+            async_output.append(data, size);
+        }, 64);
+
+        std::mt19937 rng(1);
+        for (uint64_t step = 0; step < 5000; step++) {
+            if (rng() % 2)
+                sync_signals.bit.data[0] = async_signals.bit.data[0] = rng() % 2;
+            if (rng() % 3 == 0)
+                sync_signals.byte.data[0] = async_signals.byte.data[0] = rng() & 0xff;
+            if (rng() % 5 == 0)
+                for (size_t n = 0; n < sync_signals.wide.chunks; n++)
+                    sync_signals.wide.data[n] = async_signals.wide.data[n] = rng() & (n == 2 ? 0x3f : ~0u);
+            sync_writer.sample(step);
+            writer.sample(step);
+            if (step == 2500) {
+                writer.flush();
+                assert(async_output == sync_writer.buffer);
+            }
+        }
+    }
+    assert(async_output == sync_writer.buffer);
+    return 0;
+}
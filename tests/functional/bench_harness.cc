@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "my_module_functional_cxx.cc"
+
+// Runs the model for a number of steps and reports the throughput, followed by
+// a checksum of the final outputs and state, so that runs can be compared
+// across changes to the runtime.
+
+template <size_t n> Signal<n> random_signal(std::mt19937 &gen)
+{
+	std::uniform_int_distribution<uint32_t> dist;
+	std::array<uint32_t, (n + 31) / 32> words;
+	for (auto &w : words)
+		w = dist(gen);
+	return Signal<n>::from_array(words);
+}
+
+struct Randomize {
+	std::mt19937 &gen;
+	Randomize(std::mt19937 &gen) : gen(gen) {}
+
+	template <size_t n> void operator()(const char *, Signal<n> &signal) { signal = random_signal<n>(gen); }
+};
+
+struct Checksum {
+	uint64_t hash = 0xcbf29ce484222325;
+
+	void add(bool bit) { hash = (hash ^ bit) * 0x100000001b3; }
+	template <size_t n> void operator()(const char *, Signal<n> const &signal)
+	{
+		for (size_t i = 0; i < n; i++)
+			add(signal[i]);
+	}
+	template <size_t a, size_t d> void operator()(const char *name, Memory<a, d> const &memory)
+	{
+		for (size_t i = 0; i < (size_t)1 << a; i++)
+			(*this)(name, memory.read(Signal<a>(i)));
+	}
+};
+
+int main(int argc, char **argv)
+{
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <steps> <seed>\n";
+		return 1;
+	}
+
+	const int steps = atoi(argv[1]);
+	const uint32_t seed = atoi(argv[2]);
+
+	// generate the inputs up front so that the timed loop only runs the model
+	std::mt19937 gen(seed);
+	std::vector<gold::Inputs> inputs(256);
+	for (auto &in : inputs)
+		in.visit(Randomize(gen));
+
+	gold::Outputs outputs;
+	gold::State state;
+	gold::State next_state;
+
+	auto start = std::chrono::steady_clock::now();
+	gold::initialize(state);
+	for (int step = 0; step < steps; ++step) {
+		gold::eval(inputs[step % inputs.size()], outputs, state, next_state);
+		state = next_state;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	Checksum checksum;
+	outputs.visit(checksum);
+	state.visit(checksum);
+	printf("%d steps in %.3f s, %.0f steps/s, checksum %016llx\n", steps, seconds, steps / seconds, (unsigned long long)checksum.hash);
+	return 0;
+}
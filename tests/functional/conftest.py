@@ -7,6 +7,7 @@ random_seed = random.getrandbits(32)
 def pytest_configure(config):
     config.addinivalue_line("markers", "smt: test uses smtlib/z3")
     config.addinivalue_line("markers", "rkt: test uses racket/rosette")
+    config.addinivalue_line("markers", "bench: benchmarks models built against the C++ runtime")
 
 def pytest_addoption(parser):
     parser.addoption("--per-cell", type=int, default=None, help="run only N tests per cell")
@@ -87,6 +87,40 @@ def test_rkt(cell, parameters, tmp_path, num_steps, rnd):
     rkt_vcd.simulate_rosette(rkt_file, vcd_functional_file, num_steps, rnd(cell.name + "-rkt"))
     yosys_sim(rtlil_file, vcd_functional_file, vcd_yosys_sim_file, getattr(cell, 'sim_preprocessing', ''))
 
+from rtlil_cells import PicorvCell, MemCell, BinaryCell
+bench_cases = [
+    ('picorv', PicorvCell(), {}),
+    ('mem-32x1024', MemCell('mem', []), {'DATA_WIDTH': 32, 'ADDR_WIDTH': 10}),
+    ('mul-128', BinaryCell('mul', []), {'A_WIDTH': 128, 'B_WIDTH': 128, 'Y_WIDTH': 128, 'A_SIGNED': 0, 'B_SIGNED': 0}),
+]
+
+# report the throughput of models built against the C++ runtime, after checking
+# the same model against yosys sim as in test_cxx
+@pytest.mark.bench
+@pytest.mark.parametrize("bench_cell,bench_parameters", [(c, p) for _, c, p in bench_cases], ids=[n for n, _, _ in bench_cases])
+def test_cxx_bench(bench_cell, bench_parameters, tmp_path, num_steps, rnd):
+    rtlil_file = tmp_path / 'rtlil.il'
+    vcdharness_cc_file = base_path / 'tests/functional/vcd_harness.cc'
+    bench_harness_cc_file = base_path / 'tests/functional/bench_harness.cc'
+    cc_file = tmp_path / 'my_module_functional_cxx.cc'
+    vcdharness_exe_file = tmp_path / 'a.out'
+    bench_exe_file = tmp_path / 'bench.out'
+    vcd_functional_file = tmp_path / 'functional.vcd'
+    vcd_yosys_sim_file = tmp_path / 'yosys.vcd'
+    runtime_path = str(base_path / 'backends/functional/cxx_runtime')
+
+    bench_cell.write_rtlil_file(rtlil_file, bench_parameters)
+    yosys(f"read_rtlil {quote(rtlil_file)} ; clk2fflogic ; write_functional_cxx {quote(cc_file)}")
+    seed = str(rnd(bench_cell.name + "-bench").getrandbits(32))
+
+    compile_cpp(vcdharness_cc_file, vcdharness_exe_file, ['-I', tmp_path, '-I', runtime_path])
+    run([str(vcdharness_exe_file.resolve()), str(vcd_functional_file), str(min(num_steps, 1000)), seed])
+    yosys_sim(rtlil_file, vcd_functional_file, vcd_yosys_sim_file, getattr(bench_cell, 'sim_preprocessing', ''))
+
+    compile_cpp(bench_harness_cc_file, bench_exe_file, ['-O2', '-I', tmp_path, '-I', runtime_path])
+    output = subprocess.run([str(bench_exe_file.resolve()), str(num_steps), seed], capture_output=True, check=True, text=True).stdout
+    print(output.strip())
+
 def test_print_graph(tmp_path):
     tb_file = base_path / 'tests/functional/picorv32_tb.v'
     cpu_file = base_path / 'tests/functional/picorv32.v'
@@ -412,6 +412,53 @@ TESTS += [
         Test("sync_2clk_shared", SYNC_2CLK, ["block_sdp_1clk"], [], {"RAM_BLOCK_SDP_1CLK": 0}),
 ]
 
+# several memories of the same shape in one module; the mapping found for the
+# first one is reused for the second, which must still get its own clock
+SYNC_REPEAT = """
+module top(clk1, clk2, we, ra, wa, wd, rd1, rd2, rd3);
+
+localparam ABITS = 6;
+localparam DBITS = 16;
+
+input wire clk1, clk2;
+input wire we;
+input wire [ABITS-1:0] ra, wa;
+input wire [DBITS-1:0] wd;
+output reg [DBITS-1:0] rd1, rd2, rd3;
+
+reg [DBITS-1:0] mem1 [0:2**ABITS-1];
+reg [DBITS-1:0] mem2 [0:2**ABITS-1];
+reg [DBITS-1:0] mem3 [0:2**ABITS-1];
+
+always @(posedge clk1)
+    if (we)
+        mem1[wa] <= wd;
+
+always @(posedge clk1)
+    rd1 <= mem1[ra];
+
+always @(posedge clk2)
+    if (we)
+        mem2[wa] <= wd;
+
+always @(posedge clk2)
+    rd2 <= mem2[ra];
+
+always @(posedge clk1)
+    if (we)
+        mem3[wa] <= wd;
+
+always @(posedge clk2)
+    rd3 <= mem3[ra];
+
+endmodule
+"""
+
+TESTS += [
+        Test("sync_repeat_shared", SYNC_REPEAT, ["block_sdp_1clk"], [], {"RAM_BLOCK_SDP_1CLK": 2}),
+        Test("sync_repeat", SYNC_REPEAT, ["block_sdp"], [], {"RAM_BLOCK_SDP": 3}),
+]
+
 # inter-port transparency
 # Synchronous SDP with write-first behaviour
 SYNC_TRANS = """
@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+set -e
+
+# Simulates picorv32 running the program in tests/functional/picorv32_tb.v,
+# at RTL and at gate level, with and without -compile. Checks that both modes
+# produce the same waveforms and prints the time taken by each sim run. The
+# default step count keeps this short enough for "make test", pass a larger
+# one to benchmark:
+#
+#   bash bench_compile.sh [steps]
+
+steps=${1:-200}
+
+../../yosys -q -p "read_verilog ../functional/picorv32.v ../functional/picorv32_tb.v; prep -top gold; \
+	write_rtlil bench_compile_rtl.il; techmap; opt_clean; write_rtlil bench_compile_gate.il"
+
+for level in rtl gate; do
+	for mode in "" -compile; do
+		start=$(date +%s.%N)
+		../../yosys -q -p "read_rtlil bench_compile_$level.il; sim $mode -clock clk -n $steps -fst bench_compile_$level$mode.fst"
+		end=$(date +%s.%N)
+		awk -v name="$level ${mode:-interpreted}" -v steps=$steps -v start=$start -v end=$end \
+			'BEGIN { printf "%-20s %6d steps %8.2f s\n", name, steps, end - start }'
+	done
+	../../yosys -q -p "read_rtlil bench_compile_$level.il; sim -compile -clock clk -r bench_compile_$level.fst -scope gold -sim-cmp"
+	../../yosys -q -p "read_rtlil bench_compile_$level.il; sim -clock clk -r bench_compile_$level-compile.fst -scope gold -sim-cmp"
+done
+
+rm -f bench_compile_*.il bench_compile_*.fst
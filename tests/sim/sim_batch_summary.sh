@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+set -ex
+
+# With -assert, the summary of all traces is still written before sim fails.
+rm -f sim_batch_summary.json
+cat > sim_batch_summary.v << "EOT"
+module top(input clk, input in);
+	reg [2:0] cnt = 0;
+	always @(posedge clk)
+		if (in)
+			cnt <= cnt + 1;
+	always @*
+		assert (cnt < 3);
+endmodule
+EOT
+
+if ../../yosys -q -p 'read_verilog -formal sim_batch_summary.v; prep -top top; sim -batch batch_pass.yw -batch batch_fail.yw -assert -summary sim_batch_summary.json'; then
+	echo "sim -assert did not fail" >&2
+	exit 1
+fi
+
+test $(grep -c '"file": ' sim_batch_summary.json) -eq 2
+grep -q batch_fail.yw sim_batch_summary.json
+
+rm -f sim_batch_summary.v sim_batch_summary.json
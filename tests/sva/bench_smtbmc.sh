@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+
+# Measures the BMC throughput of yosys-smtbmc on the designs in this directory,
+# once with the regular write_smt2 output and once with write_smt2 -compact.
+# Most of the designs need a frontend with full SVA support (Verific), the
+# others are skipped. This is not part of "make", run it by hand:
+#
+#   bash bench_smtbmc.sh [depth] [solver]
+
+set -e
+
+depth=${1:-200}
+solver=${2:-yices}
+
+for sv in *.sv; do
+	prefix=${sv%.sv}
+	if ! ../../yosys -q -p "read -sv $sv; prep -top top; chformal -early -assume; async2sync; dffunmap; \
+			write_smt2 -wires bench_$prefix.smt2; write_smt2 -wires -compact bench_${prefix}_compact.smt2" 2> /dev/null; then
+		echo "$prefix: skipped, can't be read by this yosys"
+		continue
+	fi
+
+	for variant in "" _compact; do
+		start=$(date +%s.%N)
+		status=0
+		../../yosys-smtbmc -s $solver -t $depth bench_$prefix$variant.smt2 > bench_$prefix$variant.log || status=$?
+		end=$(date +%s.%N)
+		awk -v name="$prefix$variant" -v depth=$depth -v start=$start -v end=$end -v status=$status \
+			'BEGIN { printf "%-40s %6.2f s %10.1f steps/s (exit %d)\n", name, end - start, depth / (end - start), status }'
+	done
+done
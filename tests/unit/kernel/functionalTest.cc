@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include "kernel/functional.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+
+	// Evaluates signal nodes with the RTLIL constant functions. Division by
+	// zero yields zero, as in the C++ runtime.
+	struct Evaluator : Functional::AbstractVisitor<RTLIL::Const> {
+		using Node = Functional::Node;
+		dict<int, RTLIL::Const> &values;
+		dict<IdString, RTLIL::Const> const &inputs, &states;
+		Evaluator(dict<int, RTLIL::Const> &values, dict<IdString, RTLIL::Const> const &inputs, dict<IdString, RTLIL::Const> const &states)
+			: values(values), inputs(inputs), states(states) {}
+
+		RTLIL::Const v(Node n) { return values.at(n.id()); }
+		RTLIL::Const buf(Node, Node a) override { return v(a); }
+		RTLIL::Const slice(Node, Node a, int offset, int out_width) override { return v(a).extract(offset, out_width); }
+		RTLIL::Const zero_extend(Node, Node a, int out_width) override { RTLIL::Const c = v(a); c.extu(out_width); return c; }
+		RTLIL::Const sign_extend(Node, Node a, int out_width) override { RTLIL::Const c = v(a); c.exts(out_width); return c; }
+		RTLIL::Const concat(Node, Node a, Node b) override { RTLIL::Const c = v(a); c.append(v(b)); return c; }
+		RTLIL::Const add(Node self, Node a, Node b) override { return const_add(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const sub(Node self, Node a, Node b) override { return const_sub(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const mul(Node self, Node a, Node b) override { return const_mul(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const unsigned_div(Node self, Node a, Node b) override {
+			return v(b).is_fully_zero() ? RTLIL::Const(0, self.width()) : const_div(v(a), v(b), false, false, self.width());
+		}
+		RTLIL::Const unsigned_mod(Node self, Node a, Node b) override {
+			return v(b).is_fully_zero() ? RTLIL::Const(0, self.width()) : const_mod(v(a), v(b), false, false, self.width());
+		}
+		RTLIL::Const bitwise_and(Node self, Node a, Node b) override { return const_and(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const bitwise_or(Node self, Node a, Node b) override { return const_or(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const bitwise_xor(Node self, Node a, Node b) override { return const_xor(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const bitwise_not(Node self, Node a) override { return const_not(v(a), RTLIL::Const(), false, false, self.width()); }
+		RTLIL::Const unary_minus(Node self, Node a) override { return const_neg(v(a), RTLIL::Const(), false, false, self.width()); }
+		RTLIL::Const reduce_and(Node, Node a) override { return const_reduce_and(v(a), RTLIL::Const(), false, false, 1); }
+		RTLIL::Const reduce_or(Node, Node a) override { return const_reduce_or(v(a), RTLIL::Const(), false, false, 1); }
+		RTLIL::Const reduce_xor(Node, Node a) override { return const_reduce_xor(v(a), RTLIL::Const(), false, false, 1); }
+		RTLIL::Const equal(Node, Node a, Node b) override { return const_eq(v(a), v(b), false, false, 1); }
+		RTLIL::Const not_equal(Node, Node a, Node b) override { return const_ne(v(a), v(b), false, false, 1); }
+		RTLIL::Const signed_greater_than(Node, Node a, Node b) override { return const_gt(v(a), v(b), true, true, 1); }
+		RTLIL::Const signed_greater_equal(Node, Node a, Node b) override { return const_ge(v(a), v(b), true, true, 1); }
+		RTLIL::Const unsigned_greater_than(Node, Node a, Node b) override { return const_gt(v(a), v(b), false, false, 1); }
+		RTLIL::Const unsigned_greater_equal(Node, Node a, Node b) override { return const_ge(v(a), v(b), false, false, 1); }
+		RTLIL::Const logical_shift_left(Node self, Node a, Node b) override { return const_shl(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const logical_shift_right(Node self, Node a, Node b) override { return const_shr(v(a), v(b), false, false, self.width()); }
+		RTLIL::Const arithmetic_shift_right(Node self, Node a, Node b) override { return const_sshr(v(a), v(b), true, false, self.width()); }
+		RTLIL::Const mux(Node, Node a, Node b, Node s) override { return v(s).as_bool() ? v(b) : v(a); }
+		RTLIL::Const constant(Node, RTLIL::Const const &value) override { return value; }
+		RTLIL::Const input(Node, IdString name, IdString) override { return inputs.at(name); }
+		RTLIL::Const state(Node, IdString name, IdString) override { return states.at(name); }
+		RTLIL::Const memory_read(Node, Node, Node) override { log_abort(); }
+		RTLIL::Const memory_write(Node, Node, Node, Node) override { log_abort(); }
+	};
+
+	// returns the outputs followed by the next state values
+	std::vector<RTLIL::Const> evaluate(Functional::IR &ir, dict<IdString, RTLIL::Const> const &inputs, dict<IdString, RTLIL::Const> const &states)
+	{
+		dict<int, RTLIL::Const> values;
+		Evaluator evaluator(values, inputs, states);
+		for (auto node : ir)
+			values[node.id()] = node.visit(evaluator);
+		std::vector<RTLIL::Const> result;
+		for (auto output : ir.outputs())
+			result.push_back(values.at(output->value().id()));
+		for (auto state : ir.states())
+			result.push_back(values.at(state->next_value().id()));
+		return result;
+	}
+
+}
+
+TEST(KernelFunctionalTest, optimizePreservesValues)
+{
+	// the conversion uses the ID:: constants
+	yosys_setup();
+
+	RTLIL::Design design;
+	RTLIL::Module *m = design.addModule(ID(top));
+	auto input = [&](const char *name, int width) {
+		RTLIL::Wire *wire = m->addWire(RTLIL::escape_id(name), width);
+		wire->port_input = true;
+		return wire;
+	};
+	auto output = [&](RTLIL::SigSpec sig) {
+		RTLIL::Wire *wire = m->addWire(NEW_ID, sig.size());
+		wire->port_output = true;
+		m->connect(wire, sig);
+	};
+	RTLIL::SigSpec a = input("a", 8), b = input("b", 8), c = input("c", 16), s = input("s", 1);
+
+	// identities and constants
+	output(m->Add(NEW_ID, a, RTLIL::Const(0, 8)));
+	output(m->Xor(NEW_ID, a, a));
+	output(m->Eq(NEW_ID, a, a));
+	output(m->Mux(NEW_ID, a, b, State::S1));
+	output(m->Sub(NEW_ID, a, m->Add(NEW_ID, RTLIL::Const(3, 8), RTLIL::Const(4, 8))));
+	output(m->Mul(NEW_ID, c, RTLIL::Const(1, 16)));
+	output(m->Div(NEW_ID, a, RTLIL::Const(0, 8)));
+	// duplicates, also with swapped arguments
+	output(m->Add(NEW_ID, a, b));
+	output(m->Add(NEW_ID, b, a));
+	output(m->And(NEW_ID, m->Not(NEW_ID, m->Not(NEW_ID, a)), b));
+	// slices and concatenations
+	RTLIL::SigSpec swapped = {a.extract(0, 4), a.extract(4, 4)};
+	output(m->And(NEW_ID, {swapped.extract(4, 4), swapped.extract(0, 4)}, b));
+	output({c.extract(8, 8), c.extract(0, 8), RTLIL::Const(0, 4)});
+	output(m->Add(NEW_ID, a, c).extract(4, 8));
+	RTLIL::Wire *sum = m->addWire(NEW_ID, 16);
+	m->addAdd(NEW_ID, a, b, sum);
+	output(RTLIL::SigSpec(sum).extract(0, 8));
+	output(m->Not(NEW_ID, {a, b}).extract(0, 8));
+	output(m->Shl(NEW_ID, c, RTLIL::Const(0, 4)));
+	output(m->ReduceOr(NEW_ID, {a, RTLIL::Const(0, 3)}));
+	output(m->Mux(NEW_ID, m->Sub(NEW_ID, c, a), m->Sub(NEW_ID, c, a), s));
+	// state
+	RTLIL::Wire *q = m->addWire(ID(q), 16);
+	m->addFf(NEW_ID, m->Add(NEW_ID, q, {a, a}), q);
+	output(q);
+	m->fixup_ports();
+
+	auto plain = Functional::IR::from_module(m);
+	auto optimized = Functional::IR::from_module(m);
+	Functional::OptimizeStats stats = optimized.optimize();
+	EXPECT_EQ(stats.nodes_before, plain.size());
+	EXPECT_EQ(stats.nodes_after, optimized.size());
+	EXPECT_LT(optimized.size(), plain.size());
+	EXPECT_GT(stats.merged, 0);
+	EXPECT_GT(stats.folded_constants, 0);
+	EXPECT_GT(stats.folded_slices, 0);
+	EXPECT_GT(stats.simplified, 0);
+
+	uint32_t seed = 1;
+	auto rnd = [&](int width) {
+		std::vector<RTLIL::State> bits;
+		for (int i = 0; i < width; i++) {
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			bits.push_back(seed & 1 ? State::S1 : State::S0);
+		}
+		return RTLIL::Const(bits);
+	};
+	for (int i = 0; i < 200; i++) {
+		dict<IdString, RTLIL::Const> inputs, states;
+		for (auto in : plain.inputs())
+			inputs[in->name] = rnd(in->sort.width());
+		for (auto state : plain.states())
+			states[state->name] = rnd(state->sort.width());
+		EXPECT_EQ(evaluate(plain, inputs, states), evaluate(optimized, inputs, states));
+	}
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "kernel/yosys.h"
+
+#include <map>
+
+YOSYS_NAMESPACE_BEGIN
+
+TEST(KernelHashlibTest, dictLinearAndHashedModes)
+{
+	// Grow across hashtable_linear_limit and shrink back, checking against std::map
+	// after every operation.
+	dict<int, int> d;
+	std::map<int, int> ref;
+	auto check = [&]() {
+		ASSERT_EQ(d.size(), ref.size());
+		for (auto &it : ref)
+			EXPECT_EQ(d.at(it.first), it.second);
+		for (auto &it : d)
+			EXPECT_EQ(ref.at(it.first), it.second);
+		EXPECT_EQ(d.count(-1), 0);
+	};
+
+	for (int i = 0; i < 3 * hashlib::hashtable_linear_limit; i++) {
+		d[i] = i;
+		ref[i] = i;
+		check();
+	}
+	for (int i = 0; i < 3 * hashlib::hashtable_linear_limit; i += 2) {
+		d.erase(i);
+		ref.erase(i);
+		check();
+	}
+
+	dict<int, int> copy = d;
+	EXPECT_TRUE(copy == d);
+
+	for (auto it = d.begin(); it != d.end();)
+		it = d.erase(it);
+	EXPECT_TRUE(d.empty());
+	d.emplace(1, 2);
+	EXPECT_EQ(d.at(1), 2);
+}
+
+TEST(KernelHashlibTest, dictLinearModeOrder)
+{
+	dict<RTLIL::IdString, int> d;
+	d[ID::A] = 1;
+	d[ID::B] = 2;
+	d[ID::Y] = 3;
+	d.erase(ID::A);
+	d[ID::A] = 4;
+
+	std::vector<RTLIL::IdString> order;
+	for (auto &it : d)
+		order.push_back(it.first);
+	std::vector<RTLIL::IdString> expected = {ID::A, ID::B, ID::Y};
+	EXPECT_EQ(order, expected);
+}
+
+YOSYS_NAMESPACE_END
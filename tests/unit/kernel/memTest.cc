@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "kernel/mem.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+TEST(KernelMemTest, packedBitsStates)
+{
+	// Start fully defined, then store every kind of state and check that the
+	// lazily allocated planes keep the existing bits intact.
+	MemContents::packed_bits bits(150, State::S1);
+	for (size_t i = 0; i < bits.size(); i++)
+		EXPECT_EQ(bits.get(i), State::S1);
+
+	const State states[] = {State::S0, State::S1, State::Sx, State::Sz, State::Sa, State::Sm};
+	for (size_t i = 0; i < bits.size(); i++)
+		bits.set(i, states[i % 6]);
+	for (size_t i = 0; i < bits.size(); i++)
+		EXPECT_EQ(bits.get(i), states[i % 6]);
+
+	bits.fill(3, 131, State::Sz);
+	for (size_t i = 0; i < bits.size(); i++)
+		EXPECT_EQ(bits.get(i), 3 <= i && i < 131 ? State::Sz : states[i % 6]);
+
+	// shrinking and growing again must not resurrect the old bits
+	bits.resize(70, State::S0);
+	bits.resize(200, State::S0);
+	for (size_t i = 70; i < bits.size(); i++)
+		EXPECT_EQ(bits.get(i), State::S0);
+
+	RTLIL::Const c = bits.extract(60, 16);
+	ASSERT_EQ(c.size(), 16);
+	for (int i = 0; i < 16; i++)
+		EXPECT_EQ(c[i], bits.get(60 + i));
+}
+
+TEST(KernelMemTest, contentsRanges)
+{
+	MemContents mem(8, 4);
+	mem.insert_concatenated(10, RTLIL::Const::from_string("0001001000110100"));
+	mem.insert_concatenated(16, RTLIL::Const::from_string("x1z0"));
+	mem.check();
+	EXPECT_EQ(mem.count_range(0, 256), 5u);
+	EXPECT_EQ(mem[10], RTLIL::Const::from_string("0100"));
+	EXPECT_EQ(mem[13], RTLIL::Const::from_string("0001"));
+	EXPECT_EQ(mem[14], RTLIL::Const(State::Sx, 4));
+
+	// filling the gap merges the two ranges
+	mem.insert_concatenated(14, RTLIL::Const::from_string("11110000"));
+	mem.check();
+	int ranges = 0;
+	for (auto range : mem) {
+		EXPECT_EQ(range.base(), 10u);
+		EXPECT_EQ(range.size(), 7u);
+		EXPECT_EQ(range.bit(16, 3), State::Sx);
+		EXPECT_EQ(range.concatenated(), RTLIL::Const::from_string("x1z0111100000001001000110100"));
+		EXPECT_EQ(&range.concatenated(), &range.concatenated());
+		ranges++;
+	}
+	EXPECT_EQ(ranges, 1);
+	EXPECT_EQ(mem[15], RTLIL::Const::from_string("1111"));
+	EXPECT_EQ(mem[16], RTLIL::Const::from_string("x1z0"));
+
+	mem.clear_range(12, 14);
+	mem.check();
+	EXPECT_EQ(mem.count_range(0, 256), 5u);
+	EXPECT_EQ(mem[11], RTLIL::Const::from_string("0011"));
+	EXPECT_EQ(mem[12], RTLIL::Const(State::Sx, 4));
+	EXPECT_EQ(mem[16], RTLIL::Const::from_string("x1z0"));
+
+	mem.insert_masked(16, RTLIL::Const::from_string("1111"), RTLIL::Const::from_string("0110"));
+	mem.insert_masked(20, RTLIL::Const::from_string("1111"), RTLIL::Const::from_string("0011"));
+	mem.check();
+	EXPECT_EQ(mem[16], RTLIL::Const::from_string("x110"));
+	EXPECT_EQ(mem[20], RTLIL::Const::from_string("xx11"));
+}
+
+YOSYS_NAMESPACE_END
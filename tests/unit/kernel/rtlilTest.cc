@@ -90,6 +90,46 @@ namespace RTLIL {
 
 	}
 
+	TEST_F(KernelRtlilTest, ModuleArena) {
+		yosys_module_arena = true;
+		std::unique_ptr<Module> mod = std::make_unique<Module>();
+		yosys_module_arena = false;
+		EXPECT_TRUE(mod->has_arena());
+
+		std::vector<Wire*> wires;
+		std::vector<Cell*> cells;
+		for (int i = 0; i < 3000; i++) {
+			wires.push_back(mod->addWire(stringf("\\w%d", i), 2));
+			cells.push_back(mod->addNot(stringf("\\c%d", i), wires.back(), wires.back()));
+		}
+
+		size_t live, allocated;
+		mod->arena_stats(live, allocated);
+		EXPECT_EQ(live, 6000u);
+		EXPECT_GE(allocated, live);
+
+		pool<Wire*> delwires;
+		for (int i = 0; i < 2500; i++) {
+			mod->remove(cells[i]);
+			delwires.insert(wires[i]);
+		}
+		mod->remove(delwires);
+
+		EXPECT_GT(mod->compact_arena(), 0);
+		mod->arena_stats(live, allocated);
+		EXPECT_EQ(live, 1000u);
+		EXPECT_GE(allocated, live);
+
+		for (int i = 2500; i < 3000; i++) {
+			EXPECT_EQ(mod->wire(stringf("\\w%d", i)), wires[i]);
+			EXPECT_EQ(mod->cell(stringf("\\c%d", i))->getPort(ID::A), SigSpec(wires[i]));
+		}
+
+		Wire *reused = mod->addWire(ID(reused));
+		EXPECT_EQ(reused->width, 1);
+		EXPECT_EQ(GetSize(mod->wires()), 501);
+	}
+
 	class WireRtlVsHdlIndexConversionTest :
 		public KernelRtlilTest,
 		public testing::WithParamInterface<std::tuple<bool, int, int>>
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "kernel/timinggraph.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+
+	// Plain RTLIL modules refuse to derive, even without parameters.
+	struct TimingBox : RTLIL::Module {
+		RTLIL::IdString derive(RTLIL::Design*, const dict<RTLIL::IdString, RTLIL::Const> &, bool) override {
+			return name;
+		}
+	};
+
+	void add_specify_params(RTLIL::Cell *cell, int delay)
+	{
+		cell->setParam(ID::T_RISE_MAX, delay);
+		cell->setParam(ID::T_FALL_MAX, delay);
+	}
+
+	class KernelTimingGraphTest : public testing::Test {
+	protected:
+		RTLIL::Design *design;
+		RTLIL::Module *top;
+		RTLIL::Wire *a, *clk, *o;
+
+		KernelTimingGraphTest() {
+			if (log_files.empty()) log_files.emplace_back(stdout);
+			// TimingInfo uses the ID:: constants
+			yosys_setup();
+
+			design = new RTLIL::Design;
+
+			// buf: o = i after 10
+			RTLIL::Module *buf = new TimingBox;
+			buf->name = ID(buf);
+			design->add(buf);
+			buf->set_bool_attribute(ID::blackbox);
+			buf->addWire(ID(i))->port_input = true;
+			buf->addWire(ID(o))->port_output = true;
+			buf->fixup_ports();
+			RTLIL::Cell *spec = buf->addCell(NEW_ID, ID($specify2));
+			add_specify_params(spec, 10);
+			spec->setParam(ID::FULL, false);
+			spec->setPort(ID::EN, State::S1);
+			spec->setPort(ID::SRC, buf->wire(ID(i)));
+			spec->setPort(ID::DST, buf->wire(ID(o)));
+
+			// dff: Q 5 after C, D has a setup time of 3
+			RTLIL::Module *dff = new TimingBox;
+			dff->name = ID(dff);
+			design->add(dff);
+			dff->set_bool_attribute(ID::blackbox);
+			dff->addWire(ID(C))->port_input = true;
+			dff->addWire(ID(D))->port_input = true;
+			dff->addWire(ID(Q))->port_output = true;
+			dff->fixup_ports();
+			spec = dff->addCell(NEW_ID, ID($specify3));
+			add_specify_params(spec, 5);
+			spec->setPort(ID::SRC, dff->wire(ID(C)));
+			spec->setPort(ID::DST, dff->wire(ID(Q)));
+			spec = dff->addCell(NEW_ID, ID($specrule));
+			spec->setParam(ID::TYPE, RTLIL::Const("$setup"));
+			spec->setParam(ID::T_LIMIT_MAX, 3);
+			spec->setPort(ID::SRC, dff->wire(ID(D)));
+			spec->setPort(ID::DST, dff->wire(ID(C)));
+
+			// a -> b1 -> w1 -> b2 -> w2 -> f.D, clk -> f.C, f.Q -> q -> b3 -> o
+			top = design->addModule(ID(top));
+			a = top->addWire(ID(a));
+			a->port_input = true;
+			clk = top->addWire(ID(clk));
+			clk->port_input = true;
+			o = top->addWire(ID(o));
+			o->port_output = true;
+			top->fixup_ports();
+			RTLIL::Wire *w1 = top->addWire(ID(w1));
+			RTLIL::Wire *w2 = top->addWire(ID(w2));
+			RTLIL::Wire *q = top->addWire(ID(q));
+			add_buf(ID(b1), a, w1);
+			add_buf(ID(b2), w1, w2);
+			add_buf(ID(b3), q, o);
+			RTLIL::Cell *f = top->addCell(ID(f), ID(dff));
+			f->setPort(ID(C), clk);
+			f->setPort(ID(D), w2);
+			f->setPort(ID(Q), q);
+		}
+
+		~KernelTimingGraphTest() {
+			delete design;
+		}
+
+		RTLIL::Cell *add_buf(RTLIL::IdString name, RTLIL::Wire *i, RTLIL::Wire *o) {
+			RTLIL::Cell *cell = top->addCell(name, ID(buf));
+			cell->setPort(ID(i), i);
+			cell->setPort(ID(o), o);
+			return cell;
+		}
+
+		void expect_same_as_rebuild(TimingGraph &graph) {
+			TimingGraph fresh(top);
+			fresh.update();
+			graph.update();
+			for (auto &it : fresh.nodes) {
+				const TimingGraph::Node *n = graph.node(it.first);
+				ASSERT_NE(n, nullptr);
+				EXPECT_EQ(n->max_arrival(), it.second.max_arrival()) << log_signal(it.first);
+				EXPECT_EQ(n->downstream, it.second.downstream) << log_signal(it.first);
+			}
+		}
+	};
+
+}
+
+TEST_F(KernelTimingGraphTest, arrivalAndDomains)
+{
+	TimingGraph graph(top);
+
+	EXPECT_EQ(graph.arrival(top->wire(ID(w2))), 20);
+	EXPECT_EQ(graph.arrival(top->wire(ID(q))), 5);
+	EXPECT_EQ(graph.arrival(o, clk), 15);
+	EXPECT_EQ(graph.arrival(o, RTLIL::SigBit()), -1);
+	EXPECT_EQ(graph.downstream(a), 23);
+	EXPECT_EQ(graph.downstream(clk), 15);
+	EXPECT_EQ(GetSize(graph.clock_domains()), 2);
+
+	auto paths = graph.critical_paths(5);
+	ASSERT_EQ(GetSize(paths), 2);
+	EXPECT_EQ(paths[0].arrival, 23);
+	EXPECT_EQ(paths[0].launch_clock, RTLIL::SigBit());
+	EXPECT_TRUE(paths[0].has_endpoint);
+	EXPECT_EQ(paths[0].endpoint.sink, top->cell(ID(f)));
+	EXPECT_EQ(paths[0].endpoint.clock, RTLIL::SigBit(clk));
+	ASSERT_EQ(GetSize(paths[0].steps), 3);
+	EXPECT_EQ(paths[0].steps[0].bit, RTLIL::SigBit(a));
+	EXPECT_EQ(paths[0].steps[0].arc, -1);
+	EXPECT_EQ(paths[1].arrival, 15);
+	EXPECT_EQ(paths[1].launch_clock, RTLIL::SigBit(clk));
+	EXPECT_EQ(paths[1].endpoint.sink, nullptr);
+
+	paths = graph.critical_paths(5, RTLIL::SigBit(clk));
+	ASSERT_EQ(GetSize(paths), 1);
+	EXPECT_EQ(paths[0].steps.back().bit, RTLIL::SigBit(o));
+}
+
+TEST_F(KernelTimingGraphTest, incrementalUpdates)
+{
+	TimingGraph graph(top);
+	graph.update();
+
+	// shorten the path to the flop
+	top->cell(ID(b2))->setPort(ID(i), a);
+	EXPECT_EQ(graph.arrival(top->wire(ID(w2))), 10);
+	EXPECT_EQ(graph.critical_paths(1, RTLIL::SigBit())[0].arrival, 13);
+	EXPECT_EQ(graph.critical_paths(1)[0].arrival, 15);
+	expect_same_as_rebuild(graph);
+
+	// lengthen the clock-to-output path
+	RTLIL::Wire *o2 = top->addWire(ID(o2));
+	top->cell(ID(b3))->setPort(ID(o), o2);
+	add_buf(ID(b4), o2, o);
+	EXPECT_EQ(graph.arrival(o), 25);
+	EXPECT_EQ(graph.critical_paths(1)[0].arrival, 25);
+	expect_same_as_rebuild(graph);
+
+	// removed cells no longer contribute
+	top->remove(top->cell(ID(b4)));
+	EXPECT_EQ(graph.arrival(o), -1);
+	EXPECT_EQ(graph.critical_paths(1)[0].arrival, 15);
+	expect_same_as_rebuild(graph);
+
+	// module-level connections rebuild the graph
+	top->connect(o, o2);
+	EXPECT_EQ(graph.arrival(o), 15);
+	expect_same_as_rebuild(graph);
+}
+
+YOSYS_NAMESPACE_END
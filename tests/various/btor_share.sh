@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+set -ex
+
+# Named nodes must keep their line and symbol in write_btor output, whether
+# or not identical nodes are shared or folded.
+cat > btor_share.il << "EOT"
+module \top
+  wire width 8 input 1 \a
+  wire width 8 input 2 \b
+  wire width 8 output 3 \o1
+  wire width 8 output 4 \o2
+  wire width 8 output 5 \o3
+  wire width 8 output 6 \o4
+  wire width 8 output 7 \o5
+  cell $and \n1
+    parameter \A_SIGNED 0
+    parameter \B_SIGNED 0
+    parameter \A_WIDTH 8
+    parameter \B_WIDTH 8
+    parameter \Y_WIDTH 8
+    connect \A \a
+    connect \B \b
+    connect \Y \o1
+  end
+  cell $and \n2
+    parameter \A_SIGNED 0
+    parameter \B_SIGNED 0
+    parameter \A_WIDTH 8
+    parameter \B_WIDTH 8
+    parameter \Y_WIDTH 8
+    connect \A \a
+    connect \B \b
+    connect \Y \o2
+  end
+  cell $and $anon1
+    parameter \A_SIGNED 0
+    parameter \B_SIGNED 0
+    parameter \A_WIDTH 8
+    parameter \B_WIDTH 8
+    parameter \Y_WIDTH 8
+    connect \A \a
+    connect \B \b
+    connect \Y \o3
+  end
+  cell $and $anon2
+    parameter \A_SIGNED 0
+    parameter \B_SIGNED 0
+    parameter \A_WIDTH 8
+    parameter \B_WIDTH 8
+    parameter \Y_WIDTH 8
+    connect \A \a
+    connect \B \b
+    connect \Y \o4
+  end
+  cell $and \n3
+    parameter \A_SIGNED 0
+    parameter \B_SIGNED 0
+    parameter \A_WIDTH 8
+    parameter \B_WIDTH 8
+    parameter \Y_WIDTH 8
+    connect \A \a
+    connect \B 8'11111111
+    connect \Y \o5
+  end
+end
+EOT
+
+../../yosys -q -p 'read_rtlil btor_share.il; write_btor -noshare btor_share_noshare.btor'
+../../yosys -q -p 'read_rtlil btor_share.il; write_btor btor_share_share.btor'
+../../yosys -q -p 'read_rtlil btor_share.il; write_btor -fold btor_share_fold.btor'
+
+for f in btor_share_noshare.btor btor_share_share.btor btor_share_fold.btor; do
+	for sym in n1 n2 n3 o1 o2 o3 o4 o5; do
+		grep -q " $sym\$" $f
+	done
+done
+
+# The two anonymous copies of n1 are merged into a single node.
+test $(grep -c " and " btor_share_noshare.btor) -eq 5
+test $(grep -c " and " btor_share_share.btor) -eq 4
+test $(grep -c " and " btor_share_fold.btor) -eq 4
+
+# With -v, the comment after each node names the nid it was written as.
+../../yosys -q -p 'read_rtlil btor_share.il; write_btor -v btor_share_verbose.btor'
+awk '/^ *[0-9]/ { defined[$1] = 1 } /^ *; [0-9]+ / { if (!($2 in defined)) exit 1 }' btor_share_verbose.btor
+grep -q '^ *; 3 \\a$' btor_share_verbose.btor
+grep -q '^ *; 7 \\o3$' btor_share_verbose.btor
+
+rm -f btor_share.il btor_share_*.btor
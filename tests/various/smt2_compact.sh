@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+set -ex
+
+# yosys-smtbmc must reach the same verdict in the same step for the regular
+# and the -compact write_smt2 output.
+cat > smt2_compact.sv << "EOT"
+module top(input clk, input en, input [3:0] d);
+	reg [3:0] cnt = 0, acc = 0;
+	always @(posedge clk) begin
+		if (en)
+			cnt <= cnt + 1;
+		acc <= acc ^ d;
+	end
+	// identical cells, shared by -compact
+	wire [3:0] x1 = acc & d, x2 = acc & d;
+	always @* begin
+		assume (cnt != 4'd9);
+		assert (x1 == x2);
+`ifdef FAIL
+		assert (cnt < 4'd6);
+`endif
+	end
+endmodule
+EOT
+
+for variant in pass fail; do
+	defines=""
+	test $variant = fail && defines="-DFAIL"
+	../../yosys -q -p "read_verilog -sv -formal $defines smt2_compact.sv; prep -top top; async2sync; dffunmap; \
+		write_smt2 -wires smt2_compact_$variant.smt2; write_smt2 -wires -compact smt2_compact_${variant}_c.smt2"
+	grep -q "yosys-smt2-step" smt2_compact_${variant}_c.smt2
+
+	for suffix in "" _c; do
+		status=0
+		../../yosys-smtbmc -s yices -t 12 smt2_compact_$variant$suffix.smt2 > smt2_compact_$variant$suffix.log || status=$?
+		echo "exit $status" >> smt2_compact_$variant$suffix.log
+		# drop the timestamps
+		sed -n 's/^## *[0-9:]* *//; /step\|failed\|Status\|exit/p' smt2_compact_$variant$suffix.log > smt2_compact_$variant$suffix.out
+	done
+	cmp smt2_compact_$variant.out smt2_compact_${variant}_c.out
+done
+
+grep -q "exit 0" smt2_compact_pass.out
+grep -q "Assert failed" smt2_compact_fail.out
+
+rm -f smt2_compact.sv smt2_compact_*.smt2 smt2_compact_*.log smt2_compact_*.out
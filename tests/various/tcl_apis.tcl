@@ -61,3 +61,8 @@ rtlil::set_attr -mod -sint top prime 87178291199
 if {[rtlil::get_attr -mod -int top prime] != 87178291199} {
 	error "bad int roundtrip 7"
 }
+
+# selections see attributes set outside of a command
+yosys select -assert-none top/a:fresh
+rtlil::set_attr -true top w fresh
+yosys select -assert-count 1 top/a:fresh